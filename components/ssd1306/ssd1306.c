@@ -17,6 +17,15 @@ typedef union out_column_t {
 	uint8_t  u8[4];
 } PACK8 out_column_t;
 
+// 3x vertical expansion of a font column: every bit becomes three bits (table built at compile time)
+#define X3_BIT(b, n) ((((b) >> (n)) & 1) ? (0x7UL << (3 * (n))) : 0)
+#define X3(b) (X3_BIT(b, 0) | X3_BIT(b, 1) | X3_BIT(b, 2) | X3_BIT(b, 3) | X3_BIT(b, 4) | X3_BIT(b, 5) | X3_BIT(b, 6) | X3_BIT(b, 7))
+#define X3_4(b) X3(b), X3(b + 1), X3(b + 2), X3(b + 3)
+#define X3_16(b) X3_4(b), X3_4(b + 4), X3_4(b + 8), X3_4(b + 12)
+#define X3_64(b) X3_16(b), X3_16(b + 16), X3_16(b + 32), X3_16(b + 48)
+
+static const uint32_t x3_columns[256] = { X3_64(0), X3_64(64), X3_64(128), X3_64(192) };
+
 void ssd1306_init(SSD1306_t * dev, int width, int height)
 {
 	if (dev->_address == SPIAddress) {
@@ -25,8 +34,74 @@ void ssd1306_init(SSD1306_t * dev, int width, int height)
 		i2c_init(dev, width, height);
 	}
 	// Initialize internal buffer
+	// The display RAM is undefined after reset: the first flush sends every page
 	for (int i=0;i<dev->_pages;i++) {
 		memset(dev->_page[i]._segs, 0, 128);
+		dev->_page[i]._dirtyStart = 0;
+		dev->_page[i]._dirtyEnd = dev->_width - 1;
+	}
+}
+
+// Move the dirty spans of dev into front (same display, front clean): front sends them with ssd1306_flush
+// Returns false if nothing has changed
+bool ssd1306_copy_dirty(SSD1306_t * dev, SSD1306_t * front)
+{
+	bool dirty = false;
+	for (int page=0; page<dev->_pages; page++) {
+		PAGE_t * _page = &dev->_page[page];
+		if (_page->_dirtyStart > _page->_dirtyEnd) continue;
+		int width = _page->_dirtyEnd - _page->_dirtyStart + 1;
+		memcpy(&front->_page[page]._segs[_page->_dirtyStart], &_page->_segs[_page->_dirtyStart], width);
+		front->_page[page]._dirtyStart = _page->_dirtyStart;
+		front->_page[page]._dirtyEnd = _page->_dirtyEnd;
+		_page->_dirtyStart = dev->_width;
+		_page->_dirtyEnd = -1;
+		dirty = true;
+	}
+	return dirty;
+}
+
+// Copy to the internal buffer and widen the dirty span of the page to the columns that changed
+static void ssd1306_write_buffer(SSD1306_t * dev, int page, int seg, uint8_t * images, int width)
+{
+	if (page >= dev->_pages) return;
+	if (seg >= dev->_width) return;
+	if (seg + width > dev->_width) width = dev->_width - seg;
+
+	PAGE_t * _page = &dev->_page[page];
+	int first = -1;
+	int last = -1;
+	for (int i=0; i<width; i++) {
+		if (_page->_segs[seg+i] != images[i]) {
+			if (first < 0) first = seg + i;
+			last = seg + i;
+			_page->_segs[seg+i] = images[i];
+		}
+	}
+	if (first < 0) return;
+	if (_page->_dirtyStart > _page->_dirtyEnd) {
+		_page->_dirtyStart = first;
+		_page->_dirtyEnd = last;
+	} else {
+		if (first < _page->_dirtyStart) _page->_dirtyStart = first;
+		if (last > _page->_dirtyEnd) _page->_dirtyEnd = last;
+	}
+}
+
+// Send the dirty span of every page (one transfer per page) and mark the buffer clean
+void ssd1306_flush(SSD1306_t * dev)
+{
+	for (int page=0; page<dev->_pages; page++) {
+		PAGE_t * _page = &dev->_page[page];
+		if (_page->_dirtyStart > _page->_dirtyEnd) continue;
+		int width = _page->_dirtyEnd - _page->_dirtyStart + 1;
+		if (dev->_address == SPIAddress) {
+			spi_display_image(dev, page, _page->_dirtyStart, &_page->_segs[_page->_dirtyStart], width);
+		} else {
+			i2c_display_image(dev, page, _page->_dirtyStart, &_page->_segs[_page->_dirtyStart], width);
+		}
+		_page->_dirtyStart = dev->_width;
+		_page->_dirtyEnd = -1;
 	}
 }
 
@@ -56,6 +131,10 @@ void ssd1306_show_buffer(SSD1306_t * dev)
 			i2c_display_image(dev, page, 0, dev->_page[page]._segs, dev->_width);
 		}
 	}
+	for (int page=0; page<dev->_pages;page++) {
+		dev->_page[page]._dirtyStart = dev->_width;
+		dev->_page[page]._dirtyEnd = -1;
+	}
 }
 
 void ssd1306_set_buffer(SSD1306_t * dev, uint8_t * buffer)
@@ -76,15 +155,10 @@ void ssd1306_get_buffer(SSD1306_t * dev, uint8_t * buffer)
 	}
 }
 
+// Draw into the internal buffer: the display is updated by ssd1306_flush
 void ssd1306_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width)
 {
-	if (dev->_address == SPIAddress) {
-		spi_display_image(dev, page, seg, images, width);
-	} else {
-		i2c_display_image(dev, page, seg, images, width);
-	}
-	// Set to internal buffer
-	memcpy(&dev->_page[page]._segs[seg], images, width);
+	ssd1306_write_buffer(dev, page, seg, images, width);
 }
 
 void ssd1306_display_text(SSD1306_t * dev, int page, char * text, int text_len, bool invert)
@@ -127,20 +201,8 @@ ssd1306_display_text_x3(SSD1306_t * dev, int page, char * text, int text_len, bo
 
 		// make the character 3x as high
 		out_column_t out_columns[8];
-		memset(out_columns, 0, sizeof(out_columns));
-
 		for (uint8_t xx = 0; xx < 8; xx++) { // for each column (x-direction)
-
-			uint32_t in_bitmask = 0b1;
-			uint32_t out_bitmask = 0b111;
-
-			for (uint8_t yy = 0; yy < 8; yy++) { // for pixel (y-direction)
-				if (in_columns[xx] & in_bitmask) {
-					out_columns[xx].u32 |= out_bitmask;
-				}
-				in_bitmask <<= 1;
-				out_bitmask <<= 3;
-			}
+			out_columns[xx].u32 = x3_columns[in_columns[xx]];
 		}
 
 		// render character in 8 column high pieces, making them 3x as wide
@@ -154,12 +216,7 @@ ssd1306_display_text_x3(SSD1306_t * dev, int page, char * text, int text_len, bo
 			}
 			if (invert) ssd1306_invert(image, 24);
 			if (dev->_flip) ssd1306_flip(image, 24);
-			if (dev->_address == SPIAddress) {
-				spi_display_image(dev, page+yy, seg, image, 24);
-			} else {
-				i2c_display_image(dev, page+yy, seg, image, 24);
-			}
-			memcpy(&dev->_page[page+yy]._segs[seg], image, 24);
+			ssd1306_write_buffer(dev, page+yy, seg, image, 24);
 		}
 		seg = seg + 24;
 	}
@@ -235,6 +292,7 @@ void ssd1306_scroll_text(SSD1306_t * dev, char * text, int text_len, bool invert
 	if (_text_len > 16) _text_len = 16;
 	
 	ssd1306_display_text(dev, srcIndex, text, text_len, invert);
+	ssd1306_flush(dev);
 }
 
 void ssd1306_scroll_clear(SSD1306_t * dev)
@@ -250,6 +308,7 @@ void ssd1306_scroll_clear(SSD1306_t * dev)
 		if (dstIndex == dev->_scStart) break;
 		srcIndex = srcIndex - dev->_scDirection;
 	}
+	ssd1306_flush(dev);
 }
 
 
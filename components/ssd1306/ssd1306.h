@@ -83,6 +83,8 @@ typedef struct {
 	bool _valid; // Not using it anymore
 	int _segLen; // Not using it anymore
 	uint8_t _segs[128];
+	int _dirtyStart; // First column changed since the last flush
+	int _dirtyEnd; // Last column changed since the last flush (clean if lower than _dirtyStart)
 } PAGE_t;
 
 typedef struct {
@@ -110,6 +112,8 @@ int ssd1306_get_width(SSD1306_t * dev);
 int ssd1306_get_height(SSD1306_t * dev);
 int ssd1306_get_pages(SSD1306_t * dev);
 void ssd1306_show_buffer(SSD1306_t * dev);
+void ssd1306_flush(SSD1306_t * dev);
+bool ssd1306_copy_dirty(SSD1306_t * dev, SSD1306_t * front);
 void ssd1306_set_buffer(SSD1306_t * dev, uint8_t * buffer);
 void ssd1306_get_buffer(SSD1306_t * dev, uint8_t * buffer);
 void ssd1306_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width);
@@ -77,12 +77,8 @@ void i2c_init(SSD1306_t * dev, int width, int height) {
 	i2c_master_write_byte(cmd, OLED_CMD_SET_VCOMH_DESELCT, true);		// DB
 	i2c_master_write_byte(cmd, 0x40, true);
 	i2c_master_write_byte(cmd, OLED_CMD_SET_MEMORY_ADDR_MODE, true);	// 20
-	//i2c_master_write_byte(cmd, OLED_CMD_SET_HORI_ADDR_MODE, true);	// 00
-	i2c_master_write_byte(cmd, OLED_CMD_SET_PAGE_ADDR_MODE, true);		// 02
-	// Set Lower Column Start Address for Page Addressing Mode
-	i2c_master_write_byte(cmd, 0x00, true);
-	// Set Higher Column Start Address for Page Addressing Mode
-	i2c_master_write_byte(cmd, 0x10, true);
+	// Horizontal Addressing Mode: every image sets its own column and page range
+	i2c_master_write_byte(cmd, OLED_CMD_SET_HORI_ADDR_MODE, true);		// 00
 	i2c_master_write_byte(cmd, OLED_CMD_SET_CHARGE_PUMP, true);			// 8D
 	i2c_master_write_byte(cmd, 0x14, true);
 	i2c_master_write_byte(cmd, OLED_CMD_DEACTIVE_SCROLL, true);			// 2E
@@ -108,34 +104,29 @@ void i2c_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int
 	if (seg >= dev->_width) return;
 
 	int _seg = seg + CONFIG_OFFSETX;
-	uint8_t columLow = _seg & 0x0F;
-	uint8_t columHigh = (_seg >> 4) & 0x0F;
 
 	int _page = page;
 	if (dev->_flip) {
 		_page = (dev->_pages - page) - 1;
 	}
 
-	cmd = i2c_cmd_link_create();
-	i2c_master_start(cmd);
-	i2c_master_write_byte(cmd, (dev->_address << 1) | I2C_MASTER_WRITE, true);
-
-	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-	// Set Lower Column Start Address for Page Addressing Mode
-	i2c_master_write_byte(cmd, (0x00 + columLow), true);
-	// Set Higher Column Start Address for Page Addressing Mode
-	i2c_master_write_byte(cmd, (0x10 + columHigh), true);
-	// Set Page Start Address for Page Addressing Mode
-	i2c_master_write_byte(cmd, 0xB0 | _page, true);
+	if (seg + width > dev->_width) width = dev->_width - seg;
 
-	i2c_master_stop(cmd);
-	i2c_master_cmd_begin(I2C_NUM, cmd, 10/portTICK_PERIOD_MS);
-	i2c_cmd_link_delete(cmd);
+	// One transaction: single commands (Co = 1) for the window, then the data stream
+	uint8_t window[] = {
+		OLED_CONTROL_BYTE_CMD_SINGLE, OLED_CMD_SET_COLUMN_RANGE,	// 21
+		OLED_CONTROL_BYTE_CMD_SINGLE, _seg,
+		OLED_CONTROL_BYTE_CMD_SINGLE, _seg + width - 1,
+		OLED_CONTROL_BYTE_CMD_SINGLE, OLED_CMD_SET_PAGE_RANGE,		// 22
+		OLED_CONTROL_BYTE_CMD_SINGLE, _page,
+		OLED_CONTROL_BYTE_CMD_SINGLE, _page,
+	};
 
 	cmd = i2c_cmd_link_create();
 	i2c_master_start(cmd);
 	i2c_master_write_byte(cmd, (dev->_address << 1) | I2C_MASTER_WRITE, true);
 
+	i2c_master_write(cmd, window, sizeof(window), true);
 	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
 	i2c_master_write(cmd, images, width, true);
 
@@ -0,0 +1,89 @@
+#include "audio_click.h"
+#include "driver/gpio.h"
+#include "driver/i2s_pdm.h"
+
+TaskHandle_t audio_click_task_handle;
+i2s_chan_handle_t audio_click_channel; // I2S channel of the click (PDM TX)
+click_mixer audio_click_mixer; // samples, schedule and voices of the click
+volatile uint64_t audio_click_sent_time = 0; // esp_timer time of the end of the last DMA buffer sent
+portMUX_TYPE audio_click_spinlock = portMUX_INITIALIZER_UNLOCKED; // protects audio_click_sent_time
+
+void IRAM_ATTR audio_click_play(uint64_t time, click_type type)
+{
+    click_mixer_schedule(&audio_click_mixer, time, type);
+}
+
+void IRAM_ATTR audio_click_stop()
+{
+    click_mixer_schedule(&audio_click_mixer, 0, CLICK_STOP);
+}
+
+/**
+ * @brief Callback of the I2S driver: a DMA buffer has been sent (ISR)
+ */
+static bool IRAM_ATTR audio_click_on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    portENTER_CRITICAL_ISR(&audio_click_spinlock);
+    audio_click_sent_time = esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&audio_click_spinlock);
+    return false;
+}
+
+/**
+ * @brief Task that renders the clicks into the DMA ring
+ * The write blocks until a buffer of the ring has been sent: the buffer written is played after the
+ * others in the ring, so the next one (written when the next buffer is sent) starts
+ * AUDIO_CLICK_DMA_BUFFERS buffers after the last one sent.
+ */
+static void audio_click_task(void *arg)
+{
+    static int16_t frames[AUDIO_CLICK_BUFFER_FRAMES];
+    uint64_t buffer_time = esp_timer_get_time() + (AUDIO_CLICK_DMA_BUFFERS * AUDIO_CLICK_BUFFER_TIME_US);
+    uint32_t late = 0;
+    while (1)
+    {
+        click_mixer_render(&audio_click_mixer, frames, AUDIO_CLICK_BUFFER_FRAMES, buffer_time);
+        size_t bytes_written;
+        ESP_ERROR_CHECK(i2s_channel_write(audio_click_channel, frames, sizeof(frames), &bytes_written, portMAX_DELAY));
+        portENTER_CRITICAL(&audio_click_spinlock);
+        buffer_time = audio_click_sent_time + (AUDIO_CLICK_DMA_BUFFERS * AUDIO_CLICK_BUFFER_TIME_US);
+        portEXIT_CRITICAL(&audio_click_spinlock);
+        if (audio_click_mixer.late != late)
+        {
+            late = audio_click_mixer.late;
+            ESP_LOGW("AUDIO_CLICK", "%lu clicks played late (%lu dropped)", late, audio_click_mixer.dropped);
+        }
+    }
+}
+
+void audio_click_init()
+{
+    click_mixer_init(&audio_click_mixer);
+    /*
+    Set up the I2S channel: PDM TX on the data pin only (no clock pin), the DMA ring plays
+    silence when the task is late
+    */
+    i2s_chan_config_t channel_config = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    channel_config.dma_desc_num = AUDIO_CLICK_DMA_BUFFERS;
+    channel_config.dma_frame_num = AUDIO_CLICK_BUFFER_FRAMES;
+    channel_config.auto_clear = true;
+    ESP_ERROR_CHECK(i2s_new_channel(&channel_config, &audio_click_channel, NULL));
+    i2s_pdm_tx_config_t pdm_config = {
+        .clk_cfg = I2S_PDM_TX_CLK_DEFAULT_CONFIG(CLICK_MIXER_SAMPLE_RATE),
+        .slot_cfg = I2S_PDM_TX_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .clk = I2S_GPIO_UNUSED,
+            .dout = AUDIO_CLICK_OUTPUT_IO,
+        },
+    };
+    ESP_ERROR_CHECK(i2s_channel_init_pdm_tx_mode(audio_click_channel, &pdm_config));
+    i2s_event_callbacks_t callbacks = {
+        .on_sent = audio_click_on_sent,
+    };
+    ESP_ERROR_CHECK(i2s_channel_register_event_callback(audio_click_channel, &callbacks, NULL));
+    ESP_ERROR_CHECK(i2s_channel_enable(audio_click_channel));
+    /*
+    Create audio_click_task
+    */
+    xTaskCreate(audio_click_task, "Audio_Click_Task", AUDIO_CLICK_TASK_STACK_SIZE, NULL, AUDIO_CLICK_TASK_PRIORITY, &audio_click_task_handle);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file audio_click.h
+ * @brief AUDIO CLICK module plays the metronome click through I2S.
+ * The clicks are rendered by the click mixer (click_mixer.h) into the DMA ring of an I2S channel in
+ * PDM TX mode: the single PDM data pin (AUDIO_CLICK_OUTPUT_IO, the pin of the old LEDC square wave)
+ * only needs an RC low-pass filter to drive the amplifier.
+ * The audio task renders a DMA buffer at a time, with the time at which its first frame will be
+ * heard: the callback of the I2S driver stamps the end of every buffer sent, and the buffer rendered
+ * now is played after the ones already in the ring. The clock schedules every click
+ * AUDIO_CLICK_LATENCY us before its time (audio output of the clock), so it is in the schedule
+ * before its buffer is rendered and it is heard on time.
+ */
+
+#ifndef BC_AUDIO_CLICK_H
+#define BC_AUDIO_CLICK_H
+
+#include "main_defs.h"
+#include "click_mixer.h"
+
+/**
+ * @brief PDM data pin of the audio click
+ */
+#define AUDIO_CLICK_OUTPUT_IO (GPIO_NUM_15)
+
+/**
+ * @{ \name DMA ring of the I2S channel
+ */
+#define AUDIO_CLICK_DMA_BUFFERS 4
+#define AUDIO_CLICK_BUFFER_FRAMES 64
+#define AUDIO_CLICK_BUFFER_TIME_US ((AUDIO_CLICK_BUFFER_FRAMES * 1000000) / CLICK_MIXER_SAMPLE_RATE) // 4 ms
+/**
+ * @}
+ */
+
+/**
+ * @brief The clicks are scheduled this amount of us in advance: the ring, the buffer being rendered
+ * and one more buffer for the scheduling of the task (24 ms, within the max offset of the clock outputs)
+ */
+#define AUDIO_CLICK_LATENCY ((AUDIO_CLICK_DMA_BUFFERS + 2) * AUDIO_CLICK_BUFFER_TIME_US)
+
+/**
+ * @brief Schedules a click that will be heard at time (us, esp_timer). Called by the clock ISR.
+ */
+void audio_click_play(uint64_t time, click_type type);
+
+/**
+ * @brief Silences the click and drops the clicks scheduled (transport stop). Called by the clock ISR.
+ */
+void audio_click_stop();
+
+/**
+ * @brief Init function for the audio_click module
+ * The function sets up the I2S channel, synthesizes the clicks and creates audio_click_task
+ */
+void audio_click_init();
+
+#endif
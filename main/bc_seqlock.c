@@ -0,0 +1,91 @@
+#include "bc_seqlock.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+
+extern main_runtime_vrbs bc;
+
+/**
+ * @brief Sequence counter of bc (odd while a write is in progress)
+ */
+static volatile uint32_t bc_sequence = 0;
+
+/**
+ * @brief Spinlock that serializes the writers of bc (on both cores)
+ */
+static portMUX_TYPE bc_write_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Statistics of the accesses (the write fields are protected by bc_write_spinlock)
+ */
+static bc_seqlock_stats bc_stats = {0};
+
+/**
+ * @brief Cycle count at the start of the write section in progress
+ */
+static uint32_t bc_write_start = 0;
+
+/**
+ * @brief Updates the statistics at the end of a write section (inside the spinlock)
+ */
+static void IRAM_ATTR bc_count_write()
+{
+    uint32_t cycles = esp_cpu_get_cycle_count() - bc_write_start;
+    bc_stats.writes++;
+    bc_stats.write_cycles += cycles;
+    if (cycles > bc_stats.max_write_cycles)
+    {
+        bc_stats.max_write_cycles = cycles;
+    }
+}
+
+void bc_write_begin()
+{
+    portENTER_CRITICAL(&bc_write_spinlock);
+    bc_write_start = esp_cpu_get_cycle_count();
+    bc_seqlock_write_begin(&bc_sequence);
+}
+
+void bc_write_end()
+{
+    bc_seqlock_write_end(&bc_sequence);
+    bc_count_write();
+    portEXIT_CRITICAL(&bc_write_spinlock);
+}
+
+void IRAM_ATTR bc_write_begin_from_isr()
+{
+    portENTER_CRITICAL_ISR(&bc_write_spinlock);
+    bc_write_start = esp_cpu_get_cycle_count();
+    bc_seqlock_write_begin(&bc_sequence);
+}
+
+void IRAM_ATTR bc_write_end_from_isr()
+{
+    bc_seqlock_write_end(&bc_sequence);
+    bc_count_write();
+    portEXIT_CRITICAL_ISR(&bc_write_spinlock);
+}
+
+void IRAM_ATTR bc_read(main_runtime_vrbs *snapshot)
+{
+    uint32_t start_value = bc_seqlock_read_begin(&bc_sequence);
+    /*
+    Copy the whole struct and repeat if a writer changed it in the meantime
+    */
+    *snapshot = *(const volatile main_runtime_vrbs *)&bc;
+    while (bc_seqlock_read_retry(&bc_sequence, start_value))
+    {
+        __atomic_fetch_add(&bc_stats.read_retries, 1, __ATOMIC_RELAXED);
+        start_value = bc_seqlock_read_begin(&bc_sequence);
+        *snapshot = *(const volatile main_runtime_vrbs *)&bc;
+    }
+}
+
+void bc_seqlock_get_stats(bc_seqlock_stats *stats)
+{
+    portENTER_CRITICAL(&bc_write_spinlock);
+    *stats = bc_stats;
+    bc_stats.max_write_cycles = 0;
+    portEXIT_CRITICAL(&bc_write_spinlock);
+    stats->read_retries = __atomic_load_n(&bc_stats.read_retries, __ATOMIC_RELAXED);
+}
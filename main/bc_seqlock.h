@@ -0,0 +1,73 @@
+/**
+ * @file bc_seqlock.h
+ * @brief Seqlock publication of the main runtime variable (bc).
+ * Writers (tasks and the clock ISR) are serialized by a spinlock and bump a sequence counter
+ * before and after changing bc: the counter is odd while a write is in progress.
+ * Readers never block: they copy the whole struct and retry if the counter was odd or has changed
+ * during the copy, so that a 64-bit value (tau, expected_beat) is never read half updated.
+ *
+ * Usage for a writer:
+ * - bc_write_begin() (or bc_write_begin_from_isr() inside an ISR)
+ * - read and change the fields of bc (keep it short: no logging, no blocking calls)
+ * - bc_write_end() (or bc_write_end_from_isr())
+ *
+ * Usage for a reader:
+ * - main_runtime_vrbs snapshot;
+ * - bc_read(&snapshot);
+ *
+ * The sequence logic (bc_seqlock_read_begin, bc_seqlock_read_retry, ...) is in bc_sequence.h: it only
+ * uses the gcc atomic builtins so that it can also be compiled on the host (host_test/bc_sequence_test.c).
+ *
+ * The write sections are timed with the cycle counter of the CPU (they keep the other writers
+ * and the interrupts of the core out) and the copies repeated by the readers are counted:
+ * see bc_seqlock_get_stats (telemetry.h).
+ */
+
+#ifndef BC_SEQLOCK_H
+#define BC_SEQLOCK_H
+
+#include "main_defs.h"
+#include "bc_sequence.h"
+
+/**
+ * @brief Starts a write section on bc from a task.
+ */
+void bc_write_begin();
+
+/**
+ * @brief Ends a write section on bc from a task.
+ */
+void bc_write_end();
+
+/**
+ * @brief Starts a write section on bc from an ISR.
+ */
+void bc_write_begin_from_isr();
+
+/**
+ * @brief Ends a write section on bc from an ISR.
+ */
+void bc_write_end_from_isr();
+
+/**
+ * @brief Copies a consistent snapshot of bc (never blocks, can be called from an ISR).
+ */
+void bc_read(main_runtime_vrbs *snapshot);
+
+/**
+ * @brief Statistics of the accesses to bc
+ */
+typedef struct
+{
+    uint32_t writes; /**< Write sections since boot */
+    uint64_t write_cycles; /**< CPU cycles spent inside the write sections since boot */
+    uint32_t max_write_cycles; /**< Longest write section since the previous call (CPU cycles) */
+    uint32_t read_retries; /**< Copies repeated by the readers since boot */
+} bc_seqlock_stats;
+
+/**
+ * @brief Copies the statistics of the accesses to bc (and starts measuring the longest write section again)
+ */
+void bc_seqlock_get_stats(bc_seqlock_stats *stats);
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file bc_sequence.h
+ * @brief Sequence counter of the seqlock of bc (bc_seqlock.h).
+ * The counter is odd while a write is in progress: a reader takes its value before the copy and
+ * repeats the copy if the value was odd or has changed at the end of it.
+ * The writers must be serialized by the caller (a spinlock on the target, a mutex on the host).
+ * The functions only use the gcc atomic builtins so that they can be compiled on the host.
+ */
+
+#ifndef BC_SEQUENCE_H
+#define BC_SEQUENCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Sequence counter: returns the value to be checked at the end of the read (waits for even).
+ */
+static inline uint32_t bc_seqlock_read_begin(const volatile uint32_t *sequence)
+{
+    uint32_t value;
+    while ((value = __atomic_load_n(sequence, __ATOMIC_ACQUIRE)) & 1)
+    {
+        /*
+        A write is in progress (on the other core)
+        */
+    }
+    return value;
+}
+
+/**
+ * @brief Sequence counter: returns true if the copy has to be repeated.
+ */
+static inline bool bc_seqlock_read_retry(const volatile uint32_t *sequence, uint32_t start_value)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(sequence, __ATOMIC_RELAXED) != start_value;
+}
+
+/**
+ * @brief Sequence counter: marks the start of a write (counter becomes odd).
+ */
+static inline void bc_seqlock_write_begin(volatile uint32_t *sequence)
+{
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Sequence counter: marks the end of a write (counter becomes even).
+ */
+static inline void bc_seqlock_write_end(volatile uint32_t *sequence)
+{
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELEASE);
+}
+
+#endif
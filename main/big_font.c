@@ -0,0 +1,89 @@
+#include "big_font.h"
+
+/**
+ * @brief Glyphs of the big chars (4 pages x 24 columns, page-ordered byte columns)
+ * Index 0-9: numbers 0-9
+ * Index 10: whitespace
+ * Index 11-36: letters A-Z
+ */
+const uint8_t BIG_CHARS[BIG_FONT_GLYPHS][BIG_FONT_PAGES][BIG_FONT_WIDTH] = {{{0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfc, 0x3c, 0x1e, 0x0e, 0x06, 0x07, 0x07, 0x07, 0x0e, 0x0e, 0x1e, 0x3c, 0xfc, 0xf8, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xe0, 0xf0, 0x70, 0x38, 0x3c, 0x3f, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xfc, 0x1c, 0x1e, 0x0f, 0x07, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x0f, 0x1f, 0x3c, 0x38, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x78, 0x38, 0x3e, 0x1f, 0x0f, 0x07, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0xe0, 0xf0, 0x70, 0x70, 0x38, 0x38, 0x38, 0x3c, 0xfc, 0xfe, 0xfe, 0xfa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x2f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0xc0, 0xf0, 0xf8, 0xf8, 0x3c, 0x1c, 0x0c, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x3c, 0xfc, 0xf8, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xff, 0x7f, 0x1f, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xe0, 0xf0, 0x7c, 0x3e, 0x1f, 0x0f, 0x07, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x70, 0x78, 0x7c, 0x7e, 0x7f, 0x67, 0x63, 0x61, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0xc0, 0xe0, 0xf8, 0xf8, 0x3c, 0x1c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1c, 0x3c, 0xfc, 0xf8, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0xc0, 0xc0, 0xf0, 0x7d, 0x7f, 0x3f, 0x0f, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x07, 0x1e, 0xfe, 0xfc, 0xf8, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x07, 0x1f, 0x3f, 0x7c, 0x78, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0x70, 0x78, 0x7c, 0x3f, 0x1f, 0x0f, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0xfc, 0xfe, 0xfe, 0xfe, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0x7e, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0xc0, 0xf0, 0xf8, 0xfe, 0xff, 0xc7, 0xc3, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xff, 0xff, 0xff, 0xff, 0xc0, 0xc0, 0xc0, 0xc0, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xff, 0xff, 0xf7, 0xe0, 0x70, 0x70, 0x70, 0x70, 0x70, 0xf0, 0xf0, 0xe0, 0xe0, 0xc0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0xff, 0xff, 0xfe, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x0f, 0x3f, 0x3e, 0x78, 0x70, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0x70, 0x70, 0x78, 0x3e, 0x3f, 0x0f, 0x07, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xf0, 0xf8, 0x78, 0x3c, 0x1e, 0x1e, 0x0e, 0x0e, 0x07, 0x07, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xe7, 0xe1, 0x70, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x78, 0xf8, 0xf0, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xc1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x1e, 0x3c, 0x38, 0x38, 0x70, 0x70, 0x70, 0x38, 0x38, 0x3c, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xce, 0xfe, 0xfe, 0x7e, 0x1e, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfe, 0x3f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf8, 0xfe, 0x7f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x70, 0x7c, 0x7f, 0x1f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0x80, 0xf0, 0xf8, 0xfc, 0x3c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x7c, 0xf8, 0xf8, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x1f, 0x7f, 0x7f, 0xf0, 0xe0, 0xc0, 0xc0, 0x80, 0x80, 0xc0, 0xc0, 0xe0, 0xf0, 0x7f, 0x3f, 0x1f, 0x03, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xf8, 0xfc, 0xfe, 0x1e, 0x07, 0x03, 0x03, 0x03, 0x01, 0x01, 0x03, 0x03, 0x07, 0x0f, 0x1e, 0xfe, 0xfc, 0xf0, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x0f, 0x1f, 0x3f, 0x7c, 0x78, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xf0, 0x70, 0x78, 0x3e, 0x3f, 0x1f, 0x07, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x80, 0xe0, 0xf0, 0xf8, 0x7c, 0x1c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0xff, 0xff, 0xe1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0x0f, 0x0f, 0x1e, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x0e, 0x07, 0xc7, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x38, 0x3c, 0x3e, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xfc, 0xfc, 0xfc, 0xfc, 0xf0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xf8, 0xff, 0xff, 0x0f, 0x01, 0x00, 0x07, 0x3f, 0xff, 0xfc, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xe0, 0xfc, 0xff, 0xff, 0xe7, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe3, 0xff, 0xff, 0xfe, 0xf0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x40, 0x78, 0x7f, 0x7f, 0x0f, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x7f, 0xff, 0x7c, 0xe0, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xff, 0xfe, 0xfe, 0x0e, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x0e, 0x0e, 0x0e, 0x1e, 0x3c, 0xfc, 0xf8, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xf0, 0xf8, 0xfc, 0x3f, 0x1f, 0x0f, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x07, 0x8f, 0xff, 0xfe, 0xf8, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x3f, 0x3f, 0x3f, 0x38, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x38, 0x38, 0x38, 0x3c, 0x1e, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0x78, 0x3c, 0x1c, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x3c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00}, {0x00, 0x00, 0xfe, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x07, 0x0f, 0x1f, 0x3e, 0x78, 0x70, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0x60, 0x70, 0x78, 0x3c, 0x3f, 0x1f, 0x07, 0x01, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1c, 0x1c, 0x1c, 0x38, 0x78, 0xf0, 0xf0, 0xc0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0xff, 0xff, 0xfe, 0xc0, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0x7f, 0x07, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x38, 0x3c, 0x1e, 0x1f, 0x0f, 0x07, 0x03, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x02, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xc0, 0xf0, 0xf8, 0x7c, 0x3c, 0x1e, 0x0e, 0x0e, 0x06, 0x06, 0x0e, 0x0e, 0x0e, 0x1e, 0x3c, 0xfc, 0xf8, 0xe0, 0x80, 0x00, 0x00}, {0x00, 0xe0, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00}, {0x00, 0x07, 0xff, 0xff, 0xff, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x07, 0x0f, 0x1f, 0x3c, 0x38, 0x78, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x38, 0x3c, 0x1f, 0x1f, 0x0f, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfa, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xe0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x2f, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x70, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x3f, 0x3f, 0x3f, 0x3f, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x70, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x40, 0xc0, 0xc0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x03, 0x0f, 0x1f, 0x1f, 0x3c, 0x38, 0x78, 0x70, 0x70, 0x70, 0x70, 0x78, 0x38, 0x3c, 0x1f, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf0, 0xf8, 0x7e, 0x3e, 0x0e, 0x06, 0x02, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x80, 0x80, 0xc0, 0xe0, 0xf8, 0xfc, 0xfe, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x3f, 0x0f, 0x07, 0x03, 0x03, 0x0f, 0x1f, 0x7f, 0xfc, 0xf8, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0x1f, 0x3f, 0x7e, 0x78, 0x70, 0x40, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0x02, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x20, 0x7f, 0x7f, 0x7f, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xf0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xf0, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xe1, 0x03, 0x1f, 0xff, 0xfc, 0xe0, 0x00, 0x80, 0xe0, 0xfc, 0xff, 0x1f, 0x03, 0x01, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x07, 0x3f, 0x7f, 0x7f, 0x1f, 0x03, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0xff, 0x7f, 0xff, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0xfc, 0xfc, 0xfc, 0xfe, 0xf8, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0xfc, 0xfc, 0x04, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x07, 0x3f, 0x7f, 0xfc, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x1f, 0x7f, 0xfc, 0xf0, 0xc0, 0x80, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x1f, 0x7f, 0x7f, 0x7f, 0x7f, 0x40, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf0, 0xf8, 0x3c, 0x1c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0xfe, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0xff, 0xff, 0xfc, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0x7f, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x3e, 0x78, 0x70, 0xf0, 0xe0, 0xe0, 0xe0, 0xe0, 0x70, 0x78, 0x7c, 0x3e, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1c, 0x1c, 0x3c, 0x78, 0xf8, 0xf0, 0xc0, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xe0, 0xff, 0xff, 0x7f, 0x1f, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfc, 0x3e, 0x1e, 0x0f, 0x07, 0x07, 0x07, 0x07, 0x07, 0x0f, 0x0f, 0x1e, 0x7c, 0xfc, 0xf0, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0xf8, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xe0, 0x00}, {0x00, 0x07, 0xff, 0xff, 0xff, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xe0, 0xc0, 0x80, 0x80, 0xc0, 0xff, 0xff, 0x7f, 0x01, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x07, 0x0f, 0x1f, 0x3c, 0x3c, 0x38, 0x70, 0x70, 0x70, 0x79, 0x3b, 0x3f, 0x1f, 0x1f, 0x3f, 0x7f, 0xf9, 0xf0, 0xe0, 0xc0}},
+                                                                            {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0c, 0x1c, 0x3c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xc0, 0xe0, 0xff, 0xff, 0x7f, 0x1f, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x0f, 0x3f, 0xff, 0xff, 0xe1, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x5f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x7f, 0x7e, 0x78, 0x60, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x00, 0xe0, 0xf0, 0xf8, 0x7c, 0x3c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x3c, 0xf8, 0xf8, 0xf0, 0xc0, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x0f, 0x3f, 0x3f, 0x7c, 0xf8, 0xf0, 0xe0, 0xe0, 0xc0, 0xc0, 0x80, 0x80, 0x80, 0x00, 0x00, 0x01, 0x03, 0x01, 0x03, 0x00, 0x00}, {0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x03, 0x03, 0x03, 0x07, 0x0f, 0x1f, 0x3e, 0xfe, 0xfc, 0xf0, 0x00, 0x00}, {0x00, 0x00, 0x03, 0x07, 0x1f, 0x1f, 0x3e, 0x38, 0x78, 0x70, 0x70, 0x60, 0x60, 0x70, 0x70, 0x70, 0x78, 0x78, 0x3e, 0x1f, 0x0f, 0x07, 0x00, 0x00}},
+                                                                            {{0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x3f, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x3e, 0x3c, 0x78, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x78, 0x3c, 0x3f, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x02, 0x1e, 0xfe, 0xfe, 0xf0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xfe, 0xff, 0x3e, 0x07, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x3f, 0xff, 0xfc, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf8, 0xfc, 0x7f, 0x0f, 0x01, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x1f, 0xff, 0xff, 0xf0, 0x80, 0x00, 0xe0, 0xfc, 0xff, 0x3f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x3f, 0x3f, 0x3f, 0x3f, 0x0f, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x3e, 0xfe, 0xfe, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x80, 0xfc, 0xfe, 0xfe, 0xfe, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x02}, {0x00, 0x00, 0x3f, 0xff, 0xff, 0xc0, 0x00, 0x00, 0xe0, 0xff, 0xff, 0x03, 0x03, 0x7f, 0xff, 0xf8, 0x00, 0x00, 0x00, 0xfe, 0xff, 0xff, 0x01, 0x00}, {0x00, 0x00, 0x00, 0x3f, 0xff, 0xff, 0xf0, 0xf0, 0xff, 0x7f, 0x01, 0x00, 0x00, 0x00, 0x0f, 0xff, 0xfe, 0xe0, 0xf8, 0xff, 0xff, 0x01, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x3f, 0x7f, 0x7f, 0x7f, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x7f, 0x7f, 0x7f, 0x7f, 0x01, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x02, 0x0e, 0x3e, 0x7e, 0xfc, 0xf0, 0xc0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf0, 0xfc, 0xfe, 0x3e, 0x0e, 0x06, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x0f, 0x3f, 0xfe, 0xf8, 0xf0, 0xf0, 0xfc, 0x7f, 0x1f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfc, 0x7f, 0x1f, 0x0f, 0x0f, 0x3f, 0xfe, 0xf8, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x40, 0x70, 0x7c, 0x7f, 0x3f, 0x0f, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x7f, 0x7c, 0x78, 0x60, 0x00}},
+                                                                            {{0x00, 0x02, 0x0e, 0x3e, 0xfe, 0xfc, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xfc, 0xfe, 0x3e, 0x0e, 0x02, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x3f, 0xff, 0xf8, 0xe0, 0x80, 0x80, 0xe0, 0xf8, 0xfe, 0x3f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0xff, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+                                                                            {{0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xce, 0xfe, 0xfe, 0xfe, 0x7e, 0x1e, 0x0e, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0xfe, 0x7f, 0x1f, 0x0f, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf0, 0xf8, 0xfe, 0x7f, 0x1f, 0x0f, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x78, 0x7e, 0x7f, 0x7f, 0x7f, 0x73, 0x71, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00}}};
+
+/**
+ * @brief Blank columns to clear the page around the text
+ */
+static const uint8_t BIG_FONT_BLANK[128] = {0};
+
+uint8_t big_font_glyph(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'Z')
+    {
+        return BIG_FONT_FIRST_LETTER + (c - 'A');
+    }
+    return BIG_FONT_SPACE;
+}
+
+void big_font_draw(SSD1306_t *dev, const char *text)
+{
+    uint8_t glyphs[BIG_FONT_MAX_LENGTH];
+    uint8_t length = 0;
+    while (length < BIG_FONT_MAX_LENGTH && text[length] != '\0')
+    {
+        glyphs[length] = big_font_glyph(text[length]);
+        length++;
+    }
+    /*
+    Copy the glyphs of every page straight from the atlas into the framebuffer (centered)
+    */
+    int start = (ssd1306_get_width(dev) - (length * BIG_FONT_WIDTH)) / 2;
+    for (int page = 0; page < BIG_FONT_PAGES; page++)
+    {
+        int seg = start;
+        ssd1306_display_image(dev, page, 0, (uint8_t *)BIG_FONT_BLANK, start);
+        for (uint8_t i = 0; i < length; i++)
+        {
+            ssd1306_display_image(dev, page, seg, (uint8_t *)BIG_CHARS[glyphs[i]][page], BIG_FONT_WIDTH);
+            seg += BIG_FONT_WIDTH;
+        }
+        ssd1306_display_image(dev, page, seg, (uint8_t *)BIG_FONT_BLANK, ssd1306_get_width(dev) - seg);
+    }
+}
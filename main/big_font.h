@@ -0,0 +1,54 @@
+/**
+ * @file big_font.h
+ * @brief BIG FONT is the glyph atlas of the big chars shown on the display (bpm, tap hits, TAP).
+ * Every glyph is 4 pages high and 24 columns wide and it is stored in flash with the layout of the
+ * framebuffer of the SSD1306 (one byte per column, page after page): drawing a text is a copy of the
+ * columns of its glyphs into every page, with no image built at draw time.
+ */
+
+#ifndef BC_BIG_FONT_H
+#define BC_BIG_FONT_H
+
+#include "main_defs.h"
+#include "../components/ssd1306/ssd1306.h"
+
+/**
+ * @{ \name Size of the glyphs
+ */
+#define BIG_FONT_WIDTH 24
+#define BIG_FONT_PAGES 4
+/**
+ * @}
+ */
+
+/**
+ * @{ \name Glyphs of the atlas: digits, whitespace and letters
+ */
+#define BIG_FONT_GLYPHS 37
+#define BIG_FONT_SPACE 10
+#define BIG_FONT_FIRST_LETTER 11
+/**
+ * @}
+ */
+
+/**
+ * @brief Max number of chars of a text (128 columns)
+ */
+#define BIG_FONT_MAX_LENGTH 5
+
+/**
+ * @brief Glyph atlas (flash)
+ */
+extern const uint8_t BIG_CHARS[BIG_FONT_GLYPHS][BIG_FONT_PAGES][BIG_FONT_WIDTH];
+
+/**
+ * @brief Returns the index of the glyph of a char: digits and uppercase letters, whitespace for the others
+ */
+uint8_t big_font_glyph(char c);
+
+/**
+ * @brief Draws the text (BIG_FONT_MAX_LENGTH chars at most) centered on the display, clearing the rest of the pages
+ */
+void big_font_draw(SSD1306_t *dev, const char *text);
+
+#endif
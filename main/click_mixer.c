@@ -0,0 +1,125 @@
+#include "click_mixer.h"
+#include <stddef.h>
+#include <math.h>
+
+/**
+ * @brief Synthesizes a click: a sine and its octave with an exponential decay
+ */
+static void click_mixer_synthesize(int16_t *sample, double frequency, double amplitude)
+{
+    for (uint32_t i = 0; i < CLICK_MIXER_SAMPLE_LENGTH; i++)
+    {
+        double t = (double)i / CLICK_MIXER_SAMPLE_RATE;
+        double tone = (sin(2 * M_PI * frequency * t) * 2 / 3) + (sin(4 * M_PI * frequency * t) / 3);
+        sample[i] = (int16_t)(INT16_MAX * amplitude * exp(-t / CLICK_MIXER_DECAY_TIME) * tone);
+    }
+}
+
+void click_mixer_init(click_mixer *mixer)
+{
+    *mixer = (click_mixer){0};
+    click_mixer_synthesize(mixer->samples[CLICK_ACCENT], CLICK_MIXER_ACCENT_FREQUENCY, CLICK_MIXER_ACCENT_AMPLITUDE);
+    click_mixer_synthesize(mixer->samples[CLICK_NORMAL], CLICK_MIXER_NORMAL_FREQUENCY, CLICK_MIXER_NORMAL_AMPLITUDE);
+}
+
+/**
+ * @brief Adds the voices playing to the frames from first to last (excluded)
+ */
+static void click_mixer_mix(click_mixer *mixer, int16_t *frames, uint32_t first, uint32_t last)
+{
+    for (int v = 0; v < CLICK_MIXER_VOICES; v++)
+    {
+        click_voice *voice = &mixer->voices[v];
+        for (uint32_t i = first; i < last && voice->sample != NULL; i++)
+        {
+            int32_t mixed = frames[i] + voice->sample[voice->position++];
+            frames[i] = mixed > INT16_MAX ? INT16_MAX : (mixed < INT16_MIN ? INT16_MIN : mixed);
+            if (voice->position == CLICK_MIXER_SAMPLE_LENGTH)
+            {
+                voice->sample = NULL;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Starts a sample on a free voice (or on the one that has played the most)
+ */
+static void click_mixer_start(click_mixer *mixer, const int16_t *sample)
+{
+    click_voice *chosen = &mixer->voices[0];
+    for (int v = 0; v < CLICK_MIXER_VOICES; v++)
+    {
+        if (mixer->voices[v].sample == NULL)
+        {
+            chosen = &mixer->voices[v];
+            break;
+        }
+        if (mixer->voices[v].position > chosen->position)
+        {
+            chosen = &mixer->voices[v];
+        }
+    }
+    chosen->sample = sample;
+    chosen->position = 0;
+}
+
+/**
+ * @brief Looks for a stop in the schedule: if there is one, the voices are silenced and the clicks
+ * up to the stop are dropped (they were scheduled ahead of the stop)
+ */
+static void click_mixer_apply_stop(click_mixer *mixer)
+{
+    uint32_t head = __atomic_load_n(&mixer->head, __ATOMIC_ACQUIRE);
+    for (uint32_t i = mixer->tail; i != head; i++)
+    {
+        if (mixer->queue[i % CLICK_MIXER_QUEUE_SIZE].type == CLICK_STOP)
+        {
+            for (int v = 0; v < CLICK_MIXER_VOICES; v++)
+            {
+                mixer->voices[v].sample = NULL;
+            }
+            __atomic_store_n(&mixer->tail, i + 1, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+void click_mixer_render(click_mixer *mixer, int16_t *frames, uint32_t length, uint64_t start_time)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        frames[i] = 0;
+    }
+    click_mixer_apply_stop(mixer);
+    uint64_t end_time = start_time + (((uint64_t)length * 1000000) / CLICK_MIXER_SAMPLE_RATE);
+    uint32_t mixed = 0;
+    while (mixer->tail != __atomic_load_n(&mixer->head, __ATOMIC_ACQUIRE))
+    {
+        click next = mixer->queue[mixer->tail % CLICK_MIXER_QUEUE_SIZE];
+        if (next.time >= end_time || next.type == CLICK_STOP)
+        {
+            break; // it starts in a next buffer (a stop scheduled meanwhile is applied by the next render)
+        }
+        /*
+        Frame of the click (rounded to the nearest one): the voices play until it, then the click starts
+        */
+        uint32_t frame = 0;
+        if (next.time >= start_time)
+        {
+            frame = ((next.time - start_time) * CLICK_MIXER_SAMPLE_RATE + 500000) / 1000000;
+            frame = frame < length ? frame : length - 1;
+        }
+        else
+        {
+            mixer->late++;
+        }
+        click_mixer_mix(mixer, frames, mixed, frame);
+        mixed = frame;
+        click_mixer_start(mixer, mixer->samples[next.type]);
+        /*
+        Release the slot only after the click has been read
+        */
+        __atomic_store_n(&mixer->tail, mixer->tail + 1, __ATOMIC_RELEASE);
+    }
+    click_mixer_mix(mixer, frames, mixed, length);
+}
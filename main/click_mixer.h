@@ -0,0 +1,127 @@
+/**
+ * @file click_mixer.h
+ * @brief CLICK MIXER renders the audio click (metronome) as PCM frames.
+ * The clicks are two short samples synthesized at init (accent on the first beat of the bar,
+ * normal on the other quarters). The clock ISR schedules every click with the time (us, esp_timer)
+ * at which it has to be heard: the audio task renders a buffer at a time with the time of its first
+ * frame, so every click starts on the frame of its time (sample accurate) whatever the jitter of the
+ * ISR and of the task. Clicks that overlap are mixed on CLICK_MIXER_VOICES voices.
+ * The schedule is a lock-free queue with a single producer (the clock ISR) and a single consumer
+ * (the audio task). The mixer only uses plain C (and gcc atomics) so that it can be compiled on the
+ * host and rendered to a WAV file.
+ */
+
+#ifndef BC_CLICK_MIXER_H
+#define BC_CLICK_MIXER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Sample rate of the click in Hz
+ */
+#define CLICK_MIXER_SAMPLE_RATE 16000
+
+/**
+ * @brief Length of the click samples in frames (60 ms)
+ */
+#define CLICK_MIXER_SAMPLE_LENGTH ((CLICK_MIXER_SAMPLE_RATE * 60) / 1000)
+
+/**
+ * @brief Number of clicks that can play at the same time
+ */
+#define CLICK_MIXER_VOICES 4
+
+/**
+ * @brief Number of clicks that can wait in the schedule (power of two)
+ */
+#define CLICK_MIXER_QUEUE_SIZE 16
+
+/**
+ * @{ \name Sound of the clicks (frequencies of the old square wave click)
+ */
+#define CLICK_MIXER_ACCENT_FREQUENCY 640
+#define CLICK_MIXER_NORMAL_FREQUENCY 440
+#define CLICK_MIXER_ACCENT_AMPLITUDE 0.8
+#define CLICK_MIXER_NORMAL_AMPLITUDE 0.5
+#define CLICK_MIXER_DECAY_TIME 0.015 // time constant of the envelope in s
+/**
+ * @}
+ */
+
+/**
+ * @brief Type of a scheduled click
+ */
+typedef enum
+{
+    CLICK_ACCENT, /**< First beat of the bar */
+    CLICK_NORMAL, /**< Other quarters */
+    CLICK_STOP, /**< Silences the voices and drops the clicks scheduled before it (transport stop) */
+    CLICK_SAMPLES_LENGTH = CLICK_STOP,
+} click_type;
+
+/**
+ * @brief Click waiting in the schedule
+ */
+typedef struct
+{
+    uint64_t time; /**< Time of the first frame of the click (us, esp_timer) */
+    uint8_t type; /**< Type of the click (click_type) */
+} click;
+
+/**
+ * @brief Voice playing a sample
+ */
+typedef struct
+{
+    const int16_t *sample; /**< Sample being played (NULL if the voice is free) */
+    uint32_t position; /**< Next frame of the sample */
+} click_voice;
+
+/**
+ * @brief State of the mixer.
+ * head and dropped are written only by the producer, tail, voices and late only by the consumer.
+ */
+typedef struct
+{
+    int16_t samples[CLICK_SAMPLES_LENGTH][CLICK_MIXER_SAMPLE_LENGTH]; /**< PCM of the clicks */
+    click queue[CLICK_MIXER_QUEUE_SIZE]; /**< Scheduled clicks, in order of time */
+    uint32_t head; /**< Number of clicks scheduled */
+    uint32_t tail; /**< Number of clicks started */
+    uint32_t dropped; /**< Clicks dropped because the schedule was full */
+    uint32_t late; /**< Clicks started after their time (their first frames were already rendered) */
+    click_voice voices[CLICK_MIXER_VOICES];
+} click_mixer;
+
+/**
+ * @brief Schedules a click (producer, e.g. the clock ISR). Returns false if the schedule is full.
+ * Clicks must be scheduled in order of time.
+ */
+static inline bool click_mixer_schedule(click_mixer *mixer, uint64_t time, click_type type)
+{
+    uint32_t head = mixer->head;
+    if (head - __atomic_load_n(&mixer->tail, __ATOMIC_ACQUIRE) == CLICK_MIXER_QUEUE_SIZE)
+    {
+        mixer->dropped++;
+        return false;
+    }
+    mixer->queue[head % CLICK_MIXER_QUEUE_SIZE] = (click){.time = time, .type = type};
+    /*
+    Publish the click only after it has been written
+    */
+    __atomic_store_n(&mixer->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Synthesizes the samples and clears the schedule and the voices
+ */
+void click_mixer_init(click_mixer *mixer);
+
+/**
+ * @brief Renders length mono frames (consumer, the audio task).
+ * start_time is the time (us, esp_timer) at which the first frame will be heard.
+ */
+void click_mixer_render(click_mixer *mixer, int16_t *frames, uint32_t length, uint64_t start_time);
+
+#endif
@@ -1,11 +1,16 @@
 #include "main_defs.h"
 #include "clock.h"
+#include "bc_seqlock.h"
+#include "clock_ramp.h"
+#include "clock_events.h"
+#include "midi_out.h"
 #include "sync.h"
 #include "onset_adc.h"
+#include "audio_click.h"
+#include <sys/param.h>
 #include "driver/gpio.h"
 #include "driver/gptimer.h"
 #include "driver/uart.h"
-#include "driver/ledc.h"
 #include "hid.h"
 
 /**
@@ -21,65 +26,133 @@
  */
 
 /**
- * @{ \name UART definitions
+ * @{ \name Output scheduling definitions
  */
-#define UART_MIDI_1 UART_NUM_1
-#define UART_MIDI_2 UART_NUM_2
-/**
- * @}
- */
-
-/**
- * @{ \name Audio click definitions
- */
-#define AUDIO_CLICK_TIMER               LEDC_TIMER_0
-#define AUDIO_CLICK_MODE                LEDC_LOW_SPEED_MODE
-#define AUDIO_CLICK_OUTPUT_IO           (GPIO_NUM_15) // Define the output GPIO
-#define AUDIO_CLICK_CHANNEL             LEDC_CHANNEL_0
-#define AUDIO_CLICK_DUTY_RES            LEDC_TIMER_13_BIT // Set duty resolution to 13 bits
-#define AUDIO_CLICK_DUTY                (4095) // Set duty to 50%. ((2 ** 13) - 1) * 50% = 4095
-#define AUDIO_CLICK_FREQUENCY_FIRST     (640) // Frequency in Hertz. Set frequency at 5 kHz
-#define AUDIO_CLICK_FREQUENCY           (440) // Frequency in Hertz. Set frequency at 5 kHz
+#define CLOCK_OUTPUT_MAX_OFFSET 25000 // max offset of an output in us (see MIDI_OFFSET_MAX_VALUE)
+#define CLOCK_ALARM_MIN_DISTANCE 20 // events closer than this (us) are sent in the same alarm
+#define CLOCK_EVENTS_MAX_PER_TICK 8 // max events generated by a tick (all the outputs at the highest rate)
+#define CLOCK_START_ADVANCE 2000 // outputs are started this amount of us before their first tick (SPP + CONTINUE take 1.3ms on the wire)
+#define CLOCK_SYNC_PULSE_WIDTH 5000 // max width of the pulses of the sync output in us
+#define CLOCK_IDLE_ALARM 1000000 // alarm distance when nothing is pending (us)
 /**
  * @}
  */
 
 extern main_runtime_vrbs bc; // main runtime data
-extern SemaphoreHandle_t bc_mutex_handle; // mutex for the access to bc struct
 extern QueueHandle_t onset_adc_task_queue; // queue of onset_adc_task
 TaskHandle_t clock_task_handle;
 QueueHandle_t clock_task_queue;
 gptimer_handle_t clock_timer_handle; // handle for the timer (that triggers cb to send midi clock)
 
-const char MIDI_MSG_TIMING_CLOCK = 248; // MIDI CLOCK MESSAGE byte value
-const char MIDI_MSG_START = 250; // MIDI START MESSAGE byte value
-const char MIDI_MSG_STOP = 252; // MIDI STOP MESSAGE byte value
+const uint8_t MIDI_MSG_TIMING_CLOCK = 248; // MIDI CLOCK MESSAGE byte value
+const uint8_t MIDI_MSG_START = 250; // MIDI START MESSAGE byte value
+const uint8_t MIDI_MSG_STOP = 252; // MIDI STOP MESSAGE byte value
+const uint8_t MIDI_MSG_CONTINUE = 251; // MIDI CONTINUE MESSAGE byte value
+const uint8_t MIDI_MSG_SONG_POSITION = 242; // MIDI SONG POSITION POINTER MESSAGE byte value
 const uint8_t layer_of[TWO_BAR_LENGTH_IN_8TH] = {3, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0}; // layer value for every step in two bars
 volatile uint8_t midi_tick_counter = 0; // current midi clock to send (0-11)
 volatile uint64_t time_until_next_8th = 0; // time until next 8th note
 volatile gptimer_alarm_config_t alarm_config = {
     .reload_count = 0,
     .alarm_count = 1000 * 1000,
-    .flags.auto_reload_on_alarm = true,
+    .flags.auto_reload_on_alarm = false, // the timer is free running: alarms are absolute times
 };
 volatile long long delta_tau_spread[TWO_BAR_LENGTH_IN_8TH] = {0}; // delta for compensating tempo change latency
-volatile int64_t delta_tau_sync = 0; // delta for the sync process
-ledc_timer_config_t audio_click_ledc_timer = {
-    .speed_mode       = AUDIO_CLICK_MODE,
-    .timer_num        = AUDIO_CLICK_TIMER,
-    .duty_resolution  = AUDIO_CLICK_DUTY_RES,
-    .freq_hz          = AUDIO_CLICK_FREQUENCY,  // Set output frequency at 5 kHz
-    .clk_cfg          = LEDC_AUTO_CLK
-};
-ledc_channel_config_t audio_click_ledc_channel = {
-    .speed_mode     = AUDIO_CLICK_MODE,
-    .channel        = AUDIO_CLICK_CHANNEL,
-    .timer_sel      = AUDIO_CLICK_TIMER,
-    .intr_type      = LEDC_INTR_DISABLE,
-    .gpio_num       = AUDIO_CLICK_OUTPUT_IO,
-    .duty           = 0, // Set duty to 0%
-    .hpoint         = 0
+volatile uint32_t tick_period = 0; // period of the MIDI Clock ticks of the current half-8th (without ramp)
+volatile uint64_t next_tick_time = 0; // time of the next tick to generate (timer count)
+uint64_t clock_start_time = 0; // esp_timer time of timer count 0 (START)
+uint32_t clock_lead = 0; // the timeline is generated this amount of us before the ticks (max offset of the outputs)
+clock_ramp ramp; // per tick offsets of the sync and tempo corrections
+portMUX_TYPE ramp_spinlock = portMUX_INITIALIZER_UNLOCKED; // protects ramp between clock_task and the ISR
+#if TRACKING_LATENCY_LOG
+volatile uint64_t tracking_evaluation_start_time = 0; // time of the end of the onset window
+#endif
+
+/**
+ * @brief Outputs of the clock. Each one plays the timeline with its own offset and rate
+ */
+typedef enum
+{
+    CLOCK_OUTPUT_MIDI_1, /**< MIDI OUT 1 (UART_MIDI_1) */
+    CLOCK_OUTPUT_MIDI_2, /**< MIDI OUT 2 (UART_MIDI_2) */
+    CLOCK_OUTPUT_SYNC, /**< DIN sync/analog clock (SYNC_OUT_CLOCK_PIN and SYNC_OUT_RUN_PIN) */
+    CLOCK_OUTPUT_LOCAL, /**< Leds and onset window (always on time) */
+    CLOCK_OUTPUT_AUDIO, /**< Audio click (early of the latency of the audio, see audio_click.h) */
+    CLOCK_OUTPUTS_LENGTH,
+} clock_output_index;
+
+/**
+ * @brief Rate of an output
+ */
+typedef enum
+{
+    CLOCK_RATE_OFF,
+    CLOCK_RATE_1_PPQN,
+    CLOCK_RATE_2_PPQN,
+    CLOCK_RATE_4_PPQN,
+    CLOCK_RATE_12_PPQN, // half-time MIDI Clock
+    CLOCK_RATE_24_PPQN,
+    CLOCK_RATE_48_PPQN, // double-time MIDI Clock
+    CLOCK_RATES_LENGTH,
+} clock_output_rate;
+
+/**
+ * @brief Pulses per quarter note of every rate
+ */
+const uint8_t CLOCK_RATE_PPQN[CLOCK_RATES_LENGTH] = {0, 1, 2, 4, 12, 24, 48};
+
+/**
+ * @brief Rate of the MIDI outputs for every value of the menu (24 PPQN, half-time, double-time)
+ */
+const clock_output_rate MIDI_RATE_OF_MENU_VALUE[] = {CLOCK_RATE_24_PPQN, CLOCK_RATE_12_PPQN, CLOCK_RATE_48_PPQN};
+
+/**
+ * @brief Rate of the sync output for every value of the menu (off, 1, 2, 4 and 24 PPQN)
+ */
+const clock_output_rate SYNC_RATE_OF_MENU_VALUE[] = {CLOCK_RATE_OFF, CLOCK_RATE_1_PPQN, CLOCK_RATE_2_PPQN, CLOCK_RATE_4_PPQN, CLOCK_RATE_24_PPQN};
+
+/**
+ * @brief Max song position of the MIDI Song Position Pointer (14 bits, in 16th notes)
+ */
+#define MIDI_SONG_POSITION_MAX 16383
+
+/**
+ * @brief Settings of an output
+ */
+typedef struct
+{
+    uint32_t offset; // the output is early of this amount of us
+    clock_output_rate rate;
+    uint8_t start_message[4]; // START or SONG POSITION + CONTINUE (encoded by clock_task before the START)
+    uint8_t start_message_length;
+} clock_output;
+
+clock_output clock_outputs[CLOCK_OUTPUTS_LENGTH] = {
+    [CLOCK_OUTPUT_MIDI_1] = {.rate = CLOCK_RATE_24_PPQN},
+    [CLOCK_OUTPUT_MIDI_2] = {.rate = CLOCK_RATE_24_PPQN},
+    [CLOCK_OUTPUT_SYNC] = {.rate = CLOCK_RATE_OFF},
+    [CLOCK_OUTPUT_LOCAL] = {.rate = CLOCK_RATE_24_PPQN},
+    [CLOCK_OUTPUT_AUDIO] = {.offset = AUDIO_CLICK_LATENCY, .rate = CLOCK_RATE_24_PPQN},
 };
+clock_events events; // events of all the outputs ordered by deadline
+uint32_t timeline_tick = 0; // number of ticks generated since START (24 PPQN)
+volatile uint8_t timeline_bar_position = 0; // bar position of the 8th note being generated (bc.bar_position follows it on the local output)
+volatile uint32_t song_8th = 0; // 8th notes played since the beginning of the song (counted by the local output)
+bool clock_running = false; // the timeline is being generated (between START and STOP)
+portMUX_TYPE clock_spinlock = portMUX_INITIALIZER_UNLOCKED; // protects the state of the ISR (events, alarm, outputs) from clock_task and clock_kick
+
+/**
+ * @brief Writes a byte on the UART of a MIDI port (ISR)
+ */
+static void IRAM_ATTR midi_uart_write(int uart, uint8_t byte)
+{
+    uart_tx_chars(uart, (const char *)&byte, 1);
+}
+
+midi_out midi_ports[2] = {
+    [CLOCK_OUTPUT_MIDI_1] = {.write = midi_uart_write, .uart = UART_MIDI_1},
+    [CLOCK_OUTPUT_MIDI_2] = {.write = midi_uart_write, .uart = UART_MIDI_2},
+}; // output engines of MIDI OUT 1 and 2 (the ISR is the only writer of the UARTs)
 
 /**
  * @brief Function to initialize the uart
@@ -90,8 +163,8 @@ static void init_uart()
     Set up first UART module parameters
     */
     uart_config_t uart_config_1 = {
-        .baud_rate = 31250,
-        .data_bits = UART_DATA_7_BITS,
+        .baud_rate = MIDI_OUT_BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
@@ -109,8 +182,8 @@ static void init_uart()
     Set up second UART module parameters
     */
     uart_config_t uart_config_2 = {
-        .baud_rate = 31250,
-        .data_bits = UART_DATA_7_BITS,
+        .baud_rate = MIDI_OUT_BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
@@ -125,109 +198,427 @@ static void init_uart()
 }
 
 /**
- * @brief Function to initialize the audio_click with PWM
-*/
-static void init_audio_click(){
-    ESP_ERROR_CHECK(ledc_timer_config(&audio_click_ledc_timer));
-    ESP_ERROR_CHECK(ledc_channel_config(&audio_click_ledc_channel));
-    ledc_set_duty(AUDIO_CLICK_MODE, AUDIO_CLICK_CHANNEL, AUDIO_CLICK_DUTY);
-    ledc_stop(audio_click_ledc_channel.speed_mode,audio_click_ledc_channel.channel,0);
+ * @brief Pushes an event of an output in the queue (ISR)
+ */
+static void IRAM_ATTR clock_output_push(uint8_t output, clock_event_type type, uint64_t time, uint8_t bar_position, int32_t next_beat)
+{
+    clock_event event = {
+        .deadline = time - clock_outputs[output].offset,
+        .output = output,
+        .type = type,
+        .tick = midi_tick_counter,
+        .bar_position = bar_position,
+        .next_beat = next_beat,
+    };
+    clock_events_push(&events, event);
 }
 
 /**
- * @brief Callback function that sends midi clock and reset timer
-*/
-void IRAM_ATTR send_midi_clock(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *param)
+ * @brief Turns the tick just generated into the events of every output following its rate (ISR)
+ * tick_time is the time of the tick and next_time the time of the following one.
+ * next_beat is the time from the tick to the next 8th note (MIDI_CLOCK_HALFWAY, for bc).
+ */
+static void IRAM_ATTR clock_output_push_tick(uint64_t tick_time, uint64_t next_time, uint8_t bar_position, int32_t next_beat)
 {
-    gptimer_stop(timer);
-    uart_tx_chars(UART_MIDI_1, &MIDI_MSG_TIMING_CLOCK, 1);
-    uart_tx_chars(UART_MIDI_2, &MIDI_MSG_TIMING_CLOCK, 1);
-    switch (midi_tick_counter)
+    for (int i = 0; i < CLOCK_OUTPUTS_LENGTH; i++)
+    {
+        uint8_t ppqn = CLOCK_RATE_PPQN[clock_outputs[i].rate];
+        if (i == CLOCK_OUTPUT_LOCAL)
         {
-        case MIDI_CLOCK_ON_BEAT:
             /*
-            Midi counter = 0/12 (first of the 8th note)
+            The local output only needs the ticks that do something
             */
-            time_until_next_8th = bc.tau + delta_tau_spread[bc.bar_position]; // calculate time distance from now to the next step
-            delta_tau_spread[bc.bar_position] = 0; // reset delta_tau_spread for current position
-            alarm_config.alarm_count = ((time_until_next_8th + 6) / 12); // calculate and set period for MIDI Clock
+            if (midi_tick_counter == MIDI_CLOCK_ON_BEAT || midi_tick_counter == MIDI_CLOCK_LED_OFF ||
+                midi_tick_counter == MIDI_CLOCK_SECOND_THIRD || midi_tick_counter == MIDI_CLOCK_HALFWAY ||
+                midi_tick_counter == MIDI_CLOCK_THIRD_THIRD)
+            {
+                clock_output_push(i, CLOCK_EVENT_TICK, tick_time, bar_position, next_beat);
+            }
+        }
+        else if (i == CLOCK_OUTPUT_AUDIO)
+        {
             /*
-            Turn on led and play audio click based on bar position
+            The audio output only needs the quarter notes (the clicks)
             */
-            switch (bc.bar_position % 8)
+            if (midi_tick_counter == MIDI_CLOCK_ON_BEAT && (bar_position % 2) == 0)
             {
-            case 0:
-                ledc_set_freq(AUDIO_CLICK_MODE,AUDIO_CLICK_TIMER,AUDIO_CLICK_FREQUENCY_FIRST);
-                ledc_update_duty(AUDIO_CLICK_MODE, AUDIO_CLICK_CHANNEL);
-                gpio_set_level(FIRST_LED_PIN, 1);
-                break;
-            case 2:
-                ledc_set_freq(AUDIO_CLICK_MODE,AUDIO_CLICK_TIMER,AUDIO_CLICK_FREQUENCY);
-                ledc_update_duty(AUDIO_CLICK_MODE, AUDIO_CLICK_CHANNEL);
-                gpio_set_level(SECOND_LED_PIN, 1);
-                break;
-            case 4:
-                ledc_update_duty(AUDIO_CLICK_MODE, AUDIO_CLICK_CHANNEL);
-                gpio_set_level(THIRD_LED_PIN, 1);
-                break;
-            case 6:
-                ledc_update_duty(AUDIO_CLICK_MODE, AUDIO_CLICK_CHANNEL);
-                gpio_set_level(FOURTH_LED_PIN, 1);
-                break;
-            default:
-                break;
+                clock_output_push(i, CLOCK_EVENT_TICK, tick_time, bar_position, 0);
             }
-            break;
-        case MIDI_CLOCK_LED_OFF:
+        }
+        else if (ppqn == 48)
+        {
             /*
-            Turn off leds
+            Double-time: this tick and one halfway to the next
             */
-            gpio_set_level(FIRST_LED_PIN, 0);
-            gpio_set_level(SECOND_LED_PIN, 0);
-            gpio_set_level(THIRD_LED_PIN, 0);
-            gpio_set_level(FOURTH_LED_PIN, 0);
+            clock_output_push(i, CLOCK_EVENT_TICK, tick_time, bar_position, 0);
+            clock_output_push(i, CLOCK_EVENT_TICK, (tick_time + next_time) / 2, bar_position, 0);
+        }
+        else if (ppqn > 0 && (timeline_tick % (24 / ppqn)) == 0)
+        {
+            clock_output_push(i, CLOCK_EVENT_TICK, tick_time, bar_position, 0);
+            if (i == CLOCK_OUTPUT_SYNC)
+            {
+                clock_output_push(i, CLOCK_EVENT_PULSE_OFF, tick_time + MIN(CLOCK_SYNC_PULSE_WIDTH, (next_time - tick_time) / 2), bar_position, 0);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Encodes the message that starts a MIDI output (clock_task)
+ * From the beginning of the song it is a MIDI START, otherwise a SONG POSITION POINTER
+ * (in 16th notes of the output, that depend on its rate) followed by a MIDI CONTINUE.
+ */
+static void clock_output_encode_start(uint8_t output, uint32_t position_8th)
+{
+    clock_output *out = &clock_outputs[output];
+    if (position_8th == 0)
+    {
+        out->start_message[0] = MIDI_MSG_START;
+        out->start_message_length = 1;
+        return;
+    }
+    uint32_t position_16th = (position_8th * 2 * CLOCK_RATE_PPQN[out->rate]) / 24;
+    out->start_message[0] = MIDI_MSG_SONG_POSITION;
+    out->start_message[1] = position_16th & 0x7F; // LSB
+    out->start_message[2] = (position_16th >> 7) & 0x7F; // MSB
+    out->start_message[3] = MIDI_MSG_CONTINUE;
+    out->start_message_length = 4;
+}
+
+/**
+ * @brief Starts an output: MIDI START (or SONG POSITION + CONTINUE) or sync run line (ISR)
+ */
+static void IRAM_ATTR clock_output_start(uint8_t output)
+{
+    switch (output)
+    {
+    case CLOCK_OUTPUT_MIDI_1:
+    case CLOCK_OUTPUT_MIDI_2:
+        if (clock_outputs[output].start_message_length == 1)
+        {
+            midi_out_realtime(&midi_ports[output], clock_outputs[output].start_message[0]);
+        }
+        else
+        {
             /*
-            Stop playing audio click
+            SONG POSITION + CONTINUE go together in the system lane
+            (a realtime CONTINUE would pass the SONG POSITION)
             */
-            ledc_stop(audio_click_ledc_channel.speed_mode,audio_click_ledc_channel.channel,0);
+            midi_out_system(&midi_ports[output], clock_outputs[output].start_message, clock_outputs[output].start_message_length);
+        }
+        break;
+    case CLOCK_OUTPUT_SYNC:
+        gpio_set_level(SYNC_OUT_RUN_PIN, 1);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Stops an output: MIDI STOP, sync run line low, leds and audio click off (ISR)
+ */
+static void IRAM_ATTR clock_output_stop(uint8_t output)
+{
+    switch (output)
+    {
+    case CLOCK_OUTPUT_MIDI_1:
+    case CLOCK_OUTPUT_MIDI_2:
+        midi_out_realtime(&midi_ports[output], MIDI_MSG_STOP); // send stop message
+        break;
+    case CLOCK_OUTPUT_SYNC:
+        gpio_set_level(SYNC_OUT_CLOCK_PIN, 0);
+        gpio_set_level(SYNC_OUT_RUN_PIN, 0);
+        break;
+    case CLOCK_OUTPUT_LOCAL:
+        /*
+        Turn off all leds
+        */
+        gpio_set_level(FIRST_LED_PIN, 0);
+        gpio_set_level(SECOND_LED_PIN, 0);
+        gpio_set_level(THIRD_LED_PIN, 0);
+        gpio_set_level(FOURTH_LED_PIN, 0);
+        break;
+    case CLOCK_OUTPUT_AUDIO:
+        audio_click_stop();
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Plays a tick on the local output: leds and onset window (ISR)
+ */
+static void IRAM_ATTR clock_output_local(const clock_event *event)
+{
+    int onset_adc_queue_value;
+    switch (event->tick)
+    {
+    case MIDI_CLOCK_ON_BEAT:
+        song_8th++;
+        /*
+        Turn on led based on bar position
+        */
+        switch (event->bar_position % 8)
+        {
+        case 0:
+            gpio_set_level(FIRST_LED_PIN, 1);
             break;
-        case MIDI_CLOCK_SECOND_THIRD:
-            /*
-            Ask onset_adc_task to stop logging onsets (notch of 16th) and start sync evaluation
-            */
-            int onset_adc_queue_value = ONSET_ADC_DISALLOW_ONSET_AND_START_SYNC;
-            xQueueSendFromISR(onset_adc_task_queue, &onset_adc_queue_value, NULL);
+        case 2:
+            gpio_set_level(SECOND_LED_PIN, 1);
             break;
-        case MIDI_CLOCK_HALFWAY:
-            /*
-            Midi counter = 6/12 (Halfway between two 8th notes)
-            */
-            xSemaphoreTakeFromISR(bc_mutex_handle, NULL);
-            /*
-            Calculate the position of next 8th note keeping into account
-            the delta_tau_sync_factor
-            */
-            time_until_next_8th = (bc.tau / 2) + delta_tau_sync;
-            delta_tau_sync = 0;
-            alarm_config.alarm_count = ((time_until_next_8th + 3) / 6);
-            bc.expected_beat = esp_timer_get_time() + time_until_next_8th;     // set next clock as expected_beat
-            bc.bar_position = (bc.bar_position + 1) % TWO_BAR_LENGTH_IN_8TH; // set new bar position number
-            bc.layer = layer_of[bc.bar_position];
-            xSemaphoreGiveFromISR(bc_mutex_handle,NULL);
+        case 4:
+            gpio_set_level(THIRD_LED_PIN, 1);
             break;
-        case MIDI_CLOCK_THIRD_THIRD:
-            /*
-            Ask onset_adc_task to resume logging onsets
-            */
-            onset_adc_queue_value = ONSET_ADC_ALLOW_ONSET;
-            xQueueSendFromISR(onset_adc_task_queue, &onset_adc_queue_value, NULL);
+        case 6:
+            gpio_set_level(FOURTH_LED_PIN, 1);
             break;
         default:
             break;
         }
+        break;
+    case MIDI_CLOCK_LED_OFF:
+        /*
+        Turn off leds
+        */
+        gpio_set_level(FIRST_LED_PIN, 0);
+        gpio_set_level(SECOND_LED_PIN, 0);
+        gpio_set_level(THIRD_LED_PIN, 0);
+        gpio_set_level(FOURTH_LED_PIN, 0);
+        break;
+    case MIDI_CLOCK_SECOND_THIRD:
+        /*
+        Ask onset_adc_task to stop logging onsets (notch of 16th) and start sync evaluation
+        */
+#if TRACKING_LATENCY_LOG
+        tracking_evaluation_start_time = esp_timer_get_time();
+#endif
+        onset_adc_queue_value = ONSET_ADC_DISALLOW_ONSET_AND_START_SYNC;
+        xQueueSendFromISR(onset_adc_task_queue, &onset_adc_queue_value, NULL);
+        break;
+    case MIDI_CLOCK_HALFWAY:
+        /*
+        Publish the next 8th note when the tick is played (the timeline is generated clock_lead
+        earlier: the tracking compares the onsets with the beat that is being heard)
+        */
+        bc_write_begin_from_isr();
+        bc.expected_beat = BC_TIME_FROM_US(bc, clock_start_time + event->deadline + clock_outputs[CLOCK_OUTPUT_LOCAL].offset) + event->next_beat; // set next clock as expected_beat
+        bc.bar_position = event->bar_position; // set new bar position number
+        bc.layer = layer_of[bc.bar_position];
+        bc_write_end_from_isr();
+        break;
+    case MIDI_CLOCK_THIRD_THIRD:
+        /*
+        Ask onset_adc_task to resume logging onsets
+        */
+        onset_adc_queue_value = ONSET_ADC_ALLOW_ONSET;
+        xQueueSendFromISR(onset_adc_task_queue, &onset_adc_queue_value, NULL);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Sends an event on its output (ISR)
+ */
+static void IRAM_ATTR clock_output_send(const clock_event *event)
+{
+    if (event->type == CLOCK_EVENT_START)
+    {
+        clock_output_start(event->output);
+        return;
+    }
+    if (event->type == CLOCK_EVENT_STOP)
+    {
+        clock_output_stop(event->output);
+        return;
+    }
+    switch (event->output)
+    {
+    case CLOCK_OUTPUT_MIDI_1:
+    case CLOCK_OUTPUT_MIDI_2:
+        midi_out_realtime(&midi_ports[event->output], MIDI_MSG_TIMING_CLOCK);
+        break;
+    case CLOCK_OUTPUT_SYNC:
+        gpio_set_level(SYNC_OUT_CLOCK_PIN, event->type == CLOCK_EVENT_TICK);
+        break;
+    case CLOCK_OUTPUT_LOCAL:
+        clock_output_local(event);
+        break;
+    case CLOCK_OUTPUT_AUDIO:
+        /*
+        The click is heard at the time of the tick: the event comes the latency of the audio before it
+        */
+        audio_click_play(clock_start_time + event->deadline + clock_outputs[CLOCK_OUTPUT_AUDIO].offset,
+                         (event->bar_position % 8) == 0 ? CLICK_ACCENT : CLICK_NORMAL);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Generates the next tick of the timeline (ISR)
+ * It runs clock_lead us before the tick: reads the tempo from bc, queues the tick on every output
+ * and calculates the time of the following one. The position of the timeline is published in bc
+ * by the local output, when the tick is played.
+ */
+static void IRAM_ATTR clock_generate_tick()
+{
+    main_runtime_vrbs current;
+    int32_t next_beat = 0;
+    uint8_t bar_position = timeline_bar_position;
+    switch (midi_tick_counter)
+    {
+    case MIDI_CLOCK_ON_BEAT:
+        /*
+        Midi counter = 0/12 (first of the 8th note)
+        */
+        bc_read(&current);
+        time_until_next_8th = current.tau + delta_tau_spread[bar_position]; // calculate time distance from now to the next step
+        delta_tau_spread[bar_position] = 0; // reset delta_tau_spread for current position
+        tick_period = ((time_until_next_8th + 6) / 12); // calculate period for MIDI Clock
+        break;
+    case MIDI_CLOCK_HALFWAY:
+        /*
+        Midi counter = 6/12 (Halfway between two 8th notes)
+        */
+        portENTER_CRITICAL_ISR(&ramp_spinlock);
+        int32_t beat_offset = clock_ramp_beat_offset(&ramp, CLOCK_RAMP_TICKS_PER_8TH / 2);
+        portEXIT_CRITICAL_ISR(&ramp_spinlock);
+        bc_read(&current);
+        /*
+        Calculate the position of next 8th note keeping into account
+        the ramp of the sync and tempo corrections
+        */
+        time_until_next_8th = current.tau / 2;
+        tick_period = ((time_until_next_8th + 3) / 6);
+        next_beat = time_until_next_8th + beat_offset;
+        bar_position = (bar_position + 1) % TWO_BAR_LENGTH_IN_8TH; // set new bar position number
+        timeline_bar_position = bar_position;
+        break;
+    default:
+        break;
+    }
+    /*
+    Add the offset of the ramp to the period of this tick
+    (never less than a fifth of the period to avoid going back in time)
+    */
+    portENTER_CRITICAL_ISR(&ramp_spinlock);
+    int32_t tick_offset = clock_ramp_pop(&ramp);
+    portEXIT_CRITICAL_ISR(&ramp_spinlock);
+    if (tick_offset < -(int32_t)(tick_period * 4 / 5))
+    {
+        tick_offset = -(int32_t)(tick_period * 4 / 5);
+    }
+    uint64_t tick_time = next_tick_time;
+    next_tick_time += tick_period + tick_offset;
+    clock_output_push_tick(tick_time, next_tick_time, bar_position, next_beat);
+    timeline_tick++;
     midi_tick_counter = (midi_tick_counter + 1) % 12;
+}
+
+/**
+ * @brief Returns the time of the next alarm: earliest event or generation of the next tick (ISR)
+ */
+static uint64_t IRAM_ATTR clock_next_alarm()
+{
+    uint64_t next_alarm = UINT64_MAX;
+    if (clock_running && clock_events_free(&events) >= CLOCK_EVENTS_MAX_PER_TICK)
+    {
+        next_alarm = next_tick_time - clock_lead;
+    }
+    const clock_event *first = clock_events_peek(&events);
+    if (first != NULL && first->deadline < next_alarm)
+    {
+        next_alarm = first->deadline;
+    }
+    return next_alarm;
+}
+
+/**
+ * @brief Sets the alarm of the timer (ISR or task, with clock_spinlock taken)
+ */
+static void IRAM_ATTR clock_set_alarm(uint64_t alarm)
+{
+    alarm_config.alarm_count = alarm;
     ESP_ERROR_CHECK(gptimer_set_alarm_action(clock_timer_handle, &alarm_config));
-    ESP_ERROR_CHECK(gptimer_start(timer));
+}
+
+/**
+ * @brief Callback function that sends midi clock and sets the next alarm
+ * The timer is free running (1 count = 1 us since clock_start_time): every alarm generates the ticks
+ * that are due within clock_lead, sends the events whose deadline has come, fills the gaps between
+ * the clock bytes with the channel messages waiting and sets the alarm to the earliest pending
+ * deadline (one alarm for all the outputs).
+*/
+void IRAM_ATTR send_midi_clock(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *param)
+{
+    uint64_t now = edata->count_value;
+    uint64_t next_alarm;
+    portENTER_CRITICAL_ISR(&clock_spinlock);
+    do
+    {
+        /*
+        Generate the ticks that are due within the lead time
+        */
+        while (clock_running && next_tick_time <= now + clock_lead && clock_events_free(&events) >= CLOCK_EVENTS_MAX_PER_TICK)
+        {
+            clock_generate_tick();
+        }
+        /*
+        Send the events whose deadline has come
+        */
+        clock_event event;
+        while (clock_events_peek(&events) != NULL && clock_events_peek(&events)->deadline <= now)
+        {
+            clock_events_pop(&events, &event);
+            clock_output_send(&event);
+        }
+        next_alarm = clock_next_alarm();
+        /*
+        Write the bytes of the MIDI ports: the realtime ones at once, the others
+        only if they do not delay the next clock event
+        */
+        next_alarm = MIN(next_alarm, midi_out_service(&midi_ports[CLOCK_OUTPUT_MIDI_1], now, next_alarm));
+        next_alarm = MIN(next_alarm, midi_out_service(&midi_ports[CLOCK_OUTPUT_MIDI_2], now, next_alarm));
+        /*
+        If the next alarm is too close (or passed while sending), handle it now
+        */
+        gptimer_get_raw_count(timer, &now);
+    } while (next_alarm <= now + CLOCK_ALARM_MIN_DISTANCE);
+    if (next_alarm == UINT64_MAX)
+    {
+        next_alarm = now + CLOCK_IDLE_ALARM;
+    }
+    clock_set_alarm(next_alarm);
+    portEXIT_CRITICAL_ISR(&clock_spinlock);
+}
+
+void clock_kick()
+{
+    uint64_t now;
+    if (clock_timer_handle == NULL)
+    {
+        return; // not initialized yet: the messages wait for the first alarm
+    }
+    portENTER_CRITICAL(&clock_spinlock);
+    gptimer_get_raw_count(clock_timer_handle, &now);
+    if (alarm_config.alarm_count > now + CLOCK_ALARM_MIN_DISTANCE)
+    {
+        clock_set_alarm(now + CLOCK_ALARM_MIN_DISTANCE);
+    }
+    portEXIT_CRITICAL(&clock_spinlock);
+}
+
+void clock_get_midi_out_stats(uint8_t port, midi_out_stats *stats)
+{
+    portENTER_CRITICAL(&clock_spinlock);
+    midi_out_get_stats(&midi_ports[port], stats);
+    portEXIT_CRITICAL(&clock_spinlock);
 }
 
 void clock_timer_init()
@@ -250,12 +641,95 @@ void clock_timer_init()
     };
     ESP_ERROR_CHECK(gptimer_register_event_callbacks(clock_timer_handle, &cb, (void*)NULL));
     /*
-    Set timer alarm value
+    Set timer alarm value and start it: the timer is always running (the ISR also sends the
+    channel messages when the sequence is stopped)
     */
+    alarm_config.alarm_count = CLOCK_IDLE_ALARM;
     ESP_ERROR_CHECK(gptimer_set_alarm_action(clock_timer_handle, &alarm_config));
     ESP_ERROR_CHECK(gptimer_enable(clock_timer_handle));
+    ESP_ERROR_CHECK(gptimer_set_raw_count(clock_timer_handle, 0));
+    clock_start_time = esp_timer_get_time();
+    ESP_ERROR_CHECK(gptimer_start(clock_timer_handle));
 }
 
+/**
+ * @brief Updates the tempo (write section on bc!)
+ * Adds delta_tau_tempo to bc.tau and distributes it over the next tempo_spread_amount 8th notes
+ * to compensate the latency of the tempo change.
+ * Returns false if the change was rejected or clamped (the period did not move by delta_tau_tempo).
+*/
+static bool apply_delta_tau_tempo(int64_t delta_tau_tempo, uint16_t tempo_spread_amount)
+{
+    bool tempo_too_low = false;
+    bool latency_too_low = false;
+    uint32_t tau;
+    uint8_t bar_position = timeline_bar_position; // the spread is read by the timeline, ahead of bc.bar_position
+    bc_write_begin();
+    if (delta_tau_tempo > bc.tau * -0.8) // this avoids having a too much lower value and going back in time!
+    {
+        bc.tau += delta_tau_tempo;  // update the current bpm
+    }
+    else
+    {
+        tempo_too_low = true;
+    }
+    /*
+    Distribute delta_tau_tempo additional factor over next beats
+    */
+    for (int j = 1; j <= tempo_spread_amount; j++)
+    {
+        delta_tau_spread[(bar_position + j) % TWO_BAR_LENGTH_IN_8TH] += delta_tau_tempo;
+        if (delta_tau_spread[(bar_position + j) % TWO_BAR_LENGTH_IN_8TH] < (long)(bc.tau * -0.8)) // this avoids having a too much lower value and going back in time!
+        {
+            latency_too_low = true;
+            delta_tau_spread[(bar_position + j) % TWO_BAR_LENGTH_IN_8TH] = (long)(bc.tau * -0.8);
+        }
+    }
+    tau = bc.tau;
+    bc_write_end();
+    /*
+    Publish the new bpm to the hid (it wakes up only if the bpm displayed changes)
+    */
+    hid_publish_bpm((30000000 + (tau / 2)) / tau);
+    /*
+    Log outside of the write section
+    */
+    if (tempo_too_low)
+    {
+        ESP_LOGE("CLOCK", "delta_tau_tempo too low!");
+    }
+    if (latency_too_low)
+    {
+        ESP_LOGE("CLOCK", "delta_tau_tempo latency too low!");
+    }
+    return !tempo_too_low && !latency_too_low;
+}
+
+#if TRACKING_LATENCY_LOG
+/**
+ * @brief Logs max and average latency of the tracking stage every two bars of corrections
+*/
+static void log_tracking_latency(uint64_t latency)
+{
+    static uint64_t latency_max = 0;
+    static uint64_t latency_sum = 0;
+    static uint16_t latency_count = 0;
+    if (latency > latency_max)
+    {
+        latency_max = latency;
+    }
+    latency_sum += latency;
+    latency_count++;
+    if (latency_count == TWO_BAR_LENGTH_IN_8TH)
+    {
+        ESP_LOGI("CLOCK", "TRACKING LATENCY max %llu us avg %llu us", latency_max, latency_sum / latency_count);
+        latency_max = 0;
+        latency_sum = 0;
+        latency_count = 0;
+    }
+}
+#endif
+
 /**
  * @brief Main task of the Clock module
 */
@@ -280,8 +754,27 @@ static void clock_task(void *arg)
     /*
     Add reference to the struct fields above to menu
     */
-    set_menu_item_pointer_to_vrb(MENU_INDEX_KICK_DELTA_X, &tempo_spread_amount);
-    uint16_t tempo_latency_smooth = 0; // amount of the latency compensation
+    set_menu_item_pointer_to_vrb(MENU_INDEX_TEMPO_SPREAD, &tempo_spread_amount);
+    uint16_t ramp_curve = CLOCK_RAMP_LINEAR; // curve of the corrections
+    uint16_t ramp_length = 24; // length of the ramp in ticks
+    uint16_t ramp_max_rate = 500; // max change of the period of a tick in us
+    set_menu_item_pointer_to_vrb(MENU_INDEX_CLOCK_RAMP_CURVE, &ramp_curve);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_CLOCK_RAMP_LENGTH, &ramp_length);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_CLOCK_RAMP_MAX_RATE, &ramp_max_rate);
+    static int32_t ramp_phase_offsets[CLOCK_RAMP_MAX_LENGTH]; // phase ramp planned outside of the spinlock
+    static int32_t ramp_tempo_offsets[CLOCK_RAMP_MAX_LENGTH]; // tempo ramp planned outside of the spinlock
+    uint16_t midi_1_offset = 0; // latency compensation of MIDI OUT 1 in us
+    uint16_t midi_2_offset = 0; // latency compensation of MIDI OUT 2 in us
+    set_menu_item_pointer_to_vrb(MENU_INDEX_MIDI_1_OFFSET, &midi_1_offset);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_MIDI_2_OFFSET, &midi_2_offset);
+    uint16_t midi_1_rate = 0; // rate of MIDI OUT 1 (see MIDI_RATE_OF_MENU_VALUE)
+    uint16_t midi_2_rate = 0; // rate of MIDI OUT 2 (see MIDI_RATE_OF_MENU_VALUE)
+    uint16_t sync_out_rate = 0; // rate of SYNC OUT (see SYNC_RATE_OF_MENU_VALUE)
+    bool transport_continue = false; // restart from the next bar of the song instead of the beginning
+    set_menu_item_pointer_to_vrb(MENU_INDEX_MIDI_1_RATE, &midi_1_rate);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_MIDI_2_RATE, &midi_2_rate);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_SYNC_OUT_RATE, &sync_out_rate);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_TRANSPORT_CONTINUE, &transport_continue);
 
     while (1)
     {
@@ -297,66 +790,75 @@ static void clock_task(void *arg)
             int onset_adc_queue_value; // prepare message to be sent to onset_adc_task
             switch (rx_buffer.type)
             {
-            case CLOCK_QUEUE_SET_DELTA_TAU_SYNC:
-                ESP_LOGI("CLOCK","SET SYNC%lld",rx_buffer.value);
-                /*
-                Sync module asked to update sync value
-                */
-                delta_tau_sync = rx_buffer.value;
-                break;
-            case CLOCK_QUEUE_SET_DELTA_TAU_TEMPO:
-                ESP_LOGI("CLOCK","SET TEMPO\t\t %lld",rx_buffer.value);
+            case CLOCK_QUEUE_SET_DELTA_TAU_SYNC_AND_TEMPO:
+                ESP_LOGI("CLOCK","SET SYNC%lld TEMPO\t\t %lld",rx_buffer.value,rx_buffer.value_tempo);
                 /*
-                Tempo module asked to update tempo value (takes mutex on bc!)
+                Tracking module asked to update sync and tempo values
                 */
-                xSemaphoreTake(bc_mutex_handle, portMAX_DELAY);
-                int64_t delta_tau_tempo = rx_buffer.value; // Get delta tau tempo value
-                if (delta_tau_tempo > bc.tau * -0.8) // this avoids having a too much lower value and going back in time!
+                bool tempo_applied = false;
+                if (rx_buffer.value_tempo != 0)
                 {
-                    bc.tau += delta_tau_tempo;  // update the current bpm
-                }
-                else
-                {
-                    ESP_LOGE("CLOCK", "delta_tau_tempo too low!");
+                    tempo_applied = apply_delta_tau_tempo(rx_buffer.value_tempo, tempo_spread_amount);
                 }
                 /*
-                Distribute delta_tau_tempo additional factor over next beats
+                Plan the ramps of the corrections outside of the spinlock: the ISR only waits for
+                the offsets to be added into the ring (no ramp of the tempo if its change was
+                rejected or clamped: the period did not move by value_tempo)
                 */
-                for (int j = 1; j <= tempo_spread_amount; j++)
+                uint16_t phase_length = clock_ramp_plan_phase(rx_buffer.value, ramp_curve, ramp_length, ramp_max_rate, ramp_phase_offsets);
+                uint16_t tempo_length = 0;
+                if (tempo_applied)
                 {
-                    delta_tau_spread[(bc.bar_position + j) % TWO_BAR_LENGTH_IN_8TH] += delta_tau_tempo;
-                    if (delta_tau_spread[(bc.bar_position + j) % TWO_BAR_LENGTH_IN_8TH] < (long)(bc.tau * -0.8)) // this avoids having a too much lower value and going back in time!
-                    {
-                        ESP_LOGE("CLOCK", "delta_tau_tempo latency too low!");
-                        delta_tau_spread[(bc.bar_position + j) % TWO_BAR_LENGTH_IN_8TH] = (long)(bc.tau * -0.8);
-                    }
+                    tempo_length = clock_ramp_plan_tempo(rx_buffer.value_tempo, ramp_curve, ramp_length, ramp_max_rate, ramp_tempo_offsets);
                 }
-                xSemaphoreGive(bc_mutex_handle);
+                portENTER_CRITICAL(&ramp_spinlock);
+                clock_ramp_add_phase(&ramp, ramp_phase_offsets, phase_length, rx_buffer.value);
+                clock_ramp_add_tempo(&ramp, ramp_tempo_offsets, tempo_length);
+                portEXIT_CRITICAL(&ramp_spinlock);
+#if TRACKING_LATENCY_LOG
+                /*
+                Measure the time from the start of the evaluation to the correction applied
+                */
+                log_tracking_latency(esp_timer_get_time() - tracking_evaluation_start_time);
+#endif
                 break;
             case CLOCK_QUEUE_STOP:
                 /*
                 Someone asked to stop sequence
                 */
-                gptimer_stop(clock_timer_handle);
-                uart_write_bytes(UART_MIDI_1, &MIDI_MSG_STOP, 1); // send stop message
-                uart_write_bytes(UART_MIDI_2, &MIDI_MSG_STOP, 1); // send stop message
+                /*
+                Stop the timeline, drop the ticks not yet sent and ask the ISR
+                to stop every output (MIDI STOP, sync run line, leds and audio click)
+                */
+                portENTER_CRITICAL(&clock_spinlock);
+                clock_running = false;
+                clock_events_reset(&events);
+                uint64_t now;
+                gptimer_get_raw_count(clock_timer_handle, &now);
+                for (int i = 0; i < CLOCK_OUTPUTS_LENGTH; i++)
+                {
+                    clock_event stop = {
+                        .deadline = now,
+                        .output = i,
+                        .type = CLOCK_EVENT_STOP,
+                    };
+                    clock_events_push(&events, stop);
+                }
+                clock_set_alarm(now + CLOCK_ALARM_MIN_DISTANCE);
+                portEXIT_CRITICAL(&clock_spinlock);
+                for (int i = CLOCK_OUTPUT_MIDI_1; i <= CLOCK_OUTPUT_MIDI_2; i++)
+                {
+                    midi_out_stats stats;
+                    clock_get_midi_out_stats(i, &stats);
+                    ESP_LOGI("CLOCK", "MIDI OUT %d: %lu bytes (%llu us on the wire), %lu status bytes saved, %lu waiting, %lu dropped",
+                             i + 1, stats.bytes, stats.busy_time, stats.running_status_saved, stats.depth, stats.dropped);
+                }
                 /*
                 Ask onset_adc to stop logging onset 
                 */
                 onset_adc_queue_value = ONSET_ADC_DISALLOW_ONSET;
                 xQueueSend(onset_adc_task_queue, &onset_adc_queue_value, 0);
                 /*
-                Turn off all leds
-                */
-                gpio_set_level(FIRST_LED_PIN, 0);
-                gpio_set_level(SECOND_LED_PIN, 0);
-                gpio_set_level(THIRD_LED_PIN, 0);
-                gpio_set_level(FOURTH_LED_PIN, 0);
-                /*
-                Stop playing audio click
-                */
-                ledc_stop(audio_click_ledc_channel.speed_mode,audio_click_ledc_channel.channel,0);
-                /*
                 Clear the queue
                 */
                 xQueueReset(clock_task_queue);
@@ -371,35 +873,99 @@ static void clock_task(void *arg)
                 Reset parameters
                 */
                 midi_tick_counter = 0;
-                delta_tau_sync = 0;
+                portENTER_CRITICAL(&ramp_spinlock);
+                clock_ramp_reset(&ramp);
+                portEXIT_CRITICAL(&ramp_spinlock);
                 memset(delta_tau_spread, 0, sizeof(delta_tau_spread));
                 time_until_next_8th = 0;
-                xSemaphoreTake(bc_mutex_handle, portMAX_DELAY);
-                bc.bar_position = 0;
-                bc.layer = 3;
-                bc.most_recent_onset_index = 0;
+                /*
+                Find where the song restarts: the beginning or (continue) the bar after
+                the one where it stopped, so that bar_position stays aligned with the sequencers
+                */
+                uint32_t start_8th = 0;
+                if (rx_buffer.value_tempo >= 0)
+                {
+                    /*
+                    Slave mode: the position of the external clock (kept aligned to two bars if the SPP can not reach it)
+                    */
+                    start_8th = rx_buffer.value_tempo;
+                    if (start_8th * 2 * 2 > MIDI_SONG_POSITION_MAX)
+                    {
+                        start_8th %= TWO_BAR_LENGTH_IN_8TH;
+                    }
+                }
+                else if (transport_continue)
+                {
+                    start_8th = ((song_8th + BAR_LENGTH_IN_8TH - 1) / BAR_LENGTH_IN_8TH) * BAR_LENGTH_IN_8TH;
+                    if (start_8th * 2 * 2 > MIDI_SONG_POSITION_MAX) // must fit in the SPP of a double-time output
+                    {
+                        start_8th = 0;
+                    }
+                }
+                song_8th = start_8th;
+                bc_write_begin();
+                bc.bar_position = start_8th % TWO_BAR_LENGTH_IN_8TH;
+                bc.layer = layer_of[bc.bar_position];
+                timeline_bar_position = bc.bar_position;
+                /*
+                The windows start on slot 0, where the first onset of the new epoch is written:
+                the times left in the ring belong to the old epoch and are never compared with the new ones
+                */
+                bc.most_recent_onset_index = ONSET_BUFFER_SIZE - 1;
                 bc.last_relevant_onset_index_for_sync = 0;
                 bc.last_relevant_onset_index_for_tempo = 0;
                 bc.there_is_an_onset = false;
-                xSemaphoreGive(bc_mutex_handle);
+                bc_write_end();
                 /*
                 Ask onset_adc to start logging onsets
                 */
                 onset_adc_queue_value = ONSET_ADC_ALLOW_ONSET;
                 xQueueSend(onset_adc_task_queue, &onset_adc_queue_value, 1);
                 /*
+                Set offsets and rates of the outputs: the timeline is generated in advance
+                of the biggest offset and every output sends its ticks earlier by its offset
+                (the ISR is idle, but it could be sending channel messages)
+                */
+                portENTER_CRITICAL(&clock_spinlock);
+                clock_outputs[CLOCK_OUTPUT_MIDI_1].offset = MIN(midi_1_offset, CLOCK_OUTPUT_MAX_OFFSET);
+                clock_outputs[CLOCK_OUTPUT_MIDI_2].offset = MIN(midi_2_offset, CLOCK_OUTPUT_MAX_OFFSET);
+                clock_outputs[CLOCK_OUTPUT_MIDI_1].rate = MIDI_RATE_OF_MENU_VALUE[MIN(midi_1_rate, 2)];
+                clock_outputs[CLOCK_OUTPUT_MIDI_2].rate = MIDI_RATE_OF_MENU_VALUE[MIN(midi_2_rate, 2)];
+                clock_outputs[CLOCK_OUTPUT_SYNC].rate = SYNC_RATE_OF_MENU_VALUE[MIN(sync_out_rate, 4)];
+                clock_lead = 0;
+                for (int i = 0; i < CLOCK_OUTPUTS_LENGTH; i++)
+                {
+                    clock_lead = MAX(clock_lead, clock_outputs[i].offset);
+                }
+                timeline_tick = 0;
+                clock_output_encode_start(CLOCK_OUTPUT_MIDI_1, start_8th);
+                clock_output_encode_start(CLOCK_OUTPUT_MIDI_2, start_8th);
+                /*
                 Calculate the time at which the first MIDI CLOCK has to be sent
-                */                
-                uint64_t wait_time_until_first_clock = rx_buffer.value - esp_timer_get_time();
-                xQueueReset(clock_task_queue);
+                (if it is too close the sequence starts a bit later)
+                */
+                uint64_t start_count;
+                gptimer_get_raw_count(clock_timer_handle, &start_count);
+                next_tick_time = MAX((int64_t)(rx_buffer.value - clock_start_time), (int64_t)(start_count + clock_lead + CLOCK_START_ADVANCE + CLOCK_ALARM_MIN_DISTANCE));
                 /*
-                Send MIDI START MESSAGE
+                Every output is started (MIDI START or SONG POSITION + CONTINUE, sync run line) a bit before its first tick
                 */
-                uart_write_bytes(UART_MIDI_1, &MIDI_MSG_START, 1);
-                uart_write_bytes(UART_MIDI_2, &MIDI_MSG_START, 1);
-                alarm_config.alarm_count = wait_time_until_first_clock;
-                ESP_ERROR_CHECK(gptimer_set_alarm_action(clock_timer_handle, &alarm_config));
-                gptimer_start(clock_timer_handle);
+                for (int i = 0; i < CLOCK_OUTPUTS_LENGTH; i++)
+                {
+                    if (clock_outputs[i].rate != CLOCK_RATE_OFF)
+                    {
+                        clock_event start = {
+                            .deadline = next_tick_time - clock_outputs[i].offset - CLOCK_START_ADVANCE,
+                            .output = i,
+                            .type = CLOCK_EVENT_START,
+                        };
+                        clock_events_push(&events, start);
+                    }
+                }
+                clock_running = true;
+                clock_set_alarm(MIN(alarm_config.alarm_count, clock_next_alarm()));
+                portEXIT_CRITICAL(&clock_spinlock);
+                xQueueReset(clock_task_queue);
                 break;
             default:
                 ESP_LOGE("CLOCK", "INVALID queue value");
@@ -428,9 +994,18 @@ void clock_init()
     gpio_reset_pin(FOURTH_LED_PIN);
     gpio_set_direction(FOURTH_LED_PIN, GPIO_MODE_OUTPUT);
     /*
+    Set up GPIO pins for the sync output
+    */
+    gpio_reset_pin(SYNC_OUT_CLOCK_PIN);
+    gpio_set_direction(SYNC_OUT_CLOCK_PIN, GPIO_MODE_OUTPUT);
+    gpio_set_level(SYNC_OUT_CLOCK_PIN, 0);
+    gpio_reset_pin(SYNC_OUT_RUN_PIN);
+    gpio_set_direction(SYNC_OUT_RUN_PIN, GPIO_MODE_OUTPUT);
+    gpio_set_level(SYNC_OUT_RUN_PIN, 0);
+    /*
     Create clock_task
     */
     clock_timer_init();
-    init_audio_click();
+    audio_click_init();
     xTaskCreate(clock_task, "Clock_Task", CLOCK_TASK_STACK_SIZE, NULL, CLOCK_TASK_PRIORITY, &clock_task_handle);
 }
\ No newline at end of file
@@ -12,6 +12,8 @@
 #ifndef BC_CLOCK_H
 #define BC_CLOCK_H
 
+#include "midi_out.h"
+
 /**
  * @{ \name GPIO pins for Led 1-4
  */
@@ -30,15 +32,24 @@
  * @}
  */
 
+/**
+ * @{ \name UART definitions
+ */
+#define UART_MIDI_1 UART_NUM_1
+#define UART_MIDI_2 UART_NUM_2
+/**
+ * @}
+ */
+
 /**
  * @{ \name GPIO pins for UART
- * Uart rx pin is set to a dummy value (rx is not needed)
+ * The rx pins receive the external MIDI clock in slave mode (see clock_in.h)
  */
 #if CONFIG_IDF_TARGET_ESP32
 #define UART_MIDI_1_TX GPIO_NUM_26
 #define UART_MIDI_1_RX GPIO_NUM_13
 #define UART_MIDI_2_TX GPIO_NUM_27  
-#define UART_MIDI_2_RX GPIO_NUM_13
+#define UART_MIDI_2_RX GPIO_NUM_35
 #else
 #define UART_MIDI_1_TX GPIO_NUM_17
 #define UART_MIDI_1_RX GPIO_NUM_13
@@ -49,6 +60,24 @@
  * @}
  */
 
+/**
+ * @{ \name GPIO pins for the sync output (DIN sync/analog clock)
+ * The clock pin sends a pulse for every step (1, 2, 4 or 24 PPQN), the run pin is high while the sequence is playing.
+ * Neither is a strapping pin: the device on the sync cable must not change the boot mode at reset.
+ * On the ESP32 every other output pin is taken: the run pin is U0RXD (the console is only written, never read),
+ * so the USB bridge of a devkit must be disconnected from it to use the sync output.
+ */
+#if CONFIG_IDF_TARGET_ESP32
+#define SYNC_OUT_CLOCK_PIN GPIO_NUM_32
+#define SYNC_OUT_RUN_PIN GPIO_NUM_3
+#else
+#define SYNC_OUT_CLOCK_PIN GPIO_NUM_47
+#define SYNC_OUT_RUN_PIN GPIO_NUM_48
+#endif
+/**
+ * @}
+ */
+
 /**
  * @brief Handle for the clock_task queue.
  * Defined inside clock.c
@@ -66,8 +95,7 @@ extern TaskHandle_t clock_task_handle;
  */
 typedef enum
 {
-    CLOCK_QUEUE_SET_DELTA_TAU_SYNC,/**< Asks the clock to update the delta tau value for the sync */
-    CLOCK_QUEUE_SET_DELTA_TAU_TEMPO,/**< Asks the clock to update the delta tau value for the tempo */
+    CLOCK_QUEUE_SET_DELTA_TAU_SYNC_AND_TEMPO,/**< Asks the clock to update both delta tau values (sync in value, tempo in value_tempo) */
     CLOCK_QUEUE_STOP,/**< Asks the clock to stop */
     CLOCK_QUEUE_START,/**< Asks the clock to start */
 } clock_task_queue_entry_type;
@@ -79,9 +107,22 @@ typedef enum
 typedef struct
 {
     clock_task_queue_entry_type type; /**< Type of message (choosen from the clock_task_queue_entry_type enum) */
-    long long value; /**< Value sent (delta tau sync or tempo) */
+    long long value; /**< Value sent (delta tau sync or start time) */
+    long long value_tempo; /**< Delta tau tempo (CLOCK_QUEUE_SET_DELTA_TAU_SYNC_AND_TEMPO) or song position in 8th, -1 to let the clock choose it (CLOCK_QUEUE_START) */
 } clock_task_queue_entry;
 
+/**
+ * @brief Asks the clock ISR to run as soon as possible.
+ * The ISR owns the MIDI UARTs: call this after sending channel messages with midi_out_send on midi_ports
+ * (defined inside clock.c, one output engine for each MIDI output) so that they are sent without waiting for the next clock tick.
+ */
+void clock_kick();
+
+/**
+ * @brief Copies the counters of the output engine of a MIDI port (0: MIDI OUT 1, 1: MIDI OUT 2)
+ */
+void clock_get_midi_out_stats(uint8_t port, midi_out_stats *stats);
+
 /**
  * @brief Init function to be called from the main.
  * This function will initialize the GPIO pins, the UART and creates the clock_task
@@ -0,0 +1,160 @@
+/**
+ * @file clock_events.h
+ * @brief CLOCK EVENTS is the deadline queue of the clock outputs.
+ * The clock module generates the timeline once (24 PPQN) and turns every tick into the events
+ * of each output (MIDI Clock bytes, sync pulses, leds...) with the deadline of that output.
+ * All the events wait in a single queue ordered by deadline (binary min-heap) so that the timer
+ * is always set to the earliest one: adding outputs does not add timer interrupts.
+ * Events with the same deadline keep the order in which they were pushed.
+ * The queue only uses plain C so that it can be compiled on the host.
+ */
+
+#ifndef BC_CLOCK_EVENTS_H
+#define BC_CLOCK_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Max number of events waiting in the queue
+ */
+#define CLOCK_EVENTS_SIZE 128
+
+/**
+ * @brief Type of the event
+ */
+typedef enum
+{
+    CLOCK_EVENT_TICK, /**< Clock tick (MIDI Clock byte, sync pulse on, leds...) */
+    CLOCK_EVENT_PULSE_OFF, /**< End of a sync pulse */
+    CLOCK_EVENT_START, /**< Start of the output (MIDI START, sync run line) */
+    CLOCK_EVENT_STOP, /**< Stop of the output (MIDI STOP, sync run line, leds and audio click off) */
+} clock_event_type;
+
+/**
+ * @brief Event waiting to be sent on an output
+ */
+typedef struct
+{
+    uint64_t deadline; /**< Time of the event (timer count) */
+    uint32_t sequence; /**< Order of push (ties of the deadline) */
+    uint8_t output; /**< Output of the event */
+    uint8_t type; /**< Type of the event (clock_event_type) */
+    uint8_t tick; /**< midi_tick_counter of the tick (0-11) */
+    uint8_t bar_position; /**< Bar position of the tick (the next 8th note for MIDI_CLOCK_HALFWAY) */
+    int32_t next_beat; /**< Time from the tick to the next 8th note, ramp included (only for MIDI_CLOCK_HALFWAY) */
+} clock_event;
+
+/**
+ * @brief Queue of the events
+ */
+typedef struct
+{
+    clock_event events[CLOCK_EVENTS_SIZE];
+    uint16_t count;
+    uint32_t sequence;
+} clock_events;
+
+/**
+ * @brief Returns true if event a has to be sent before event b
+ */
+static inline bool clock_events_before(const clock_event *a, const clock_event *b)
+{
+    if (a->deadline != b->deadline)
+    {
+        return a->deadline < b->deadline;
+    }
+    return (int32_t)(a->sequence - b->sequence) < 0;
+}
+
+/**
+ * @brief Empties the queue
+ */
+static inline void clock_events_reset(clock_events *queue)
+{
+    queue->count = 0;
+    queue->sequence = 0;
+}
+
+/**
+ * @brief Returns the number of events that can still be pushed
+ */
+static inline uint16_t clock_events_free(const clock_events *queue)
+{
+    return CLOCK_EVENTS_SIZE - queue->count;
+}
+
+/**
+ * @brief Returns the earliest event (NULL if the queue is empty)
+ */
+static inline const clock_event *clock_events_peek(const clock_events *queue)
+{
+    return queue->count > 0 ? &queue->events[0] : NULL;
+}
+
+/**
+ * @brief Adds an event to the queue. Returns false if the queue is full.
+ */
+static inline bool clock_events_push(clock_events *queue, clock_event event)
+{
+    if (queue->count == CLOCK_EVENTS_SIZE)
+    {
+        return false;
+    }
+    event.sequence = queue->sequence++;
+    /*
+    Move the event up until its parent comes before it
+    */
+    uint16_t i = queue->count++;
+    while (i > 0)
+    {
+        uint16_t parent = (i - 1) / 2;
+        if (!clock_events_before(&event, &queue->events[parent]))
+        {
+            break;
+        }
+        queue->events[i] = queue->events[parent];
+        i = parent;
+    }
+    queue->events[i] = event;
+    return true;
+}
+
+/**
+ * @brief Removes the earliest event from the queue and copies it in event. Returns false if the queue is empty.
+ */
+static inline bool clock_events_pop(clock_events *queue, clock_event *event)
+{
+    if (queue->count == 0)
+    {
+        return false;
+    }
+    *event = queue->events[0];
+    clock_event last = queue->events[--queue->count];
+    /*
+    Move the last event down from the root until its children come after it
+    */
+    uint16_t i = 0;
+    while (true)
+    {
+        uint16_t child = (2 * i) + 1;
+        if (child >= queue->count)
+        {
+            break;
+        }
+        if (child + 1 < queue->count && clock_events_before(&queue->events[child + 1], &queue->events[child]))
+        {
+            child++;
+        }
+        if (!clock_events_before(&queue->events[child], &last))
+        {
+            break;
+        }
+        queue->events[i] = queue->events[child];
+        i = child;
+    }
+    queue->events[i] = last;
+    return true;
+}
+
+#endif
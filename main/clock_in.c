@@ -0,0 +1,414 @@
+#include "clock_in.h"
+#include "clock_pll.h"
+#include "clock.h"
+#include "bc_seqlock.h"
+#include "tracking.h"
+#include "mode_switch.h"
+#include "hid.h"
+#include <sys/param.h>
+#include "driver/gpio.h"
+#include "driver/uart.h"
+
+/**
+ * @{ \name MIDI messages received
+ */
+#define MIDI_IN_TIMING_CLOCK 0xF8
+#define MIDI_IN_START 0xFA
+#define MIDI_IN_CONTINUE 0xFB
+#define MIDI_IN_STOP 0xFC
+#define MIDI_IN_SONG_POSITION 0xF2
+/**
+ * @}
+ */
+
+/**
+ * @{ \name Timestamps of the received bytes
+ */
+#define CLOCK_IN_TIMESTAMPS_SIZE 64 // ring of the start bit times (power of two)
+#define CLOCK_IN_START_BIT_GAP (MIDI_OUT_BYTE_TIME_US - 16) // falling edges closer than this to the last start bit are inside the byte (us)
+#define CLOCK_IN_STALE_TIME 20000 // timestamps still without a byte after this time are dropped (us)
+/**
+ * @}
+ */
+
+/**
+ * @{ \name Slave mode parameters
+ */
+#define CLOCK_IN_TICKS_PER_8TH 12
+#define CLOCK_IN_TICKS_PER_16TH 6
+#define CLOCK_IN_READ_TIMEOUT_MS 10
+#define CLOCK_IN_IDLE_DELAY_MS 100 // delay of the task when no source is selected
+#define CLOCK_IN_LOST_TIME 500000 // without clock for this time the external clock is lost (us)
+#define CLOCK_IN_START_MARGIN 30000 // the clock starts on the first external 8th at least this far (us)
+#define CLOCK_IN_PHASE_GAIN 0.5 // fraction of the phase error corrected at every 8th (the ramp may still be applying the previous one)
+#define CLOCK_IN_OFFSET_SMOOTHING 0.3 // weight of a new drummer offset
+/**
+ * @}
+ */
+
+extern main_runtime_vrbs bc;
+extern volatile main_mode mode;
+extern QueueHandle_t clock_task_queue;
+extern TaskHandle_t clock_task_handle;
+extern void set_menu_item_pointer_to_vrb(menu_item_index index, void *ptr);
+
+uint16_t clock_in_source = CLOCK_IN_SOURCE_INTERNAL; // source of the clock (menu)
+volatile bool clock_in_following = false;
+volatile int32_t drummer_offset = 0; // smoothed offset of the drummer (us, positive: behind)
+volatile uint32_t external_period = 0; // period of the ticks of the external clock (us, 0 if not locked)
+TaskHandle_t clock_in_task_handle = NULL;
+
+/*
+Ring of the times of the start bits (written by the RX pin ISR, read by clock_in_task)
+*/
+uint64_t start_bit_times[CLOCK_IN_TIMESTAMPS_SIZE];
+uint32_t start_bit_head = 0;
+uint32_t start_bit_tail = 0;
+
+/**
+ * @brief ISR handler of the falling edges of the RX pin
+ * The first falling edge of a byte is its start bit: the following ones (data bits) are skipped.
+ */
+static void IRAM_ATTR clock_in_rx_isr_handler(void *args)
+{
+    static uint64_t last_start_bit = 0;
+    uint64_t now = esp_timer_get_time();
+    if (now - last_start_bit < CLOCK_IN_START_BIT_GAP)
+    {
+        return;
+    }
+    last_start_bit = now;
+    uint32_t head = start_bit_head;
+    if (head - __atomic_load_n(&start_bit_tail, __ATOMIC_ACQUIRE) < CLOCK_IN_TIMESTAMPS_SIZE)
+    {
+        start_bit_times[head % CLOCK_IN_TIMESTAMPS_SIZE] = now;
+        __atomic_store_n(&start_bit_head, head + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief Returns the time of the start bit of the next byte received (now if it is missing)
+ */
+static uint64_t clock_in_pop_timestamp()
+{
+    uint32_t tail = start_bit_tail;
+    if (tail == __atomic_load_n(&start_bit_head, __ATOMIC_ACQUIRE))
+    {
+        return esp_timer_get_time();
+    }
+    uint64_t time = start_bit_times[tail % CLOCK_IN_TIMESTAMPS_SIZE];
+    __atomic_store_n(&start_bit_tail, tail + 1, __ATOMIC_RELEASE);
+    return time;
+}
+
+/**
+ * @brief Drops the timestamps that did not get a byte (glitches on the line)
+ * so that the following bytes are paired with the right start bit.
+ */
+static void clock_in_drop_stale_timestamps()
+{
+    uint64_t now = esp_timer_get_time();
+    uint32_t tail = start_bit_tail;
+    while (tail != __atomic_load_n(&start_bit_head, __ATOMIC_ACQUIRE) &&
+           now - start_bit_times[tail % CLOCK_IN_TIMESTAMPS_SIZE] > CLOCK_IN_STALE_TIME)
+    {
+        tail++;
+    }
+    __atomic_store_n(&start_bit_tail, tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Returns the UART of a source
+ */
+static uart_port_t clock_in_uart(uint16_t source)
+{
+    return source == CLOCK_IN_SOURCE_MIDI_2 ? UART_MIDI_2 : UART_MIDI_1;
+}
+
+/**
+ * @brief Returns the RX pin of a source
+ */
+static gpio_num_t clock_in_pin(uint16_t source)
+{
+    return source == CLOCK_IN_SOURCE_MIDI_2 ? UART_MIDI_2_RX : UART_MIDI_1_RX;
+}
+
+/**
+ * @brief Attaches the start bit ISR to the RX pin of a source (and detaches it from the previous one)
+ */
+static void clock_in_attach(uint16_t previous_source, uint16_t source)
+{
+    if (previous_source != CLOCK_IN_SOURCE_INTERNAL)
+    {
+        gpio_intr_disable(clock_in_pin(previous_source));
+        gpio_isr_handler_remove(clock_in_pin(previous_source));
+    }
+    if (source != CLOCK_IN_SOURCE_INTERNAL)
+    {
+        uart_flush_input(clock_in_uart(source));
+        __atomic_store_n(&start_bit_tail, __atomic_load_n(&start_bit_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+        gpio_set_pull_mode(clock_in_pin(source), GPIO_PULLUP_ONLY); // idle line (no MIDI IN connected)
+        gpio_set_intr_type(clock_in_pin(source), GPIO_INTR_NEGEDGE);
+        gpio_isr_handler_add(clock_in_pin(source), clock_in_rx_isr_handler, NULL);
+        gpio_intr_enable(clock_in_pin(source));
+    }
+}
+
+/**
+ * @brief Starts the sequence on an external 8th (as the Tap module does)
+ * position is the index of the last external tick received since the beginning of the song.
+ * Returns the index of the external tick where the clock starts.
+ */
+static int32_t clock_in_start_following(const clock_pll *pll, int32_t position)
+{
+    /*
+    Find the first external 8th far enough for the clock to start on time
+    */
+    uint64_t now = esp_timer_get_time();
+    int32_t start_tick = ((position / CLOCK_IN_TICKS_PER_8TH) + 1) * CLOCK_IN_TICKS_PER_8TH;
+    while (clock_pll_tick_time(pll, start_tick - position) < now + CLOCK_IN_START_MARGIN)
+    {
+        start_tick += CLOCK_IN_TICKS_PER_8TH;
+    }
+    uint64_t first_beat = clock_pll_tick_time(pll, start_tick - position);
+    ESP_LOGI("CLOCK_IN", "Following the external clock from 8th %ld", start_tick / CLOCK_IN_TICKS_PER_8TH);
+    drummer_offset = 0;
+    bc_write_begin();
+    bc.time_epoch = now;
+    bc.tau = pll->period * CLOCK_IN_TICKS_PER_8TH;
+    bc.expected_beat = BC_TIME_FROM_US(bc, first_beat);
+    bc_write_end();
+    /*
+    Notify the new tempo to the tracking module
+    */
+    clock_in_following = true;
+    tracking_start_spread = 0; // the PLL is locked: default windows
+    xTaskNotify(tracking_task_handle, TRACKING_RESET_PARAMETERS, eSetValueWithOverwrite);
+    xTaskNotify(mode_switch_task_handle, MODE_SWITCH_TO_PLAY, eSetValueWithOverwrite);
+    /*
+    Ask the clock to start on the external 8th at the same song position
+    */
+    clock_task_queue_entry clock_tx_buffer = {
+        .type = CLOCK_QUEUE_START,
+        .value = first_beat,
+        .value_tempo = start_tick / CLOCK_IN_TICKS_PER_8TH,
+    };
+    xQueueReset(clock_task_queue);
+    xQueueSend(clock_task_queue, &clock_tx_buffer, (TickType_t)0);
+    vTaskResume(clock_task_handle);
+    return start_tick;
+}
+
+/**
+ * @brief Stops following the external clock (external STOP or clock lost)
+ */
+static void clock_in_stop_following()
+{
+    clock_in_following = false;
+    if (mode == MODE_PLAY)
+    {
+        xTaskNotify(mode_switch_task_handle, MODE_SWITCH_TO_TAP, eSetValueWithOverwrite);
+    }
+}
+
+/**
+ * @brief Sends to the clock the corrections that keep it on the external 8th just received
+ */
+static void clock_in_correct_clock(const clock_pll *pll)
+{
+    main_runtime_vrbs current;
+    bc_read(&current);
+    /*
+    Phase error against the nearest beat of the clock
+    */
+    int32_t phase_error = BC_TIME_DIFF(BC_TIME_FROM_US(current, (uint64_t)clock_pll_tick_time(pll, 0)), current.expected_beat);
+    while (phase_error > (int32_t)(current.tau / 2))
+    {
+        phase_error -= current.tau;
+    }
+    while (phase_error < -(int32_t)(current.tau / 2))
+    {
+        phase_error += current.tau;
+    }
+    clock_task_queue_entry txBuffer = {
+        .type = CLOCK_QUEUE_SET_DELTA_TAU_SYNC_AND_TEMPO,
+        .value = phase_error * CLOCK_IN_PHASE_GAIN,
+        .value_tempo = (long long)(pll->period * CLOCK_IN_TICKS_PER_8TH) - current.tau,
+    };
+    if (txBuffer.value != 0 || txBuffer.value_tempo != 0)
+    {
+        xQueueSend(clock_task_queue, &txBuffer, (TickType_t)0);
+    }
+}
+
+/**
+ * @brief Main task of the clock_in module
+ */
+static void clock_in_task(void *arg)
+{
+    clock_pll pll;
+    uint16_t source = CLOCK_IN_SOURCE_INTERNAL;
+    bool external_running = false; // between the external START/CONTINUE and STOP
+    int32_t position = -1; // index of the last tick received since the beginning of the song
+    int32_t start_tick = 0; // index of the tick where the clock started following
+    uint32_t song_position = 0; // last SONG POSITION received (16th)
+    uint8_t song_position_bytes = 0; // data bytes of the SONG POSITION still to receive
+    uint8_t buffer[32];
+    clock_pll_reset(&pll);
+    while (1)
+    {
+        /*
+        Follow the source selected in the menu
+        */
+        if (clock_in_source != source)
+        {
+            if (clock_in_following)
+            {
+                clock_in_stop_following();
+            }
+            clock_in_attach(source, clock_in_source);
+            source = clock_in_source;
+            clock_pll_reset(&pll);
+            external_period = 0;
+            external_running = false;
+        }
+        if (source == CLOCK_IN_SOURCE_INTERNAL || !uart_is_driver_installed(clock_in_uart(source)))
+        {
+            vTaskDelay(pdMS_TO_TICKS(CLOCK_IN_IDLE_DELAY_MS));
+            continue;
+        }
+        /*
+        Read the bytes received and pair them with the time of their start bit
+        */
+        int length = uart_read_bytes(clock_in_uart(source), buffer, sizeof(buffer), pdMS_TO_TICKS(CLOCK_IN_READ_TIMEOUT_MS));
+        if (length <= 0)
+        {
+            clock_in_drop_stale_timestamps();
+        }
+        for (int i = 0; i < length; i++)
+        {
+            uint64_t time = clock_in_pop_timestamp();
+            uint8_t byte = buffer[i];
+            if (byte < 0x80)
+            {
+                /*
+                Data byte: only the SONG POSITION is needed
+                */
+                if (song_position_bytes == 2)
+                {
+                    song_position = byte;
+                    song_position_bytes = 1;
+                }
+                else if (song_position_bytes == 1)
+                {
+                    song_position |= (uint32_t)byte << 7;
+                    song_position_bytes = 0;
+                }
+                continue;
+            }
+            if (byte < 0xF8)
+            {
+                song_position_bytes = (byte == MIDI_IN_SONG_POSITION) ? 2 : 0; // any other status byte cancels it
+                continue;
+            }
+            switch (byte)
+            {
+            case MIDI_IN_TIMING_CLOCK:
+                clock_pll_update(&pll, time);
+                external_period = clock_pll_locked(&pll) ? pll.period : 0;
+                if (clock_in_following)
+                {
+                    hid_publish_bpm(clock_in_get_bpm());
+                }
+                if (!external_running)
+                {
+                    break;
+                }
+                position++;
+                if (clock_in_following)
+                {
+                    if (position % CLOCK_IN_TICKS_PER_8TH != 0 || position < start_tick)
+                    {
+                        break;
+                    }
+                    if (mode != MODE_PLAY)
+                    {
+                        clock_in_following = false; // stopped from the buttons: wait for the next START
+                        external_running = false;
+                    }
+                    else
+                    {
+                        clock_in_correct_clock(&pll);
+                    }
+                }
+                else if (mode == MODE_TAP && clock_pll_locked(&pll))
+                {
+                    start_tick = clock_in_start_following(&pll, position);
+                }
+                break;
+            case MIDI_IN_START:
+                position = -1;
+                external_running = true;
+                break;
+            case MIDI_IN_CONTINUE:
+                position = (song_position * CLOCK_IN_TICKS_PER_16TH) - 1;
+                external_running = true;
+                break;
+            case MIDI_IN_STOP:
+                external_running = false;
+                if (clock_in_following)
+                {
+                    clock_in_stop_following();
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        /*
+        Stop if the external clock is lost
+        */
+        if (clock_in_following && esp_timer_get_time() - pll.last_tick > CLOCK_IN_LOST_TIME)
+        {
+            ESP_LOGE("CLOCK_IN", "External clock lost");
+            external_running = false;
+            clock_pll_reset(&pll);
+            external_period = 0;
+            clock_in_stop_following();
+        }
+    }
+}
+
+void clock_in_report_drummer_offset(long long delta_tau_sync)
+{
+    drummer_offset += CLOCK_IN_OFFSET_SMOOTHING * (delta_tau_sync - drummer_offset);
+    int msg_to_hid = HID_DRUMMER_OFFSET_CHANGED;
+    xQueueSend(hid_task_queue, &msg_to_hid, (TickType_t)0);
+}
+
+int32_t clock_in_get_drummer_offset()
+{
+    return drummer_offset;
+}
+
+uint16_t clock_in_get_bpm()
+{
+    uint32_t period = external_period;
+    if (period == 0)
+    {
+        return 0;
+    }
+    return (60000000 + (period * 12)) / (period * 24);
+}
+
+void clock_in_init()
+{
+    /*
+    Add the source to the menu
+    */
+    set_menu_item_pointer_to_vrb(MENU_INDEX_CLOCK_IN_SOURCE, &clock_in_source);
+    /*
+    Create clock_in_task
+    */
+    xTaskCreate(clock_in_task, "Clock_In_Task", CLOCK_IN_TASK_STACK_SIZE, NULL, CLOCK_IN_TASK_PRIORITY, &clock_in_task_handle);
+}
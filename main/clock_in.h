@@ -0,0 +1,64 @@
+/**
+ * @file clock_in.h
+ * @brief CLOCK IN module lets Beat Catcher follow an external MIDI clock (slave mode).
+ * When a source is selected in the menu (CLOCK IN Source: MIDI IN 1 or 2), the module reads the bytes
+ * received on the RX pin of that port:
+ * - MIDI START/CONTINUE (after an optional SONG POSITION) arm the slave mode
+ * - every MIDI CLOCK updates the PLL (clock_pll.h) that estimates tempo and phase of the external clock
+ * - MIDI STOP stops the sequence (back to TAP mode)
+ * Once the PLL is locked, the module starts the clock module on the next 8th of the external clock
+ * (as the Tap module does) and then, at every external 8th, sends to the clock the phase and tempo
+ * corrections that keep it locked to the external clock: the clock keeps sending its outputs, leds
+ * and onset windows, now following the external device.
+ * While following, the tracking module still runs the sync evaluation on the onsets but does not
+ * correct the clock: its delta is the offset of the drummer against the external clock, reported
+ * with clock_in_report_drummer_offset and shown by the hid in PLAY mode (ahead/behind).
+ *
+ * The UART driver owns the RX interrupt and delivers the bytes to the task some ms later, so the
+ * timestamps are captured by a GPIO interrupt on the same RX pin: the falling edge of every start bit
+ * (edges inside a byte are skipped) is pushed in a ring and the task pairs the bytes with their timestamps.
+ */
+
+#ifndef BC_CLOCK_IN_H
+#define BC_CLOCK_IN_H
+
+#include "main_defs.h"
+
+/**
+ * @brief Sources of the clock (values of the CLOCK IN Source menu entry)
+ */
+typedef enum
+{
+    CLOCK_IN_SOURCE_INTERNAL, /**< Beat Catcher is the master (tap and drummer tracking) */
+    CLOCK_IN_SOURCE_MIDI_1, /**< Follow the clock received on MIDI IN 1 (UART_MIDI_1_RX) */
+    CLOCK_IN_SOURCE_MIDI_2, /**< Follow the clock received on MIDI IN 2 (UART_MIDI_2_RX) */
+} clock_in_source_type;
+
+/**
+ * @brief True while the clock follows an external clock (set by the clock_in task)
+ */
+extern volatile bool clock_in_following;
+
+/**
+ * @brief Reports the offset of the drummer against the external clock (tracking task).
+ * delta_tau_sync is the result of the sync evaluation (positive: the drummer is behind).
+ */
+void clock_in_report_drummer_offset(long long delta_tau_sync);
+
+/**
+ * @brief Returns the (smoothed) offset of the drummer against the external clock in us (positive: behind)
+ */
+int32_t clock_in_get_drummer_offset();
+
+/**
+ * @brief Returns the tempo of the external clock in bpm (0 if not locked)
+ */
+uint16_t clock_in_get_bpm();
+
+/**
+ * @brief Init function for the clock_in module
+ * The function adds the source to the menu and creates clock_in_task
+ */
+void clock_in_init();
+
+#endif
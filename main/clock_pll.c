@@ -0,0 +1,82 @@
+#include "clock_pll.h"
+#include <math.h>
+
+/**
+ * @brief A tick farther than this (fraction of the period) from the prediction restarts the estimate
+ */
+#define CLOCK_PLL_MAX_ERROR 0.5
+
+/**
+ * @brief Starts a new estimate from the tick at time
+ */
+static void clock_pll_restart(clock_pll *pll, uint64_t time)
+{
+    pll->next_tick = (double)time + pll->period;
+    pll->last_tick = time;
+    pll->locked_ticks = 0;
+    pll->error = 0;
+}
+
+void clock_pll_reset(clock_pll *pll)
+{
+    *pll = (clock_pll){0};
+}
+
+void clock_pll_update(clock_pll *pll, uint64_t time)
+{
+    pll->ticks++;
+    if (pll->ticks == 1)
+    {
+        pll->last_tick = time;
+        return;
+    }
+    if (pll->ticks == 2 || pll->period == 0)
+    {
+        /*
+        First period: measured between the first two ticks
+        */
+        pll->period = fmin(fmax((double)(time - pll->last_tick), CLOCK_PLL_MIN_PERIOD), CLOCK_PLL_MAX_PERIOD);
+        clock_pll_restart(pll, time);
+        return;
+    }
+    double error = (double)time - pll->next_tick;
+    if (fabs(error) > pll->period * CLOCK_PLL_MAX_ERROR)
+    {
+        /*
+        Tempo jump or lost ticks: measure the period again from the last tick
+        (the same as a new first period if the gap is not too long)
+        */
+        double gap = (double)(time - pll->last_tick);
+        pll->period = fmin(fmax(gap, CLOCK_PLL_MIN_PERIOD), CLOCK_PLL_MAX_PERIOD);
+        clock_pll_restart(pll, time);
+        return;
+    }
+    /*
+    Second order loop: the phase follows a fraction of the error, the period a smaller one
+    */
+    pll->error = error;
+    pll->period = fmin(fmax(pll->period + (CLOCK_PLL_PERIOD_GAIN * error), CLOCK_PLL_MIN_PERIOD), CLOCK_PLL_MAX_PERIOD);
+    pll->next_tick += (CLOCK_PLL_PHASE_GAIN * error) + pll->period;
+    pll->last_tick = time;
+    if (fabs(error) < pll->period * CLOCK_PLL_LOCK_ERROR)
+    {
+        if (pll->locked_ticks < CLOCK_PLL_LOCK_TICKS)
+        {
+            pll->locked_ticks++;
+        }
+    }
+    else
+    {
+        pll->locked_ticks = 0;
+    }
+}
+
+bool clock_pll_locked(const clock_pll *pll)
+{
+    return pll->locked_ticks >= CLOCK_PLL_LOCK_TICKS;
+}
+
+double clock_pll_tick_time(const clock_pll *pll, int32_t ticks_ahead)
+{
+    return pll->next_tick + ((ticks_ahead - 1) * pll->period);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file clock_pll.h
+ * @brief CLOCK PLL estimates the tempo and the phase of an external MIDI clock (slave mode).
+ * The MIDI Clock bytes of the external device (24 PPQN) arrive with the jitter of the sender and
+ * of the wire. The PLL predicts the time of the next tick and, when it arrives, corrects the
+ * prediction with a second order loop: a fraction of the error goes to the phase (CLOCK_PLL_PHASE_GAIN)
+ * and a smaller one to the period (CLOCK_PLL_PERIOD_GAIN). The gains give a critically damped loop
+ * that follows tempo changes in about a quarter note and filters the jitter of the single ticks.
+ * The PLL is locked after CLOCK_PLL_LOCK_TICKS ticks in a row with a small error. A tick far from
+ * the prediction (or a long gap) restarts the estimate.
+ * The PLL only uses plain C math so that it can be compiled on the host.
+ */
+
+#ifndef BC_CLOCK_PLL_H
+#define BC_CLOCK_PLL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Fraction of the error added to the phase
+ */
+#define CLOCK_PLL_PHASE_GAIN 0.2
+
+/**
+ * @brief Fraction of the error added to the period (CLOCK_PLL_PHASE_GAIN^2 / 4: critically damped)
+ */
+#define CLOCK_PLL_PERIOD_GAIN 0.01
+
+/**
+ * @{ \name Period limits of the ticks in us (300 to 30 bpm at 24 PPQN)
+ */
+#define CLOCK_PLL_MIN_PERIOD 8333
+#define CLOCK_PLL_MAX_PERIOD 83333
+/**
+ * @}
+ */
+
+/**
+ * @brief Number of ticks in a row with an error below CLOCK_PLL_LOCK_ERROR to be locked
+ */
+#define CLOCK_PLL_LOCK_TICKS 12
+
+/**
+ * @brief Max error (fraction of the period) of a locked tick
+ */
+#define CLOCK_PLL_LOCK_ERROR 0.1
+
+/**
+ * @brief State of the PLL
+ */
+typedef struct
+{
+    double period; /**< Estimated period of the ticks (us) */
+    double next_tick; /**< Predicted time of the next tick (us) */
+    uint64_t last_tick; /**< Time of the last tick received (us) */
+    uint32_t ticks; /**< Ticks received since the reset */
+    uint16_t locked_ticks; /**< Ticks in a row with a small error */
+    double error; /**< Error of the last tick (us) */
+} clock_pll;
+
+/**
+ * @brief Forgets the estimate: the next two ticks start a new one
+ */
+void clock_pll_reset(clock_pll *pll);
+
+/**
+ * @brief Updates the estimate with a tick received at time (us)
+ */
+void clock_pll_update(clock_pll *pll, uint64_t time);
+
+/**
+ * @brief Returns true if the estimate is stable
+ */
+bool clock_pll_locked(const clock_pll *pll);
+
+/**
+ * @brief Returns the estimated time of the tick that comes ticks_ahead ticks after the last one received
+ * (0: filtered time of the last tick)
+ */
+double clock_pll_tick_time(const clock_pll *pll, int32_t ticks_ahead);
+
+#endif
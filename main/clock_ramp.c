@@ -0,0 +1,204 @@
+#include "clock_ramp.h"
+
+/**
+ * @brief Tick (in the 8th) where a phase ramp starts: MIDI_CLOCK_HALFWAY
+ */
+#define CLOCK_RAMP_PHASE_START_TICK 6
+
+/**
+ * @brief Ticks where the ISR reads bc.tau: MIDI_CLOCK_ON_BEAT and MIDI_CLOCK_HALFWAY
+ */
+#define CLOCK_RAMP_TEMPO_LATCH_TICKS 6
+
+/**
+ * @{ \name Rates of the decays of the curves (per unit of the ramp)
+ */
+#define CLOCK_RAMP_EXPONENTIAL_RATE 4.0
+#define CLOCK_RAMP_CRITICALLY_DAMPED_RATE 6.0
+/**
+ * @}
+ */
+
+/**
+ * @brief Steepest slope of the cumulative shape of the curve (the shape goes from 0 to 1 over a unit):
+ * no tick of a ramp of length L gets more than slope / L of the correction.
+ * - linear: 1
+ * - exponential: a / (1 - exp(-a)), at the start
+ * - critically damped: a / e / (1 - (1 + a) exp(-a)), at x = 1 / a
+ */
+static double clock_ramp_peak_slope(clock_ramp_curve curve)
+{
+    switch (curve)
+    {
+    case CLOCK_RAMP_EXPONENTIAL:
+        return CLOCK_RAMP_EXPONENTIAL_RATE / (1 - exp(-CLOCK_RAMP_EXPONENTIAL_RATE));
+    case CLOCK_RAMP_CRITICALLY_DAMPED:
+        return CLOCK_RAMP_CRITICALLY_DAMPED_RATE * exp(-1) / (1 - ((1 + CLOCK_RAMP_CRITICALLY_DAMPED_RATE) * exp(-CLOCK_RAMP_CRITICALLY_DAMPED_RATE)));
+    case CLOCK_RAMP_STEP:
+    case CLOCK_RAMP_LINEAR:
+    default:
+        return 1;
+    }
+}
+
+/**
+ * @brief Finds the length of the ramp: the given one, made longer so that no tick gets more than max_rate
+ */
+static uint16_t clock_ramp_length(int32_t delta, clock_ramp_curve curve, uint16_t length, uint16_t max_rate)
+{
+    if (length < 1)
+    {
+        length = 1;
+    }
+    if (max_rate > 0)
+    {
+        double min_length = ceil(fabs((double)delta) * clock_ramp_peak_slope(curve) / max_rate);
+        if (min_length > length)
+        {
+            length = (min_length < CLOCK_RAMP_MAX_LENGTH) ? (uint16_t)min_length : CLOCK_RAMP_MAX_LENGTH;
+        }
+    }
+    return (length < CLOCK_RAMP_MAX_LENGTH) ? length : CLOCK_RAMP_MAX_LENGTH;
+}
+
+/**
+ * @brief Writes the rounded cumulative correction at the end of every tick of the ramp:
+ * lround(delta * shape((k + 1) / length)), where the shape goes from 0 (x = 0) to 1 (x = 1).
+ * The decay of the curves is a geometric sequence over the ticks: a single exp per ramp.
+ */
+static void clock_ramp_cumulative(int32_t delta, clock_ramp_curve curve, uint16_t length, int32_t *cumulative)
+{
+    double a = 0;
+    double norm = 1;
+    if (curve == CLOCK_RAMP_EXPONENTIAL)
+    {
+        a = CLOCK_RAMP_EXPONENTIAL_RATE;
+        norm = 1 - exp(-a);
+    }
+    else if (curve == CLOCK_RAMP_CRITICALLY_DAMPED)
+    {
+        a = CLOCK_RAMP_CRITICALLY_DAMPED_RATE;
+        norm = 1 - ((1 + a) * exp(-a));
+    }
+    double ratio = exp(-a / length); // decay over a tick
+    double decay = 1; // exp(-a * x)
+    for (uint16_t k = 0; k < length; k++)
+    {
+        double x = (double)(k + 1) / length;
+        double shape;
+        decay *= ratio;
+        switch (curve)
+        {
+        case CLOCK_RAMP_EXPONENTIAL:
+            shape = (1 - decay) / norm;
+            break;
+        case CLOCK_RAMP_CRITICALLY_DAMPED:
+            shape = (1 - ((1 + (a * x)) * decay)) / norm;
+            break;
+        case CLOCK_RAMP_STEP:
+        case CLOCK_RAMP_LINEAR:
+        default:
+            shape = x;
+            break;
+        }
+        cumulative[k] = lround(delta * shape);
+    }
+    /*
+    The last tick closes the ramp exactly
+    */
+    cumulative[length - 1] = delta;
+}
+
+/**
+ * @brief Finds the first tick not yet sent with the given position modulo the period
+ */
+static uint32_t clock_ramp_next_start(const clock_ramp *ramp, uint8_t position, uint8_t period)
+{
+    uint32_t tick = ramp->next_tick;
+    while ((tick % period) != position)
+    {
+        tick++;
+    }
+    return tick;
+}
+
+void clock_ramp_reset(clock_ramp *ramp)
+{
+    memset(ramp, 0, sizeof(clock_ramp));
+}
+
+uint16_t clock_ramp_plan_phase(int32_t delta, clock_ramp_curve curve, uint16_t length, uint16_t max_rate, int32_t *offsets)
+{
+    if (delta == 0)
+    {
+        return 0;
+    }
+    /*
+    The step curve keeps the old behaviour: the whole correction over the next half-8th
+    */
+    if (curve == CLOCK_RAMP_STEP)
+    {
+        length = CLOCK_RAMP_TICKS_PER_8TH / 2;
+        max_rate = 0;
+    }
+    length = clock_ramp_length(delta, curve, length, max_rate);
+    /*
+    Spread the correction: every tick gets the difference of the rounded cumulative curve
+    (so that the sum is exactly delta)
+    */
+    clock_ramp_cumulative(delta, curve, length, offsets);
+    for (uint16_t k = length - 1; k > 0; k--)
+    {
+        offsets[k] -= offsets[k - 1];
+    }
+    return length;
+}
+
+uint16_t clock_ramp_plan_tempo(int32_t delta_tau, clock_ramp_curve curve, uint16_t length, uint16_t max_rate, int32_t *offsets)
+{
+    /*
+    The step curve keeps the old behaviour: the new period is used at once
+    */
+    int32_t delta_tick = delta_tau / CLOCK_RAMP_TICKS_PER_8TH;
+    if (delta_tick == 0 || curve == CLOCK_RAMP_STEP)
+    {
+        return 0;
+    }
+    length = clock_ramp_length(delta_tick, curve, length, max_rate);
+    /*
+    The ISR already uses the new period: the offsets start from -delta and fade to 0
+    */
+    clock_ramp_cumulative(delta_tick, curve, length, offsets);
+    for (uint16_t k = 0; k < length; k++)
+    {
+        offsets[k] -= delta_tick;
+    }
+    return length;
+}
+
+void clock_ramp_add_phase(clock_ramp *ramp, const int32_t *offsets, uint16_t length, int32_t delta)
+{
+    if (length == 0)
+    {
+        return;
+    }
+    uint32_t start = clock_ramp_next_start(ramp, CLOCK_RAMP_PHASE_START_TICK, CLOCK_RAMP_TICKS_PER_8TH);
+    for (uint16_t k = 0; k < length; k++)
+    {
+        ramp->phase[(start + k) % CLOCK_RAMP_RING_SIZE] += offsets[k];
+    }
+    ramp->pending_phase += delta;
+}
+
+void clock_ramp_add_tempo(clock_ramp *ramp, const int32_t *offsets, uint16_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+    uint32_t start = clock_ramp_next_start(ramp, 0, CLOCK_RAMP_TEMPO_LATCH_TICKS);
+    for (uint16_t k = 0; k < length; k++)
+    {
+        ramp->tempo[(start + k) % CLOCK_RAMP_RING_SIZE] += offsets[k];
+    }
+}
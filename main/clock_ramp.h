@@ -0,0 +1,124 @@
+/**
+ * @file clock_ramp.h
+ * @brief CLOCK RAMP shapes the corrections of the clock over the following MIDI Clock ticks.
+ * Instead of adding the whole delta_tau_sync to a single half-8th and the whole delta_tau_tempo
+ * to the next period, the clock module spreads both corrections over the next ticks (24 PPQN)
+ * following a curve selected from the menu:
+ * - STEP: the old behaviour (sync over the next half-8th, tempo applied at once)
+ * - LINEAR: constant rate over the ramp length
+ * - EXPONENTIAL: most of the correction at the start, then a decaying tail
+ * - CRITICALLY DAMPED: slow start, fast middle, no overshoot
+ *
+ * The ramp is made longer if needed so that no tick changes its period by more than the max rate:
+ * the length comes in closed form from the steepest slope of the curve (no search).
+ *
+ * The ramp is planned by clock_task into a local array of per-tick offsets (in us), outside of the
+ * spinlock of the ring (clock_ramp_plan_phase, clock_ramp_plan_tempo), then added into the ring of
+ * the ISR (clock_ramp_add_phase, clock_ramp_add_tempo): only the additions run with the interrupts
+ * masked. The ISR only adds the offset of the current tick to the period (clock_ramp_pop).
+ * Phase ramps always start on the next HALFWAY tick (as the old delta_tau_sync) and tempo ramps
+ * on the next tick where the ISR reads bc.tau (ON_BEAT or HALFWAY).
+ * The planning functions only use plain C math so that they can be compiled on the host.
+ */
+
+#ifndef BC_CLOCK_RAMP_H
+#define BC_CLOCK_RAMP_H
+
+#include "main_defs.h"
+
+/**
+ * @brief Number of ticks of the ring (power of two)
+ */
+#define CLOCK_RAMP_RING_SIZE 256
+
+/**
+ * @brief Max length of a ramp in ticks (leaves two 8th of margin on the ring)
+ */
+#define CLOCK_RAMP_MAX_LENGTH (CLOCK_RAMP_RING_SIZE - 24)
+
+/**
+ * @brief Number of MIDI Clock ticks in a 8th note
+ */
+#define CLOCK_RAMP_TICKS_PER_8TH 12
+
+/**
+ * @brief Curves available for the ramp
+ */
+typedef enum
+{
+    CLOCK_RAMP_STEP,
+    CLOCK_RAMP_LINEAR,
+    CLOCK_RAMP_EXPONENTIAL,
+    CLOCK_RAMP_CRITICALLY_DAMPED,
+    CLOCK_RAMP_CURVES_LENGTH,
+} clock_ramp_curve;
+
+/**
+ * @brief Ring of the per-tick offsets.
+ * Phase and tempo offsets are kept apart so that the expected beat can include the phase
+ * corrections that are still pending (the tracking must not correct them twice).
+ */
+typedef struct
+{
+    int32_t phase[CLOCK_RAMP_RING_SIZE]; /**< Phase offset of every tick (us) */
+    int32_t tempo[CLOCK_RAMP_RING_SIZE]; /**< Tempo offset of every tick (us) */
+    int32_t pending_phase; /**< Sum of the phase offsets not yet sent */
+    uint32_t next_tick; /**< Absolute index of the next tick (tick % 12 is the MIDI Clock counter) */
+} clock_ramp;
+
+/**
+ * @brief Clears the ring and restarts from tick 0 (ON_BEAT).
+ */
+void clock_ramp_reset(clock_ramp *ramp);
+
+/**
+ * @brief Plans a phase correction (delta_tau_sync): writes the offsets of the ticks of the ramp
+ * (at most CLOCK_RAMP_MAX_LENGTH) and returns their number (0 if there is nothing to do).
+ */
+uint16_t clock_ramp_plan_phase(int32_t delta, clock_ramp_curve curve, uint16_t length, uint16_t max_rate, int32_t *offsets);
+
+/**
+ * @brief Plans the change of period after a tempo correction (delta_tau_tempo already added to bc.tau):
+ * writes the offsets that bring the period from the old value to the new one (at most
+ * CLOCK_RAMP_MAX_LENGTH) and returns their number (0 if there is nothing to do).
+ */
+uint16_t clock_ramp_plan_tempo(int32_t delta_tau, clock_ramp_curve curve, uint16_t length, uint16_t max_rate, int32_t *offsets);
+
+/**
+ * @brief Adds a planned phase ramp (delta is the sum of its offsets) starting from the next HALFWAY tick.
+ */
+void clock_ramp_add_phase(clock_ramp *ramp, const int32_t *offsets, uint16_t length, int32_t delta);
+
+/**
+ * @brief Adds a planned tempo ramp starting from the next tick where the ISR reads bc.tau.
+ */
+void clock_ramp_add_tempo(clock_ramp *ramp, const int32_t *offsets, uint16_t length);
+
+/**
+ * @brief Returns the offset of the current tick and moves to the next one (ISR).
+ */
+static inline int32_t clock_ramp_pop(clock_ramp *ramp)
+{
+    uint32_t index = ramp->next_tick % CLOCK_RAMP_RING_SIZE;
+    int32_t offset = ramp->phase[index] + ramp->tempo[index];
+    ramp->pending_phase -= ramp->phase[index];
+    ramp->phase[index] = 0;
+    ramp->tempo[index] = 0;
+    ramp->next_tick++;
+    return offset;
+}
+
+/**
+ * @brief Returns the offset of the next beat (ISR): tempo offsets of the next ticks and all the pending phase.
+ */
+static inline int32_t clock_ramp_beat_offset(const clock_ramp *ramp, uint8_t ticks)
+{
+    int32_t offset = ramp->pending_phase;
+    for (uint8_t i = 0; i < ticks; i++)
+    {
+        offset += ramp->tempo[(ramp->next_tick + i) % CLOCK_RAMP_RING_SIZE];
+    }
+    return offset;
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include "count_in.h"
+#include <math.h>
+
+/**
+ * @brief Max number of clusters of intervals
+ */
+#define COUNT_IN_MAX_CLUSTERS 32
+
+/**
+ * @brief Cluster of inter-onset intervals
+ */
+typedef struct
+{
+    double sum; // sum of the intervals
+    uint16_t count; // number of intervals
+} count_in_cluster;
+
+void count_in_reset(count_in *state)
+{
+    state->count = 0;
+}
+
+void count_in_configure(count_in *state, uint8_t beats, const tap_tempo_prior *prior)
+{
+    state->beats = (beats < 2) ? 2 : (beats > COUNT_IN_MAX_BEATS) ? COUNT_IN_MAX_BEATS : beats;
+    state->prior = (prior != NULL) ? *prior : (tap_tempo_prior){0};
+    count_in_reset(state);
+}
+
+/**
+ * @brief Adds an interval to the cluster with the nearest mean (or to a new one)
+ */
+static void count_in_cluster_add(count_in_cluster *clusters, uint8_t *length, double interval)
+{
+    for (uint8_t c = 0; c < *length; c++)
+    {
+        double mean = clusters[c].sum / clusters[c].count;
+        if (fabs(interval - mean) <= mean * COUNT_IN_CLUSTER_WIDTH)
+        {
+            clusters[c].sum += interval;
+            clusters[c].count++;
+            return;
+        }
+    }
+    if (*length < COUNT_IN_MAX_CLUSTERS)
+    {
+        clusters[*length] = (count_in_cluster){.sum = interval, .count = 1};
+        (*length)++;
+    }
+}
+
+/**
+ * @brief Walks back from the last onset by one period at a time and collects the onsets on the beats.
+ * Returns the number of beats found (the last onset is the first one), up to the beats of the count-in.
+ * beat_times gets the onsets, from the last one backwards.
+ */
+static uint8_t count_in_match_beats(const count_in *state, double period, uint64_t *beat_times)
+{
+    uint8_t beats = 1;
+    beat_times[0] = state->onsets[state->count - 1];
+    int onset = state->count - 2;
+    while (beats < state->beats)
+    {
+        double expected = (double)beat_times[beats - 1] - period;
+        /*
+        Onsets are ordered: skip the ones after the beat window, then take the nearest inside it
+        */
+        while (onset >= 0 && (double)state->onsets[onset] > expected + (period * COUNT_IN_TOLERANCE))
+        {
+            onset--;
+        }
+        int best = -1;
+        for (int i = onset; i >= 0 && (double)state->onsets[i] >= expected - (period * COUNT_IN_TOLERANCE); i--)
+        {
+            if (best < 0 || fabs((double)state->onsets[i] - expected) < fabs((double)state->onsets[best] - expected))
+            {
+                best = i;
+            }
+        }
+        if (best < 0)
+        {
+            break;
+        }
+        beat_times[beats++] = state->onsets[best];
+        onset = best - 1;
+    }
+    return beats;
+}
+
+bool count_in_add(count_in *state, uint64_t time, count_in_result *result)
+{
+    /*
+    A pause longer than a beat restarts the count-in; when full, the oldest onset is dropped
+    */
+    if (state->count > 0 && time - state->onsets[state->count - 1] > COUNT_IN_MAX_PERIOD)
+    {
+        state->count = 0;
+    }
+    if (state->count == COUNT_IN_MAX_ONSETS)
+    {
+        for (uint8_t i = 1; i < COUNT_IN_MAX_ONSETS; i++)
+        {
+            state->onsets[i - 1] = state->onsets[i];
+        }
+        state->count--;
+    }
+    state->onsets[state->count++] = time;
+    result->beats = 1;
+    /*
+    Cluster the intervals between every pair of onsets that can be a beat period
+    (only the ones near the nominal period if the tempo is known)
+    */
+    uint64_t min_period = COUNT_IN_MIN_PERIOD;
+    uint64_t max_period = COUNT_IN_MAX_PERIOD;
+    if (state->prior.period > 0)
+    {
+        min_period = state->prior.period * (1 - state->prior.tolerance);
+        max_period = state->prior.period * (1 + state->prior.tolerance);
+    }
+    count_in_cluster clusters[COUNT_IN_MAX_CLUSTERS];
+    uint8_t clusters_length = 0;
+    for (uint8_t i = 0; i < state->count; i++)
+    {
+        for (uint8_t j = i + 1; j < state->count; j++)
+        {
+            uint64_t interval = state->onsets[j] - state->onsets[i];
+            if (interval >= min_period && interval <= max_period)
+            {
+                count_in_cluster_add(clusters, &clusters_length, (double)interval);
+            }
+        }
+    }
+    /*
+    Keep the candidate with all the beats of the count-in and the biggest cluster
+    */
+    uint64_t beat_times[COUNT_IN_MAX_BEATS];
+    uint64_t best_beat_times[COUNT_IN_MAX_BEATS];
+    int best = -1;
+    for (uint8_t c = 0; c < clusters_length; c++)
+    {
+        uint8_t beats = count_in_match_beats(state, clusters[c].sum / clusters[c].count, beat_times);
+        if (beats > result->beats)
+        {
+            result->beats = beats;
+        }
+        if (beats == state->beats && (best < 0 || clusters[c].count > clusters[best].count))
+        {
+            best = c;
+            for (uint8_t b = 0; b < state->beats; b++)
+            {
+                best_beat_times[b] = beat_times[b];
+            }
+        }
+    }
+    if (best < 0)
+    {
+        return false;
+    }
+    /*
+    Period and phase from the onsets of the beats (in time order)
+    */
+    uint64_t beat_onsets[COUNT_IN_MAX_BEATS];
+    for (uint8_t k = 0; k < state->beats; k++)
+    {
+        beat_onsets[k] = best_beat_times[state->beats - 1 - k];
+    }
+    tap_tempo_estimate(beat_onsets, state->beats, state->prior.period > 0 ? &state->prior : NULL, &result->estimate);
+    result->beats = state->beats;
+    state->count = 0;
+    return true;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file count_in.h
+ * @brief COUNT IN finds tempo and downbeat from the onsets of the drums (hands-free start).
+ * While Beat Catcher waits in TAP mode, the drummer can count in on the pads (e.g. four stick clicks)
+ * or play the first bar of the song. Every onset is added to the count-in, that runs a tempo induction
+ * on the onsets received:
+ * - the inter-onset intervals between every pair of onsets (not only the consecutive ones) are
+ *   clustered: every cluster is a candidate beat period
+ * - a candidate is good if the last beats of the count-in bar, ending with the last onset, all have an onset
+ *   (8th notes and fills between the beats are allowed)
+ * - among the good candidates, the one with more intervals in its cluster wins; its period and phase
+ *   are refined by the tap tempo estimate (tap_tempo.h) on the onsets of the beats
+ * The last onset is then the last beat of the count-in bar, and the clock starts on the next beat
+ * (the predicted downbeat). The induction runs on every onset and takes a few us, so the start
+ * is known as soon as the last beat of the count-in is played.
+ * A pause longer than the slowest beat (COUNT_IN_MAX_PERIOD) restarts the count-in.
+ * The count-in bar has COUNT_IN_BEATS beats, unless the song of the setlist (setlist.h) sets its meter
+ * and its tempo: then the bar has the beats of the meter and only the periods within the tolerance
+ * of the nominal tempo are candidates (count_in_configure).
+ * The module only uses plain C so that it can be compiled on the host.
+ */
+
+#ifndef BC_COUNT_IN_H
+#define BC_COUNT_IN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tap_tempo.h"
+
+/**
+ * @brief Default number of beats of the count-in (one bar)
+ */
+#define COUNT_IN_BEATS 4
+
+/**
+ * @brief Max number of beats of the count-in
+ */
+#define COUNT_IN_MAX_BEATS 8
+
+/**
+ * @brief Number of onsets kept (the oldest are dropped)
+ */
+#define COUNT_IN_MAX_ONSETS 16
+
+/**
+ * @{ \name Limits of the beat period in us (300 to 40 bpm)
+ */
+#define COUNT_IN_MIN_PERIOD 200000
+#define COUNT_IN_MAX_PERIOD 1500000
+/**
+ * @}
+ */
+
+/**
+ * @brief Max distance of an onset from its beat (fraction of the period)
+ */
+#define COUNT_IN_TOLERANCE 0.12
+
+/**
+ * @brief Width of a cluster of intervals (fraction of its mean)
+ */
+#define COUNT_IN_CLUSTER_WIDTH 0.1
+
+/**
+ * @brief Onsets of the count-in
+ */
+typedef struct
+{
+    uint64_t onsets[COUNT_IN_MAX_ONSETS]; /**< Times of the onsets (us), oldest first */
+    uint8_t count; /**< Number of onsets */
+    uint8_t beats; /**< Beats of the count-in bar */
+    tap_tempo_prior prior; /**< Tempo known in advance (period 0 if unknown) */
+} count_in;
+
+/**
+ * @brief Result of the tempo induction
+ */
+typedef struct
+{
+    tap_tempo_result estimate; /**< Estimate on the beats of the count-in: next_beat is the downbeat, where the song starts */
+    uint8_t beats; /**< Beats of the count-in found so far (all the beats of the bar when complete) */
+} count_in_result;
+
+/**
+ * @brief Forgets the onsets
+ */
+void count_in_reset(count_in *state);
+
+/**
+ * @brief Sets the beats of the count-in bar (up to COUNT_IN_MAX_BEATS) and the tempo known in advance
+ * (NULL if unknown), and forgets the onsets
+ */
+void count_in_configure(count_in *state, uint8_t beats, const tap_tempo_prior *prior);
+
+/**
+ * @brief Adds an onset (us) and runs the tempo induction.
+ * Returns true if the count-in is complete: result has the estimate. Otherwise result->beats
+ * tells how many beats have been found so far.
+ */
+bool count_in_add(count_in *state, uint64_t time, count_in_result *result);
+
+#endif
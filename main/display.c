@@ -0,0 +1,61 @@
+#include "display.h"
+
+TaskHandle_t display_task_handle = NULL;
+SSD1306_t display_front; // frame being sent by the display task
+volatile bool display_busy = false; // the display task owns display_front until it is cleared
+uint32_t display_max_blocking = 0; // worst-case time spent in display_flush (us)
+
+bool display_flush(SSD1306_t *back)
+{
+    uint64_t start = esp_timer_get_time();
+    bool handed_over = false;
+    if (!display_busy)
+    {
+        /*
+        Flip: the changed spans go to the front buffer and the back buffer is clean for the next frame
+        */
+        if (ssd1306_copy_dirty(back, &display_front))
+        {
+            display_busy = true;
+            xTaskNotifyGive(display_task_handle);
+        }
+        handed_over = true;
+    }
+    uint32_t blocking = esp_timer_get_time() - start;
+    if (blocking > display_max_blocking)
+    {
+        display_max_blocking = blocking;
+        ESP_LOGI("DISPLAY", "max blocking time in display_flush: %lu us", display_max_blocking);
+    }
+    return handed_over;
+}
+
+uint32_t display_get_max_blocking()
+{
+    return display_max_blocking;
+}
+
+/**
+ * @brief Task that sends the front buffer to the display
+ */
+static void display_task(void *arg)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        ssd1306_flush(&display_front);
+        /*
+        Ack: the front buffer can take the next frame
+        */
+        display_busy = false;
+    }
+}
+
+void display_init(SSD1306_t *back)
+{
+    display_front = *back;
+    /*
+    Create display_task
+    */
+    xTaskCreate(display_task, "Display_Task", DISPLAY_TASK_STACK_SIZE, NULL, DISPLAY_TASK_PRIORITY, &display_task_handle);
+}
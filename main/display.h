@@ -0,0 +1,39 @@
+/**
+ * @file display.h
+ * @brief DISPLAY module transfers the framebuffer of the OLED to the display in the background.
+ * The hid task renders into the framebuffer of the SSD1306 driver (back buffer) and hands the
+ * changed spans to the display task with display_flush, that never waits for the bus:
+ * - if the display task is idle, the dirty spans of the back buffer are copied into the front
+ *   buffer (flip), the back buffer is marked clean and the display task is notified
+ * - if the display task is still sending the previous frame, nothing is done: the back buffer
+ *   stays dirty and its spans are handed over at the next flush
+ * The display task sends the front buffer over I2C (blocking on the bus in its own task, at a lower
+ * priority than the timing tasks) and acknowledges the end of the transfer, so rendering and bus
+ * transfer overlap and the encoder is served while the frame is being sent.
+ * The worst-case time spent by the hid task in display_flush is measured and logged.
+ */
+
+#ifndef BC_DISPLAY_H
+#define BC_DISPLAY_H
+
+#include "main_defs.h"
+#include "../components/ssd1306/ssd1306.h"
+
+/**
+ * @brief Hands the changed spans of the back buffer to the display task (does not wait for the bus).
+ * Returns false if the display task is still busy with the previous frame.
+ */
+bool display_flush(SSD1306_t *back);
+
+/**
+ * @brief Returns the worst-case time spent in display_flush (us)
+ */
+uint32_t display_get_max_blocking();
+
+/**
+ * @brief Initialization of the Display module: the front buffer takes the configuration of the
+ * back buffer (already initialized and flushed) and the display task is created
+ */
+void display_init(SSD1306_t *back);
+
+#endif
@@ -1,73 +1,73 @@
 #include "hid.h"
 #include "sync.h"
 #include "esp_system.h"
-#include "nvs_flash.h"
-#include "nvs.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 #include "driver/pulse_cnt.h"
 #include "../components/ssd1306/ssd1306.h"
 #include "../components/ssd1306/font8x8_basic.h"
+#include "display.h"
+#include "visualizer.h"
+#include "big_font.h"
 #include "onset_adc.h"
+#include "bc_seqlock.h"
+#include "clock_in.h"
+#include "presets.h"
+#include "setlist.h"
+#include "tap.h"
+#include "telemetry.h"
+#include "tracking.h"
+#include <sys/param.h>
 
 // #define TURN_OFF_SCREEN 0 // Uncomment to make the system turn off screen when in sleep mode
 
 extern main_runtime_vrbs bc;
 extern main_mode mode;
 extern bool store_values;
-extern hid_parameter_entry menu_item[MENU_ITEM_INDEX_LENGTH];
 extern QueueHandle_t onset_adc_task_queue; // queue of onset_adc_task
 
-hid_parameter_entry menu_item[MENU_ITEM_INDEX_LENGTH];
+/*
+Entries of the menu (constant) and their current values
+*/
+const hid_parameter_entry menu_item[MENU_ITEM_INDEX_LENGTH] = {
+#define MENU_ITEM_OF_ENTRY(id, top, name, key, type, min, max, default_percentage, step, stored) \
+    [MENU_INDEX_##id] = {top, name, #key, type, min, max, default_percentage, step, stored},
+    BC_MENU_ENTRIES(MENU_ITEM_OF_ENTRY)
+#undef MENU_ITEM_OF_ENTRY
+};
+hid_parameter_value menu_value[MENU_ITEM_INDEX_LENGTH];
 QueueHandle_t hid_task_queue = NULL;
+static volatile int32_t encoder_detents = 0; // detents of the encoder not applied yet (added by the PCNT ISR)
 TaskHandle_t hid_task_handle = NULL;
 SSD1306_t oled_screen;
-nvs_handle_t bc_nvs_handle;
 bool store_values = false;
+uint16_t preset_slot = 0; // slot of the preset selected (menu)
+uint16_t setlist_song_selected = 0; // song of the setlist selected (menu)
+volatile uint32_t hid_wakeups_per_second = 0;
+volatile uint32_t hid_redraws_per_second = 0;
 
-/**
- * @brief Hex representation of big chars (4x) for the SSD1306
- * Index 0-9: numbers 0-9
- * Index 10: whitespace
- * Index 11-35: letters A-Z
- */
-const uint8_t BIG_CHARS[37][4][24] = {{{0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfc, 0x3c, 0x1e, 0x0e, 0x06, 0x07, 0x07, 0x07, 0x0e, 0x0e, 0x1e, 0x3c, 0xfc, 0xf8, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xe0, 0xf0, 0x70, 0x38, 0x3c, 0x3f, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xfc, 0x1c, 0x1e, 0x0f, 0x07, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x0f, 0x1f, 0x3c, 0x38, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x78, 0x38, 0x3e, 0x1f, 0x0f, 0x07, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0xe0, 0xf0, 0x70, 0x70, 0x38, 0x38, 0x38, 0x3c, 0xfc, 0xfe, 0xfe, 0xfa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x2f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0xc0, 0xf0, 0xf8, 0xf8, 0x3c, 0x1c, 0x0c, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x3c, 0xfc, 0xf8, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xff, 0x7f, 0x1f, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xe0, 0xf0, 0x7c, 0x3e, 0x1f, 0x0f, 0x07, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x70, 0x78, 0x7c, 0x7e, 0x7f, 0x67, 0x63, 0x61, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0xc0, 0xe0, 0xf8, 0xf8, 0x3c, 0x1c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1c, 0x3c, 0xfc, 0xf8, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0xc0, 0xc0, 0xf0, 0x7d, 0x7f, 0x3f, 0x0f, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x07, 0x1e, 0xfe, 0xfc, 0xf8, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x07, 0x1f, 0x3f, 0x7c, 0x78, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0x70, 0x78, 0x7c, 0x3f, 0x1f, 0x0f, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0xfc, 0xfe, 0xfe, 0xfe, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0x7e, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0xc0, 0xf0, 0xf8, 0xfe, 0xff, 0xc7, 0xc3, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xff, 0xff, 0xff, 0xff, 0xc0, 0xc0, 0xc0, 0xc0, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xff, 0xff, 0xf7, 0xe0, 0x70, 0x70, 0x70, 0x70, 0x70, 0xf0, 0xf0, 0xe0, 0xe0, 0xc0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0xff, 0xff, 0xfe, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x0f, 0x3f, 0x3e, 0x78, 0x70, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0x70, 0x70, 0x78, 0x3e, 0x3f, 0x0f, 0x07, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xf0, 0xf8, 0x78, 0x3c, 0x1e, 0x1e, 0x0e, 0x0e, 0x07, 0x07, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xe7, 0xe1, 0x70, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x78, 0xf8, 0xf0, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xc1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x1e, 0x3c, 0x38, 0x38, 0x70, 0x70, 0x70, 0x38, 0x38, 0x3c, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xce, 0xfe, 0xfe, 0x7e, 0x1e, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfe, 0x3f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf8, 0xfe, 0x7f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x70, 0x7c, 0x7f, 0x1f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0x80, 0xf0, 0xf8, 0xfc, 0x3c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x7c, 0xf8, 0xf8, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x1f, 0x7f, 0x7f, 0xf0, 0xe0, 0xc0, 0xc0, 0x80, 0x80, 0xc0, 0xc0, 0xe0, 0xf0, 0x7f, 0x3f, 0x1f, 0x03, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xf8, 0xfc, 0xfe, 0x1e, 0x07, 0x03, 0x03, 0x03, 0x01, 0x01, 0x03, 0x03, 0x07, 0x0f, 0x1e, 0xfe, 0xfc, 0xf0, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x0f, 0x1f, 0x3f, 0x7c, 0x78, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xf0, 0x70, 0x78, 0x3e, 0x3f, 0x1f, 0x07, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x80, 0xe0, 0xf0, 0xf8, 0x7c, 0x1c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0xff, 0xff, 0xe1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0x0f, 0x0f, 0x1e, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x0e, 0x07, 0xc7, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x38, 0x3c, 0x3e, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xfc, 0xfc, 0xfc, 0xfc, 0xf0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xf8, 0xff, 0xff, 0x0f, 0x01, 0x00, 0x07, 0x3f, 0xff, 0xfc, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xe0, 0xfc, 0xff, 0xff, 0xe7, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe3, 0xff, 0xff, 0xfe, 0xf0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x40, 0x78, 0x7f, 0x7f, 0x0f, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x7f, 0xff, 0x7c, 0xe0, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xff, 0xfe, 0xfe, 0x0e, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x0e, 0x0e, 0x0e, 0x1e, 0x3c, 0xfc, 0xf8, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xf0, 0xf8, 0xfc, 0x3f, 0x1f, 0x0f, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x07, 0x8f, 0xff, 0xfe, 0xf8, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x3f, 0x3f, 0x3f, 0x38, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x38, 0x38, 0x38, 0x3c, 0x1e, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0x78, 0x3c, 0x1c, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x3c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00}, {0x00, 0x00, 0xfe, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x07, 0x0f, 0x1f, 0x3e, 0x78, 0x70, 0x70, 0xe0, 0xe0, 0xe0, 0xe0, 0x60, 0x70, 0x78, 0x3c, 0x3f, 0x1f, 0x07, 0x01, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1c, 0x1c, 0x1c, 0x38, 0x78, 0xf0, 0xf0, 0xc0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0xff, 0xff, 0xfe, 0xc0, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0x7f, 0x07, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x38, 0x3c, 0x1e, 0x1f, 0x0f, 0x07, 0x03, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x02, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xc0, 0xf0, 0xf8, 0x7c, 0x3c, 0x1e, 0x0e, 0x0e, 0x06, 0x06, 0x0e, 0x0e, 0x0e, 0x1e, 0x3c, 0xfc, 0xf8, 0xe0, 0x80, 0x00, 0x00}, {0x00, 0xe0, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00}, {0x00, 0x07, 0xff, 0xff, 0xff, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x07, 0x0f, 0x1f, 0x3c, 0x38, 0x78, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x38, 0x3c, 0x1f, 0x1f, 0x0f, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfa, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xe0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x2f, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x70, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x3f, 0x3f, 0x3f, 0x3f, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x70, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x40, 0xc0, 0xc0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x03, 0x0f, 0x1f, 0x1f, 0x3c, 0x38, 0x78, 0x70, 0x70, 0x70, 0x70, 0x78, 0x38, 0x3c, 0x1f, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf0, 0xf8, 0x7e, 0x3e, 0x0e, 0x06, 0x02, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x80, 0x80, 0xc0, 0xe0, 0xf8, 0xfc, 0xfe, 0x1f, 0x0f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x3f, 0x0f, 0x07, 0x03, 0x03, 0x0f, 0x1f, 0x7f, 0xfc, 0xf8, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0x1f, 0x3f, 0x7e, 0x78, 0x70, 0x40, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0x02, 0xfe, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x20, 0x7f, 0x7f, 0x7f, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xf0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xf0, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xe1, 0x03, 0x1f, 0xff, 0xfc, 0xe0, 0x00, 0x80, 0xe0, 0xfc, 0xff, 0x1f, 0x03, 0x01, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x07, 0x3f, 0x7f, 0x7f, 0x1f, 0x03, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0xff, 0x7f, 0xff, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0xfc, 0xfc, 0xfc, 0xfe, 0xf8, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0xfc, 0xfc, 0x04, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x07, 0x3f, 0x7f, 0xfc, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x1f, 0x7f, 0xfc, 0xf0, 0xc0, 0x80, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x1f, 0x7f, 0x7f, 0x7f, 0x7f, 0x40, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf0, 0xf8, 0x3c, 0x1c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00, 0x00}, {0x00, 0x00, 0xfe, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0xff, 0xff, 0xfc, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0x7f, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x3e, 0x78, 0x70, 0xf0, 0xe0, 0xe0, 0xe0, 0xe0, 0x70, 0x78, 0x7c, 0x3e, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1c, 0x1c, 0x3c, 0x78, 0xf8, 0xf0, 0xc0, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xe0, 0xff, 0xff, 0x7f, 0x1f, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfc, 0x3e, 0x1e, 0x0f, 0x07, 0x07, 0x07, 0x07, 0x07, 0x0f, 0x0f, 0x1e, 0x7c, 0xfc, 0xf0, 0xe0, 0x00, 0x00, 0x00}, {0x00, 0xf8, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xe0, 0x00}, {0x00, 0x07, 0xff, 0xff, 0xff, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xe0, 0xc0, 0x80, 0x80, 0xc0, 0xff, 0xff, 0x7f, 0x01, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x07, 0x0f, 0x1f, 0x3c, 0x3c, 0x38, 0x70, 0x70, 0x70, 0x79, 0x3b, 0x3f, 0x1f, 0x1f, 0x3f, 0x7f, 0xf9, 0xf0, 0xe0, 0xc0}},
-                                      {{0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0c, 0x1c, 0x3c, 0x7c, 0xf8, 0xf0, 0xe0, 0x80, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xc0, 0xe0, 0xff, 0xff, 0x7f, 0x1f, 0x00, 0x00}, {0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x0f, 0x3f, 0xff, 0xff, 0xe1, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x5f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x7f, 0x7e, 0x78, 0x60, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x00, 0xe0, 0xf0, 0xf8, 0x7c, 0x3c, 0x1e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x1c, 0x3c, 0xf8, 0xf8, 0xf0, 0xc0, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x0f, 0x3f, 0x3f, 0x7c, 0xf8, 0xf0, 0xe0, 0xe0, 0xc0, 0xc0, 0x80, 0x80, 0x80, 0x00, 0x00, 0x01, 0x03, 0x01, 0x03, 0x00, 0x00}, {0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x03, 0x03, 0x03, 0x07, 0x0f, 0x1f, 0x3e, 0xfe, 0xfc, 0xf0, 0x00, 0x00}, {0x00, 0x00, 0x03, 0x07, 0x1f, 0x1f, 0x3e, 0x38, 0x78, 0x70, 0x70, 0x60, 0x60, 0x70, 0x70, 0x70, 0x78, 0x78, 0x3e, 0x1f, 0x0f, 0x07, 0x00, 0x00}},
-                                      {{0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xfe, 0xfe, 0xfe, 0xfe, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0xfe, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00}, {0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x3f, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x3e, 0x3c, 0x78, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x78, 0x3c, 0x3f, 0x1f, 0x0f, 0x03, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x02, 0x1e, 0xfe, 0xfe, 0xf0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xfe, 0xff, 0x3e, 0x07, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x07, 0x3f, 0xff, 0xfc, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf8, 0xfc, 0x7f, 0x0f, 0x01, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x1f, 0xff, 0xff, 0xf0, 0x80, 0x00, 0xe0, 0xfc, 0xff, 0x3f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x3f, 0x3f, 0x3f, 0x3f, 0x0f, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x3e, 0xfe, 0xfe, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x80, 0xfc, 0xfe, 0xfe, 0xfe, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x02}, {0x00, 0x00, 0x3f, 0xff, 0xff, 0xc0, 0x00, 0x00, 0xe0, 0xff, 0xff, 0x03, 0x03, 0x7f, 0xff, 0xf8, 0x00, 0x00, 0x00, 0xfe, 0xff, 0xff, 0x01, 0x00}, {0x00, 0x00, 0x00, 0x3f, 0xff, 0xff, 0xf0, 0xf0, 0xff, 0x7f, 0x01, 0x00, 0x00, 0x00, 0x0f, 0xff, 0xfe, 0xe0, 0xf8, 0xff, 0xff, 0x01, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x3f, 0x7f, 0x7f, 0x7f, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x7f, 0x7f, 0x7f, 0x7f, 0x01, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x02, 0x0e, 0x3e, 0x7e, 0xfc, 0xf0, 0xc0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf0, 0xfc, 0xfe, 0x3e, 0x0e, 0x06, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x0f, 0x3f, 0xfe, 0xf8, 0xf0, 0xf0, 0xfc, 0x7f, 0x1f, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0xfc, 0x7f, 0x1f, 0x0f, 0x0f, 0x3f, 0xfe, 0xf8, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x40, 0x70, 0x7c, 0x7f, 0x3f, 0x0f, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x1f, 0x7f, 0x7c, 0x78, 0x60, 0x00}},
-                                      {{0x00, 0x02, 0x0e, 0x3e, 0xfe, 0xfc, 0xf0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xfc, 0xfe, 0x3e, 0x0e, 0x02, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0x3f, 0xff, 0xf8, 0xe0, 0x80, 0x80, 0xe0, 0xf8, 0xfe, 0x3f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0f, 0xff, 0xff, 0xff, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
-                                      {{0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xce, 0xfe, 0xfe, 0xfe, 0x7e, 0x1e, 0x0e, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xf8, 0xfe, 0x7f, 0x1f, 0x0f, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf0, 0xf8, 0xfe, 0x7f, 0x1f, 0x0f, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x78, 0x7e, 0x7f, 0x7f, 0x7f, 0x73, 0x71, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00}}};
+/*
+Checks of the entries of the menu: lengths and ranges
+*/
+#define MENU_CHECK_ENTRY(id, top, name, key, type, min, max, default_percentage, step, stored)                     \
+    _Static_assert(sizeof(top) <= 16 && sizeof(name) <= 16, "MENU_INDEX_" #id ": name longer than 15 characters"); \
+    _Static_assert(sizeof(#key) <= 16, "MENU_INDEX_" #id ": storage key longer than 15 characters");              \
+    _Static_assert((min) < (max), "MENU_INDEX_" #id ": empty range");                                              \
+    _Static_assert((max) - (min) <= INT32_MAX / 100, "MENU_INDEX_" #id ": range too wide for the scaling");        \
+    _Static_assert((default_percentage) <= 100, "MENU_INDEX_" #id ": default percentage over 100");                \
+    _Static_assert((step) > 0 && (step) <= 100, "MENU_INDEX_" #id ": percentage step out of 1-100");
+BC_MENU_ENTRIES(MENU_CHECK_ENTRY)
+#undef MENU_CHECK_ENTRY
+
+/*
+Checks of the entries of the menu: a storage key used twice is an enumerator declared twice
+*/
+enum
+{
+#define MENU_STORAGE_KEY_OF_ENTRY(id, top, name, key, ...) MENU_STORAGE_KEY_##key,
+    BC_MENU_ENTRIES(MENU_STORAGE_KEY_OF_ENTRY)
+#undef MENU_STORAGE_KEY_OF_ENTRY
+};
 
 /*
 Set pointer of the variable in the selected struct for the menu
@@ -80,72 +80,51 @@ void set_menu_item_pointer_to_vrb(menu_item_index index, void *ptr)
     }
     else
     {
-        menu_item[index].pointer_to_vrb = ptr;
+        menu_value[index].pointer_to_vrb = ptr;
     }
 }
 
 /**
  * @brief Gets the variable value in percentage
  */
-static uint8_t get_variable_perc_value(hid_parameter_entry *variable)
+static uint8_t get_variable_perc_value(menu_item_index index)
 {
-    return variable->percentage;
+    return menu_value[index].percentage;
 }
 
 /**
  * @brief Sets the selected variable to the given value
  */
-static void set_variable_value(hid_parameter_entry *variable, uint8_t percentage_value)
+static void set_variable_value(menu_item_index index, uint8_t percentage_value)
 {
-    if (variable->pointer_to_vrb == NULL)
+    const hid_parameter_entry *variable = &menu_item[index];
+    if (menu_value[index].pointer_to_vrb == NULL)
     {
         ESP_LOGE("set_variable_value", "VARIABLE: %s has a null pointer!", variable->name_displayed);
         return;
     }
     /*
-    Set the percentage value in the struct
-    */
-    variable->percentage = percentage_value;
-    ESP_LOGI("set_variable_value", "VARIABLE: %s", variable->name_displayed);
-    ESP_LOGI("set_variable_value", "variable.percentage set to %d", percentage_value);
-    ESP_LOGI("set_variable_value", "variable.type is %d", variable->vrb_type);
-    /*
-    Convert the percentage value to the correct data to be stored given the vrb_type attribute
+    Set the percentage value and convert it to the value of the variable (integer math, rounded
+    to the nearest value for the menus with few choices)
     */
+    menu_value[index].percentage = percentage_value;
+    int32_t value = variable->min + ((((variable->max - variable->min) * percentage_value) + 50) / 100);
+    ESP_LOGI("set_variable_value", "VARIABLE: %s set to %ld (%d%%)", variable->name_displayed, value, percentage_value);
     switch (variable->vrb_type)
     {
     case BC_UINT64:
-        float return_64 = ((float)(variable->max.u64 - variable->min.u64) / 100);
-        return_64 = return_64 * (float)percentage_value;
-        return_64 = return_64 + variable->min.u64;
-        *(uint64_t *)variable->pointer_to_vrb = (uint64_t)return_64;
-        ESP_LOGI("OLED", "variable_value set to %lld", (uint64_t)return_64);
+        *(uint64_t *)menu_value[index].pointer_to_vrb = (uint64_t)value;
         break;
     case BC_UINT16:
-        float return_16 = ((float)(variable->max.u16 - variable->min.u16) / 100);
-        return_16 = return_16 * (float)percentage_value;
-        return_16 = return_16 + variable->min.u16;
-        *(uint16_t *)variable->pointer_to_vrb = (uint16_t)return_16;
-        ESP_LOGI("OLED", "variable_value set to %d", (uint16_t)return_16);
+        *(uint16_t *)menu_value[index].pointer_to_vrb = (uint16_t)value;
         break;
-    case BC_FLOAT:
-        float return_f = ((float)(variable->max.f - variable->min.f) / 100);
-        return_f = return_f * (float)percentage_value;
-        return_f = return_f + variable->min.f;
-        *(float *)variable->pointer_to_vrb = return_f;
-        ESP_LOGI("OLED", "variable_value set to %f", return_f);
+    case BC_DOUBLE:
+        *(double *)menu_value[index].pointer_to_vrb = (double)value / MENU_DOUBLE_SCALE;
         break;
     case BC_YESNO:
-        if (percentage_value > 0)
-        {
-            *(bool *)variable->pointer_to_vrb = 1;
-            ESP_LOGI("OLED", "variaboole_value set to 1");
-        }
-        else
-        {
-            *(bool *)variable->pointer_to_vrb = 0;
-            ESP_LOGI("OLED", "variaboole_value set to 0");
-        }
+        *(bool *)menu_value[index].pointer_to_vrb = percentage_value > 0;
+        break;
+    case BC_NONE:
         break;
     default:
         ESP_LOGE("OLED", "ERROR in convertin value");
@@ -153,299 +132,232 @@ static void set_variable_value(hid_parameter_entry *variable, uint8_t percentage
     }
 }
 
-/*
-Loads stored values from the NVS partition
-*/
-static void bc_menu_nvs_load()
+/**
+ * @brief Returns the percentage of the preset entry that selects the slot
+ */
+static uint8_t preset_percentage(uint8_t slot)
+{
+    return MIN(slot * menu_item[MENU_INDEX_PRESET].percentage_step, 100);
+}
+
+/**
+ * @brief Returns the percentage of the entry that gives the value (the nearest one)
+ */
+static uint8_t get_percentage_of_value(menu_item_index index, int32_t value)
 {
+    const hid_parameter_entry *variable = &menu_item[index];
+    int32_t range = variable->max - variable->min;
+    value = MIN(MAX(value, variable->min), variable->max);
+    return (((value - variable->min) * 100) + (range / 2)) / range;
+}
+
+/**
+ * @brief Sets the percentages of the song entries from the song selected (the values are not set from
+ * the percentages: they are the ones of the song)
+ */
+static void menu_refresh_song()
+{
+    setlist_song_selected = setlist_get_current();
+    menu_value[MENU_INDEX_SETLIST_SONG].percentage = get_percentage_of_value(MENU_INDEX_SETLIST_SONG, setlist_song_selected);
+    menu_value[MENU_INDEX_SETLIST_BPM].percentage = get_percentage_of_value(MENU_INDEX_SETLIST_BPM, setlist_edit.bpm);
+    menu_value[MENU_INDEX_SETLIST_METER].percentage = get_percentage_of_value(MENU_INDEX_SETLIST_METER, setlist_edit.meter);
+    menu_value[MENU_INDEX_SETLIST_PRESET].percentage = get_percentage_of_value(MENU_INDEX_SETLIST_PRESET, setlist_edit.preset);
+}
+
+/**
+ * @brief Initialize the values of the menu entries
+ * Every value starts from its default percentage (replaced by the one stored in the preset selected, if any),
+ * the pointers to the variables are set from outside with the given function
+ */
+static void menu_init()
+{
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+    {
+        menu_value[i].percentage = menu_item[i].default_percentage;
+        menu_value[i].pointer_to_vrb = NULL;
+    }
+    menu_value[MENU_INDEX_SAVE_VALUES].pointer_to_vrb = &store_values;
+    menu_value[MENU_INDEX_PRESET].pointer_to_vrb = &preset_slot;
+    menu_value[MENU_INDEX_SETLIST_SONG].pointer_to_vrb = &setlist_song_selected;
+    menu_value[MENU_INDEX_SETLIST_BPM].pointer_to_vrb = &setlist_edit.bpm;
+    menu_value[MENU_INDEX_SETLIST_METER].pointer_to_vrb = &setlist_edit.meter;
+    menu_value[MENU_INDEX_SETLIST_PRESET].pointer_to_vrb = &setlist_edit.preset;
+    menu_value[MENU_INDEX_SETLIST_RANGE].pointer_to_vrb = &setlist_range;
     /*
-    Check NVS status
+    Load the values of the preset selected (or the ones stored by the older firmwares)
     */
-    esp_err_t err = nvs_flash_init();
-    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    presets_init();
+    preset_slot = presets_get_active();
+    menu_value[MENU_INDEX_PRESET].percentage = preset_percentage(preset_slot);
+    uint8_t percentages[MENU_ITEM_INDEX_LENGTH];
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
     {
-        /*
-        NVS partition was truncated and needs to be erased
-        Retry nvs_flash_init
-        */
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        err = nvs_flash_init();
+        percentages[i] = menu_value[i].percentage;
     }
-    ESP_ERROR_CHECK(err);
-    err = nvs_open("storage", NVS_READWRITE, &bc_nvs_handle);
-    if (err != ESP_OK)
+    if (!presets_get(preset_slot, percentages) && presets_get_legacy(percentages))
     {
-        ESP_LOGI("hid", "Error (%s) opening NVS handle!\n", esp_err_to_name(err));
+        ESP_LOGI("hid", "Values of the older firmware loaded (saved in slot %u at the next save)", preset_slot + 1);
     }
-    else
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
     {
-        /*
-        If the NVS partition is OK read values from it
-        */
-        for (int i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+        if (menu_item[i].has_corresponding_value)
+        {
+            menu_value[i].percentage = percentages[i];
+        }
+    }
+    /*
+    Load the setlist and the song selected
+    */
+    setlist_init();
+    menu_refresh_song();
+}
+
+/**
+ * @brief Switches to the preset of the slot: its values (from the RAM shadow) are assigned to the variables
+ * and the tracking engines are reset (an empty slot keeps the current values, to be saved into it)
+ */
+static void hid_select_preset(uint8_t slot)
+{
+    uint8_t percentages[MENU_ITEM_INDEX_LENGTH];
+    if (presets_get(slot, percentages))
+    {
+        for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
         {
             if (menu_item[i].has_corresponding_value)
-            { // avoid items that are dummy (Save values and gain)
-                uint8_t perc = menu_item[i].percentage;
-                ESP_LOGI("hid", "Now working on %s", menu_item[i].storage_key);
-                ESP_LOGI("hid", "Current value is: %d", perc);
-                err = nvs_get_u8(bc_nvs_handle, menu_item[i].storage_key, &menu_item[i].percentage);
-                switch (err)
-                {
-                case ESP_OK:
-                    ESP_LOGI("hid", "Found stored value of: %d", menu_item[i].percentage);
-                    break;
-                case ESP_ERR_NVS_NOT_FOUND:
-                    /*
-                    If the current name has not been initialized than set it to 50% value
-                    */
-                    ESP_LOGI("hid", "The value is not initialized yet!");
-                    menu_item[i].percentage = 50;
-                    break;
-                default:
-                    ESP_LOGI("hid", "Error (%s) reading!\n", esp_err_to_name(err));
-                }
+            {
+                set_variable_value(i, percentages[i]);
             }
         }
-        nvs_close(bc_nvs_handle);
-        /*
-        Set the "save value" option to false
-        */
-        menu_item[MENU_INDEX_SAVE_VALUES].percentage = 0;
-        store_values = 0;
     }
+    presets_set_active(slot);
+    /*
+    The menu is used with the clock stopped, so no evaluation runs with a mix of old and new values:
+    the engines restart from their initial state with the new values
+    */
+    tracking_start_spread = 0;
+    xTaskNotify(tracking_task_handle, TRACKING_RESET_PARAMETERS, eSetValueWithOverwrite);
 }
 
 /**
- * @brief Initialize the menu with all the entries
- * For each entry it sets the value but the pointer is set to NULL
- * (must be set from outside with the given function)
- * Whenever a new variable is added to the menu, this function must be updated
+ * @brief Saves all the current values of the menu variables into the preset selected
  */
-static void menu_init()
+static void hid_save_preset()
 {
-    menu_item_index index;
-
-    /* MENU_INDEX_CHECK_GAIN */
-    index = MENU_INDEX_CHECK_GAIN;
-    strcpy(menu_item[index].top_name_displayed, CHECK_GAIN_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, CHECK_GAIN_NAME);
-    strcpy(menu_item[index].storage_key, "dummy_gain_name");
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_FLOAT;
-    menu_item[index].min.f = 0;
-    menu_item[index].max.f = 1;
-    menu_item[index].percentage = 50;
-    menu_item[index].percentage_step = 100;
-    menu_item[index].has_corresponding_value = false;
-
-    /* MENU_INDEX_TEMPO_ALPHA */
-    index = MENU_INDEX_TEMPO_ALPHA;
-    strcpy(menu_item[index].top_name_displayed, ALPHA_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, ALPHA_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, ALPHA_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_FLOAT;
-    menu_item[index].min.f = ALPHA_MIN_VALUE;
-    menu_item[index].max.f = ALPHA_MAX_VALUE;
-    menu_item[index].percentage = ALPHA_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = ALPHA_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_SYNC_BETA */
-    index = MENU_INDEX_SYNC_BETA;
-    strcpy(menu_item[index].top_name_displayed, BETA_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, BETA_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, BETA_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT16;
-    menu_item[index].min.f = BETA_MIN_VALUE;
-    menu_item[index].max.f = BETA_MAX_VALUE;
-    menu_item[index].percentage = BETA_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = BETA_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_TEMPO_SPREAD */
-    index = MENU_INDEX_TEMPO_SPREAD;
-    strcpy(menu_item[index].top_name_displayed, SPREAD_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, SPREAD_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, SPREAD_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_FLOAT;
-    menu_item[index].min.f = BETA_MIN_VALUE;
-    menu_item[index].max.f = BETA_MAX_VALUE;
-    menu_item[index].percentage = BETA_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = BETA_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_KICK_THRESHOLD */
-    index = MENU_INDEX_KICK_THRESHOLD;
-    strcpy(menu_item[index].top_name_displayed, KICK_THRESHOLD_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, KICK_THRESHOLD_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, KICK_THRESHOLD_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT16;
-    menu_item[index].min.u16 = KICK_THRESHOLD_MIN_VALUE;
-    menu_item[index].max.u16 = KICK_THRESHOLD_MAX_VALUE;
-    menu_item[index].percentage = KICK_THRESHOLD_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = KICK_THRESHOLD_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_KICK_GATE */
-    index = MENU_INDEX_KICK_GATE;
-    strcpy(menu_item[index].top_name_displayed, KICK_GATE_TIMER_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, KICK_GATE_TIMER_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, KICK_GATE_TIMER_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT64;
-    menu_item[index].min.u64 = KICK_GATE_TIMER_MIN_VALUE;
-    menu_item[index].max.u64 = KICK_GATE_TIMER_MAX_VALUE;
-    menu_item[index].percentage = KICK_GATE_TIMER_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = KICK_GATE_TIMER_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_KICK_FILTER */
-    index = MENU_INDEX_KICK_FILTER;
-    strcpy(menu_item[index].top_name_displayed, KICK_LOW_PASS_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, KICK_LOW_PASS_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, KICK_LOW_PASS_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT16;
-    menu_item[index].min.u16 = KICK_LOW_PASS_MIN_VALUE;
-    menu_item[index].max.u16 = KICK_LOW_PASS_MAX_VALUE;
-    menu_item[index].percentage = KICK_LOW_PASS_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = KICK_LOW_PASS_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_KICK_DELTA_X */
-    index = MENU_INDEX_KICK_DELTA_X;
-    strcpy(menu_item[index].top_name_displayed, KICK_DELTA_X_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, KICK_DELTA_X_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, KICK_DELTA_X_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT16;
-    menu_item[index].min.u16 = KICK_DELTA_X_MIN_VALUE;
-    menu_item[index].max.u16 = KICK_DELTA_X_MAX_VALUE;
-    menu_item[index].percentage = KICK_DELTA_X_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = KICK_DELTA_X_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_SNARE_THRESHOLD */
-    index = MENU_INDEX_SNARE_THRESHOLD;
-    strcpy(menu_item[index].top_name_displayed, SNARE_THRESHOLD_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, SNARE_THRESHOLD_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, SNARE_THRESHOLD_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT16;
-    menu_item[index].min.u16 = SNARE_THRESHOLD_MIN_VALUE;
-    menu_item[index].max.u16 = SNARE_THRESHOLD_MAX_VALUE;
-    menu_item[index].percentage = SNARE_THRESHOLD_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = SNARE_THRESHOLD_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_SNARE_GATE */
-    index = MENU_INDEX_SNARE_GATE;
-    strcpy(menu_item[index].top_name_displayed, SNARE_GATE_TIMER_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, SNARE_GATE_TIMER_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, SNARE_GATE_TIMER_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT64;
-    menu_item[index].min.u64 = SNARE_GATE_TIMER_MIN_VALUE;
-    menu_item[index].max.u64 = SNARE_GATE_TIMER_MAX_VALUE;
-    menu_item[index].percentage = SNARE_GATE_TIMER_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = SNARE_GATE_TIMER_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_SNARE_FILTER */
-    index = MENU_INDEX_SNARE_FILTER;
-    strcpy(menu_item[index].top_name_displayed, SNARE_LOW_PASS_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, SNARE_LOW_PASS_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, SNARE_LOW_PASS_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT16;
-    menu_item[index].min.u16 = SNARE_LOW_PASS_MIN_VALUE;
-    menu_item[index].max.u16 = SNARE_LOW_PASS_MAX_VALUE;
-    menu_item[index].percentage = SNARE_LOW_PASS_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = SNARE_LOW_PASS_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_SNARE_DELTA_X */
-    index = MENU_INDEX_SNARE_DELTA_X;
-    strcpy(menu_item[index].top_name_displayed, SNARE_DELTA_X_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, SNARE_DELTA_X_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, SNARE_DELTA_X_STORAGE_KEY);
-    menu_item[index].pointer_to_vrb = NULL;
-    menu_item[index].vrb_type = BC_UINT16;
-    menu_item[index].min.u16 = SNARE_DELTA_X_MIN_VALUE;
-    menu_item[index].max.u16 = SNARE_DELTA_X_MAX_VALUE;
-    menu_item[index].percentage = SNARE_DELTA_X_DEFAULT_PERCENTAGE;
-    menu_item[index].percentage_step = SNARE_DELTA_X_PERCENTAGE_STEP;
-    menu_item[index].has_corresponding_value = true;
-
-    /* MENU_INDEX_SAVE_VALUES */
-    index = MENU_INDEX_SAVE_VALUES;
-    strcpy(menu_item[index].top_name_displayed, SAVE_VALUES_PARAMETER_NAME_TOP);
-    strcpy(menu_item[index].name_displayed, SAVE_VALUES_PARAMETER_NAME);
-    strcpy(menu_item[index].storage_key, "dummy_saves    ");
-    menu_item[index].pointer_to_vrb = &store_values;
-    menu_item[index].vrb_type = BC_YESNO;
-    menu_item[index].min.b = 0;
-    menu_item[index].max.b = 1;
-    menu_item[index].percentage = 0;
-    menu_item[index].percentage_step = 100;
-    menu_item[index].has_corresponding_value = false;
+    uint8_t percentages[MENU_ITEM_INDEX_LENGTH];
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+    {
+        percentages[i] = menu_value[i].percentage;
+    }
+    presets_save(preset_slot, percentages);
+    setlist_save();
+}
 
+/**
+ * @brief Selects the song of the setlist (0 turns the setlist off): the tempo of the tracking is preloaded
+ * with the nominal one and the preset of the song (if any) is selected
+ */
+static void hid_select_song(uint8_t song)
+{
+    setlist_song current;
+    setlist_select(song);
+    menu_refresh_song();
+    if (!setlist_get_current_song(&current))
+    {
+        return;
+    }
     /*
-    Load saved values from the persistent storage
+    The clock is stopped in SETTINGS and TAP mode: the tracking restarts from the nominal tempo
+    (the tap tempo only has to find the phase)
     */
-    bc_menu_nvs_load();
+    bc_write_begin();
+    bc.tau = 30000000 / current.bpm; // 8th note
+    bc_write_end();
+    if (current.preset > 0)
+    {
+        preset_slot = current.preset - 1;
+        menu_value[MENU_INDEX_PRESET].percentage = preset_percentage(preset_slot);
+        hid_select_preset(preset_slot);
+    }
+    else
+    {
+        tracking_start_spread = 0;
+        xTaskNotify(tracking_task_handle, TRACKING_RESET_PARAMETERS, eSetValueWithOverwrite);
+    }
 }
 
 /**
- * @brief Saves all the current values of the menu variables into the permanent storage
+ * @brief Moves the song of the setlist by the detents of the encoder and restarts the count of the hits
  */
-static void bc_menu_nvs_write()
+static void hid_step_song(int32_t detents)
 {
-    /*
-    Check NVS status
-    */
-    esp_err_t err = nvs_flash_init();
-    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    int32_t song = MIN(MAX((int32_t)setlist_get_current() + detents, 0), SETLIST_MAX_SONGS);
+    if (song == setlist_get_current())
     {
-        /*
-        NVS partition was truncated and needs to be erased
-        Retry nvs_flash_init
-        */
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        err = nvs_flash_init();
+        return;
     }
-    ESP_ERROR_CHECK(err);
-    err = nvs_open("storage", NVS_READWRITE, &bc_nvs_handle);
-    if (err != ESP_OK)
+    hid_select_song(song);
+    uint64_t tap_task_msg = TAP_TASK_QUEUE_RESET_COUNTER;
+    xQueueSend(tap_task_queue, &tap_task_msg, (TickType_t)0);
+}
+
+/**
+ * @brief Applies the change of an entry that is not just a variable (preset and setlist)
+ */
+static void hid_entry_changed(menu_item_index index)
+{
+    switch (index)
     {
-        ESP_LOGI("hidnvs", "Error (%s) opening NVS handle!\n", esp_err_to_name(err));
+    case MENU_INDEX_PRESET:
+        hid_select_preset(preset_slot);
+        break;
+    case MENU_INDEX_SETLIST_SONG:
+        hid_select_song(setlist_song_selected);
+        break;
+    case MENU_INDEX_SETLIST_BPM:
+    case MENU_INDEX_SETLIST_METER:
+    case MENU_INDEX_SETLIST_PRESET:
+        setlist_update();
+        break;
+    default:
+        break;
     }
-    else
+}
+
+/**
+ * @brief Writes the text of the second line of the entry (the value for the entries that are not a bar)
+ */
+static const char *menu_entry_text(menu_item_index index, char *text, size_t size)
+{
+    switch (index)
     {
-        /*
-        If NVS partition is OK save values to it
-        */
-        for (int i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+    case MENU_INDEX_PRESET:
+        snprintf(text, size, "Slot %u %-8s", preset_slot + 1, presets_is_stored(preset_slot) ? "" : "(empty)");
+        return text;
+    case MENU_INDEX_SETLIST_SONG:
+        if (setlist_song_selected == 0)
         {
-            if (menu_item[i].has_corresponding_value)
-            { // avoid dummy items (save values and gain)
-                uint8_t perc = menu_item[i].percentage;
-                ESP_LOGI("hid", "------");
-                ESP_LOGI("hid", "Now working on %s", menu_item[i].storage_key);
-                ESP_LOGI("hid", "Current value is: %d", perc);
-                err = nvs_set_u8(bc_nvs_handle, menu_item[i].storage_key, menu_item[i].percentage);
-                ESP_LOGI("hid", "%s", (err != ESP_OK) ? "Failed!\n" : "Done\n");
-                ESP_LOGI("hid", "Committing updates in NVS ... ");
-                err = nvs_commit(bc_nvs_handle);
-                ESP_LOGI("hid", "%s", (err != ESP_OK) ? "Failed!\n" : "Done\n");
-            }
+            return "Song: off      ";
+        }
+        snprintf(text, size, "Song: %-9u", setlist_song_selected);
+        return text;
+    case MENU_INDEX_SETLIST_BPM:
+        snprintf(text, size, "Tempo: %3u bpm ", setlist_edit.bpm);
+        return text;
+    case MENU_INDEX_SETLIST_METER:
+        snprintf(text, size, "Meter: %u beats ", setlist_edit.meter);
+        return text;
+    case MENU_INDEX_SETLIST_PRESET:
+        if (setlist_edit.preset == 0)
+        {
+            return "Preset: keep   ";
         }
-        nvs_close(bc_nvs_handle);
+        snprintf(text, size, "Preset: slot %-2u", setlist_edit.preset);
+        return text;
+    case MENU_INDEX_SETLIST_RANGE:
+        snprintf(text, size, "Range: +-%2u%%    ", setlist_range);
+        return text;
+    default:
+        return menu_item[index].name_displayed;
     }
 }
 
@@ -473,12 +385,91 @@ static void encoder_has_clicked(void *args)
 
 /**
  * @brief Callback function for the encoder rotation
- * This function sends message to the hid_task queue about the encoder moving. It tells the moving steps (+4/-4).
+ * This function adds the detent (+4/-4 steps of the pulse counter) to the ones not applied yet.
+ * Only the first detent of a burst sends ENCODER_MOVED to the hid_task queue: the task reads all the
+ * detents at once, so a fast turn cannot fill the queue.
  */
 static bool encoder_has_moved(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t *edata, void *user_ctx)
 {
-    xQueueSendFromISR(hid_task_queue, &(edata->watch_point_value), NULL);
-    return (pdFALSE);
+    int32_t detent = (edata->watch_point_value > 0) ? 1 : -1;
+    if (__atomic_fetch_add(&encoder_detents, detent, __ATOMIC_RELAXED) != 0)
+    {
+        return (pdFALSE);
+    }
+    int msg_to_hid = ENCODER_MOVED;
+    BaseType_t task_woken = pdFALSE;
+    xQueueSendFromISR((QueueHandle_t)user_ctx, &msg_to_hid, &task_woken);
+    return (task_woken == pdTRUE);
+}
+
+/**
+ * @brief Returns the steps of the detents moved since the last frame, accelerated by the speed of the encoder:
+ * every ENCODER_ACCELERATION_RATE detents/s add a step per detent, up to ENCODER_ACCELERATION_MAX
+ */
+static int32_t encoder_accelerate(int32_t detents, uint64_t now)
+{
+    static uint64_t last_move = 0;
+    uint64_t elapsed = MAX(now - last_move, HID_REDRAW_MIN_INTERVAL_US);
+    last_move = now;
+    uint32_t rate = ((uint64_t)abs(detents) * 1000000) / elapsed;
+    int32_t acceleration = MIN(MAX(rate / ENCODER_ACCELERATION_RATE, 1), ENCODER_ACCELERATION_MAX);
+    return detents * acceleration;
+}
+
+/**
+ * @brief Applies the detents of the encoder moved since the last frame (one update per frame):
+ * - SETTINGS mode: the value of the entry moves by a step per detent (accelerated for the entries with
+ *   fine steps, the ones with few choices move by one choice per detent)
+ * - TAP mode: the song of the setlist moves by a song per detent
+ * - PLAY mode: switch between the bpm and the tracking page
+ * Returns true if the count of the tap hits starts again.
+ */
+static bool hid_apply_encoder(uint8_t menu_index, uint64_t now)
+{
+    int32_t detents = __atomic_exchange_n(&encoder_detents, 0, __ATOMIC_RELAXED);
+    if (detents == 0)
+    {
+        return false;
+    }
+    switch (mode)
+    {
+    case MODE_SETTINGS:
+        if (menu_item[menu_index].percentage_step <= ENCODER_ACCELERATION_MAX_STEP)
+        {
+            detents = encoder_accelerate(detents, now);
+        }
+        int32_t percentage = get_variable_perc_value(menu_index) + (detents * menu_item[menu_index].percentage_step);
+        set_variable_value(menu_index, MIN(MAX(percentage, 0), 100));
+        hid_entry_changed(menu_index);
+        return false;
+    case MODE_TAP:
+        /*
+        Select the song of the setlist (the hits start again)
+        */
+        hid_step_song(detents);
+        return true;
+    case MODE_PLAY:
+        /*
+        Switch between the bpm and the tracking page (the telemetry page is hidden behind the bpm page:
+        turning back from the bpm page shows it, any turn goes back to the bpm)
+        */
+        if (telemetry_is_page_enabled())
+        {
+            telemetry_enable_page(false);
+        }
+        else if (detents < 0 && !visualizer_is_enabled())
+        {
+            telemetry_enable_page(true);
+        }
+        else
+        {
+            visualizer_enable(!visualizer_is_enabled());
+        }
+        ssd1306_clear_screen(&oled_screen, false);
+        return false;
+    default:
+        return false;
+    }
 }
 
 /**
@@ -565,7 +556,7 @@ static void encoder_and_queue_init()
  * @brief Displays just text (4 lines) 
  * This function displays the 4 lines on the screen
  */
-static void display_just_text(SSD1306_t *dev, char *text1, char *text2, char *text3, char *text4)
+static void display_just_text(SSD1306_t *dev, const char *text1, const char *text2, const char *text3, const char *text4)
 {
     /*
     Check if text value is of the right length
@@ -592,7 +583,7 @@ static void display_just_text(SSD1306_t *dev, char *text1, char *text2, char *te
  * @brief Displays the parameter on the OLED
  * This function displays the text for the parameter and creates a horizontal bar for displaying the percentage
  */
-static void display_parameter_value(SSD1306_t *dev, char *text1, char *text2, uint8_t percentage, bool is_yesno)
+static void display_parameter_value(SSD1306_t *dev, const char *text1, const char *text2, uint8_t percentage, bool is_yesno)
 {
     /*
     Check if percentage value is ok
@@ -672,89 +663,7 @@ static void display_parameter_value(SSD1306_t *dev, char *text1, char *text2, ui
  */
 static void display_big_text(SSD1306_t *dev, char *text)
 {
-    /*
-    Create image to be printed on the display
-    */
-    uint8_t image[128];
-    /*
-    Create image to be printed on the display
-    */
-    uint8_t text_length = strlen(text);
-    uint8_t char_value[text_length];
-    for (int i = 0; i < text_length; i++)
-    {
-        uint8_t char_val = (uint8_t)text[i];
-        if (char_val >= 47 && char_val <= 57)
-        { // if it is a digit
-            char_value[i] = (uint8_t)text[i] - 48;
-        }
-        else if (char_val >= 65 && char_val <= 90)
-        { // if it is a letter
-            char_value[i] = (uint8_t)text[i] - 54;
-        }
-        else
-        {                       // if it is something else
-            char_value[i] = 10; // set it is as a whitespace
-        }
-    }
-    /*
-    Print centered text (based on text length)
-    */
-    switch (text_length)
-    {
-    case 1:
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[52], BIG_CHARS[char_value[0]][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
-        break;
-    case 2:
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[40], BIG_CHARS[char_value[0]][i], 24);
-            memcpy(&image[64], BIG_CHARS[char_value[1]][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
-        break;
-    case 3:
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[28], BIG_CHARS[char_value[0]][i], 24);
-            memcpy(&image[52], BIG_CHARS[char_value[1]][i], 24);
-            memcpy(&image[76], BIG_CHARS[char_value[2]][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
-        break;
-    case 4:
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[18], BIG_CHARS[char_value[0]][i], 24);
-            memcpy(&image[40], BIG_CHARS[char_value[1]][i], 24);
-            memcpy(&image[64], BIG_CHARS[char_value[2]][i], 24);
-            memcpy(&image[88], BIG_CHARS[char_value[3]][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
-        break;
-    case 5:
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[4], BIG_CHARS[char_value[0]][i], 24);
-            memcpy(&image[28], BIG_CHARS[char_value[1]][i], 24);
-            memcpy(&image[52], BIG_CHARS[char_value[2]][i], 24);
-            memcpy(&image[76], BIG_CHARS[char_value[3]][i], 24);
-            memcpy(&image[100], BIG_CHARS[char_value[4]][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
-        break;
-    default:
-        break;
-    }
+    big_font_draw(dev, text);
 }
 
 /**
@@ -763,74 +672,64 @@ static void display_big_text(SSD1306_t *dev, char *text)
  */
 static void display_big_numbers(SSD1306_t *dev, uint32_t value)
 {
-    /*
-    Create image to be printed on the display
-    */
-    uint8_t image[128];
-    /*
-    Decompose the value into corresponding digits
-    and print the number centered based on its length
-    */
-    if (value < 10)
-    { // 1 digit
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[52], BIG_CHARS[value][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
+    if (value >= 100000)
+    {
+        ESP_LOGE("OLED", "ERROR asked to print a bpm of %ld", value);
+        return;
     }
-    else if (value < 100)
-    { // 2 digits
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[40], BIG_CHARS[(value / 10) % 10][i], 24);
-            memcpy(&image[64], BIG_CHARS[value % 10][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
+    char text[BIG_FONT_MAX_LENGTH + 1];
+    snprintf(text, sizeof(text), "%lu", value);
+    big_font_draw(dev, text);
+}
+
+/**
+ * @brief Displays the tempo of the external clock and the offset of the drummer (slave mode)
+ * offset is in us (positive: the drummer is behind the clock)
+ */
+static void display_drummer_offset(SSD1306_t *dev, uint16_t bpm, int32_t offset)
+{
+    char lines[4][17];
+    int32_t offset_ms = (offset + (offset >= 0 ? 500 : -500)) / 1000;
+    snprintf(lines[0], sizeof(lines[0]), "SLAVE   %3u BPM ", bpm);
+    snprintf(lines[1], sizeof(lines[1]), "%-16s", "DRUMMER");
+    if (offset_ms > 0)
+    {
+        snprintf(lines[2], sizeof(lines[2]), "BEHIND  %4ld ms ", offset_ms);
     }
-    else if (value < 1000)
-    { // 3 digits
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[28], BIG_CHARS[(value / 100) % 10][i], 24);
-            memcpy(&image[52], BIG_CHARS[(value / 10) % 10][i], 24);
-            memcpy(&image[76], BIG_CHARS[value % 10][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
+    else if (offset_ms < 0)
+    {
+        snprintf(lines[2], sizeof(lines[2]), "AHEAD   %4ld ms ", -offset_ms);
     }
-    else if (value < 10000)
-    { // 4 digits
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[18], BIG_CHARS[(value / 1000) % 10][i], 24);
-            memcpy(&image[40], BIG_CHARS[(value / 100) % 10][i], 24);
-            memcpy(&image[64], BIG_CHARS[(value / 10) % 10][i], 24);
-            memcpy(&image[88], BIG_CHARS[value % 10][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
+    else
+    {
+        snprintf(lines[2], sizeof(lines[2]), "%-16s", "ON TIME");
     }
-    else if (value < 100000)
-    { // 5 digits
-        for (int i = 0; i < 4; i++)
-        {
-            memset(image, 0x00, 128);
-            memcpy(&image[4], BIG_CHARS[(value / 10000) % 10][i], 24);
-            memcpy(&image[28], BIG_CHARS[(value / 1000) % 10][i], 24);
-            memcpy(&image[52], BIG_CHARS[(value / 100) % 10][i], 24);
-            memcpy(&image[76], BIG_CHARS[(value / 10) % 10][i], 24);
-            memcpy(&image[100], BIG_CHARS[value % 10][i], 24);
-            ssd1306_display_image(dev, i, 0, image, 127);
-        }
+    snprintf(lines[3], sizeof(lines[3]), "%-16s", "");
+    display_just_text(dev, lines[0], lines[1], lines[2], lines[3]);
+}
+
+/**
+ * @brief Displays the last telemetry report: stack and load of a task (a different one at every
+ * report), highest levels of the queues (clock, onset, hid, tap) and accesses to bc
+ */
+static void display_telemetry(SSD1306_t *dev, telemetry_task_index task)
+{
+    telemetry_report report;
+    telemetry_get_report(&report);
+    char lines[4][20];
+    snprintf(lines[0], sizeof(lines[0]), "%-8s %5uB ", telemetry_task_name(task), report.stack_free[task]);
+    if (report.load[task] == TELEMETRY_LOAD_UNKNOWN)
+    {
+        snprintf(lines[1], sizeof(lines[1]), "CPU  --    %u/%u ", task + 1, TELEMETRY_TASKS_LENGTH);
     }
     else
     {
-        ESP_LOGE("OLED", "ERROR asked to print a bpm of %ld", value);
-        return;
+        snprintf(lines[1], sizeof(lines[1]), "CPU %3u%%   %u/%u ", report.load[task], task + 1, TELEMETRY_TASKS_LENGTH);
     }
+    snprintf(lines[2], sizeof(lines[2]), "Q %3u%3u%3u%3u  ", report.queue_max[TELEMETRY_QUEUE_CLOCK], report.queue_max[TELEMETRY_QUEUE_ONSET_ADC],
+             report.queue_max[TELEMETRY_QUEUE_HID], report.queue_max[TELEMETRY_QUEUE_TAP]);
+    snprintf(lines[3], sizeof(lines[3]), "bc%5uns%5u/s", report.bc_max_write_ns, report.bc_writes);
+    display_just_text(dev, lines[0], lines[1], lines[2], lines[3]);
 }
 
 /**
@@ -847,7 +746,12 @@ static void oled_init()
     */
     ssd1306_init(&oled_screen, 128, 32);
     ssd1306_clear_screen(&oled_screen, false);
+    ssd1306_flush(&oled_screen);
     ssd1306_contrast(&oled_screen, 0xff);
+    /*
+    From now on the frames are sent by the display task
+    */
+    display_init(&oled_screen);
 }
 
 /**
@@ -857,54 +761,42 @@ static void hid_task(void *arg)
 {
     static uint8_t menu_index = 0;
     uint8_t tap_hits_counter = 0;
+    uint8_t percentage_value = 0;
+    bool has_changed = true; // draw the first screen
+    bool flush_pending = false;
+    uint64_t last_redraw = 0;
+    uint64_t report_start = esp_timer_get_time();
+    uint32_t wakeups = 0;
+    uint32_t redraws = 0;
+    bool encoder_moved = false;
+    telemetry_task_index telemetry_shown_task = 0;
     while (1)
     {
-        uint8_t percentage_value = 0;
-        bool has_changed = false;
         int event_code;
         /*
-        Checks for messages in the queue
+        Sleep until a message arrives, or until a pending redraw (or flush, or encoder update) is allowed
         */
-        while (xQueueReceive(hid_task_queue, &event_code, 1))
+        TickType_t wait = portMAX_DELAY;
+        if (has_changed || flush_pending || encoder_moved)
+        {
+            int64_t until_redraw = (int64_t)(last_redraw + HID_REDRAW_MIN_INTERVAL_US) - (int64_t)esp_timer_get_time();
+            wait = (flush_pending || until_redraw <= 0) ? 1 : pdMS_TO_TICKS(until_redraw / 1000) + 1;
+        }
+        bool has_message = xQueueReceive(hid_task_queue, &event_code, wait);
+        wakeups++;
+        while (has_message)
         {
             /*
             If there are messages...
             */
-            percentage_value = get_variable_perc_value(&menu_item[menu_index]);
+            percentage_value = get_variable_perc_value(menu_index);
             switch (event_code)
             {
-            case ENCODER_INCREASE:
+            case ENCODER_MOVED:
                 /*
-                The encoder increases:
-                Increase the value of the selected parameter (only if in SETTINGS mode)
+                The encoder has moved: the detents are applied once per frame
                 */
-                if (mode == MODE_SETTINGS)
-                {
-                    percentage_value = percentage_value + menu_item[menu_index].percentage_step;
-                    if (percentage_value > 100)
-                    {
-                        percentage_value = 100;
-                    }
-                    set_variable_value(&menu_item[menu_index], percentage_value);
-                }
-                break;
-            case ENCODER_DECREASE:
-                /*
-                The encoder decreases:
-                Decrease the value of the selected parameter (only if in SETTINGS mode)
-                */
-                if (mode == MODE_SETTINGS)
-                {
-                    if (percentage_value > menu_item[menu_index].percentage_step)
-                    {
-                        percentage_value = percentage_value - menu_item[menu_index].percentage_step;
-                    }
-                    else
-                    {
-                        percentage_value = 0;
-                    }
-                    set_variable_value(&menu_item[menu_index], percentage_value);
-                }
+                encoder_moved = true;
                 break;
             case ENCODER_CLICK:
                 /*
@@ -913,6 +805,11 @@ static void hid_task(void *arg)
                 */
                 if (mode == MODE_SETTINGS)
                 {
+                    /*
+                    The detents not applied yet belong to the entry selected before the click
+                    */
+                    hid_apply_encoder(menu_index, esp_timer_get_time());
+                    encoder_moved = false;
                     /*
                     First menu item is gain setting -> ask onset to display gain
                     */
@@ -934,15 +831,15 @@ static void hid_task(void *arg)
                     */
                     if (menu_index == MENU_ITEM_INDEX_LENGTH - 1 && store_values)
                     {
-                        menu_item[MENU_INDEX_SAVE_VALUES].percentage = 0;
+                        menu_value[MENU_INDEX_SAVE_VALUES].percentage = 0;
                         store_values = 0;
-                        bc_menu_nvs_write();
+                        hid_save_preset();
                     }
                     /*
                     Increase menu index
                     */
                     menu_index = (menu_index + 1) % (sizeof(menu_item) / sizeof(hid_parameter_entry));
-                    percentage_value = get_variable_perc_value(&menu_item[menu_index]);
+                    percentage_value = get_variable_perc_value(menu_index);
                 }
                 break;
             case HID_SETTINGS_MODE_SELECT:
@@ -959,7 +856,7 @@ Switch to Settings mode:
                 */
                 int onset_adc_queue_value = ONSET_ADC_START_DISPLAY_GAIN;
                 xQueueSend(onset_adc_task_queue, &onset_adc_queue_value, NULL);
-                // percentage_value = get_variable_perc_value(&menu_item[menu_index]);
+                // percentage_value = get_variable_perc_value(menu_index);
                 break;
             case HID_TAP_MODE_SELECT:
                 /*
@@ -973,8 +870,23 @@ Switch to Settings mode:
                 break;
             case HID_PLAY_MODE_SELECT:
                 /*
-                Switch to bpm mode
+                Switch to bpm mode (or to the tracking page if it was shown: it is drawn again from scratch)
                 */
+                ssd1306_clear_screen(&oled_screen, false);
+                visualizer_enable(visualizer_is_enabled());
+                break;
+            case HID_TEMPO_CHANGED:
+            case HID_DRUMMER_OFFSET_CHANGED:
+            case HID_TRACKING_UPDATED:
+                /*
+                The bpm (or the offset of the drummer, or the tracking page) is redrawn
+                */
+                break;
+            case HID_TELEMETRY_UPDATED:
+                /*
+                The telemetry page shows the next task
+                */
+                telemetry_shown_task = (telemetry_shown_task + 1) % TELEMETRY_TASKS_LENGTH;
                 break;
             case HID_ENTER_SLEEP_MODE:
                 /*
@@ -1001,24 +913,65 @@ Switch to Settings mode:
             case HID_TAP_4:
                 tap_hits_counter = 4;
                 break;
+            case HID_TAP_5:
+                tap_hits_counter = 5;
+                break;
+            case HID_TAP_6:
+                tap_hits_counter = 6;
+                break;
+            case HID_TAP_7:
+                tap_hits_counter = 7;
+                break;
+            case HID_TAP_8:
+                tap_hits_counter = 8;
+                break;
             default:
                 ESP_LOGE("hid_task", "ERROR: event code invalid");
                 break;
             }
             /*
-            Set has_changed to true to avoid printing the same thing every time the task repeats itself
+            Set has_changed to true to redraw the display (only once for all the messages received)
             */
             has_changed = true;
+            has_message = xQueueReceive(hid_task_queue, &event_code, 0);
         }
-        switch (mode)
+        uint64_t now = esp_timer_get_time();
+        /*
+        Apply the detents of the encoder before the redraw (also the ones whose message did not fit in the queue)
+        */
+        encoder_moved = encoder_moved || __atomic_load_n(&encoder_detents, __ATOMIC_RELAXED) != 0;
+        if (encoder_moved && now >= last_redraw + HID_REDRAW_MIN_INTERVAL_US)
         {
-        case MODE_TAP:
-            /*
-            Displays the current tap hit received
-            */
-            if (has_changed)
+            encoder_moved = false;
+            if (hid_apply_encoder(menu_index, now))
             {
-                if (tap_hits_counter == 0)
+                tap_hits_counter = 0;
+            }
+            percentage_value = get_variable_perc_value(menu_index);
+            has_changed = true;
+        }
+        if (has_changed && now >= last_redraw + HID_REDRAW_MIN_INTERVAL_US)
+        {
+            last_redraw = now;
+            has_changed = false;
+            redraws++;
+            switch (mode)
+            {
+            case MODE_TAP:
+            {
+                /*
+                Displays the current tap hit received
+                */
+                setlist_song song;
+                if (tap_hits_counter == 0 && setlist_get_current_song(&song))
+                { // show the song selected
+                    char song_lines[3][20];
+                    snprintf(song_lines[0], sizeof(song_lines[0]), "SONG %u of %-6u", setlist_get_current(), SETLIST_MAX_SONGS);
+                    snprintf(song_lines[1], sizeof(song_lines[1]), "%3u bpm %u beats ", song.bpm, song.meter);
+                    snprintf(song_lines[2], sizeof(song_lines[2]), "Preset: slot %-3u", song.preset);
+                    display_just_text(&oled_screen, song_lines[0], song_lines[1], song.preset > 0 ? song_lines[2] : "Preset: keep    ", "TAP the beat    ");
+                }
+                else if (tap_hits_counter == 0)
                 {
                     display_big_text(&oled_screen, "TAP");
                 }
@@ -1026,19 +979,41 @@ Switch to Settings mode:
                 {
                     display_big_numbers(&oled_screen, tap_hits_counter);
                 }
-                has_changed = false;
+                break;
             }
-            break;
-        case MODE_PLAY:
-            /*
-            Calculates and display bpm
-            */
-            uint8_t bpm = (30000000 + (bc.tau / 2)) / bc.tau;
-            display_big_numbers(&oled_screen, bpm);
-            break;
-        case MODE_SETTINGS:
-            if (has_changed)
-            {
+            case MODE_PLAY:
+                if (telemetry_is_page_enabled())
+                {
+                    display_telemetry(&oled_screen, telemetry_shown_task);
+                    break;
+                }
+                if (visualizer_is_enabled())
+                {
+                    /*
+                    Tracking page: draw the slots changed since the last redraw
+                    */
+                    main_runtime_vrbs now_playing;
+                    bc_read(&now_playing);
+                    visualizer_draw(&oled_screen, clock_in_following ? clock_in_get_bpm() : (30000000 + (now_playing.tau / 2)) / now_playing.tau);
+                    break;
+                }
+                if (clock_in_following)
+                {
+                    /*
+                    Slave mode: display the external tempo and if the drummer is ahead or behind
+                    */
+                    display_drummer_offset(&oled_screen, clock_in_get_bpm(), clock_in_get_drummer_offset());
+                    break;
+                }
+                /*
+                Calculates and display bpm
+                */
+                main_runtime_vrbs current;
+                bc_read(&current);
+                uint16_t bpm = (30000000 + (current.tau / 2)) / current.tau;
+                display_big_numbers(&oled_screen, bpm);
+                break;
+            case MODE_SETTINGS:
                 /*
                 Display the current selected parameter name and value (with bar and numbers)
                 */
@@ -1047,26 +1022,49 @@ Switch to Settings mode:
                     display_just_text(&oled_screen, menu_item[menu_index].top_name_displayed, menu_item[menu_index].name_displayed, CHECK_GAIN_TEXT_1, CHECK_GAIN_TEXT_2);
                 }
                 else
-                {
-                    display_parameter_value(&oled_screen, menu_item[menu_index].top_name_displayed, menu_item[menu_index].name_displayed, percentage_value, menu_item[menu_index].vrb_type == BC_YESNO);
+                { // the preset and the setlist entries show their value
+                    char entry_text[20];
+                    display_parameter_value(&oled_screen, menu_item[menu_index].top_name_displayed, menu_entry_text(menu_index, entry_text, sizeof(entry_text)), percentage_value, menu_item[menu_index].vrb_type == BC_YESNO);
                 }
-                has_changed = false;
-            }
-            break;
-        case MODE_SLEEP:
+                break;
+            case MODE_SLEEP:
 #ifndef TURN_OFF_SCREEN
-            if (has_changed)
-            {
                 display_big_text(&oled_screen, "TAP");
-                has_changed = false;
-            }
 #endif
-            break;
-        default:
-            ESP_LOGE("hid_task", "ERROR: current_mode invalid");
-            break;
+                break;
+            default:
+                ESP_LOGE("hid_task", "ERROR: current_mode invalid");
+                break;
+            }
+        }
+        /*
+        The display functions draw into the buffer of the driver: hand what has changed to the display task
+        (if it is still busy with the previous frame, try again at the next tick)
+        */
+        flush_pending = !display_flush(&oled_screen);
+        /*
+        Measure wakeups and redraws per second
+        */
+        if (now - report_start >= 1000000)
+        {
+            hid_wakeups_per_second = ((uint64_t)wakeups * 1000000) / (now - report_start);
+            hid_redraws_per_second = ((uint64_t)redraws * 1000000) / (now - report_start);
+            ESP_LOGD("hid_task", "%lu wakeups/s, %lu redraws/s", hid_wakeups_per_second, hid_redraws_per_second);
+            report_start = now;
+            wakeups = 0;
+            redraws = 0;
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+void hid_publish_bpm(uint16_t bpm)
+{
+    static uint16_t published_bpm = 0;
+    if (bpm != published_bpm)
+    {
+        published_bpm = bpm;
+        int msg_to_hid = HID_TEMPO_CHANGED;
+        xQueueSend(hid_task_queue, &msg_to_hid, (TickType_t)0);
     }
 }
 
@@ -1075,10 +1073,12 @@ This function assign the percentage value (loaded from the NVS) to the variable
 */
 void hid_set_up_values()
 {
-    for (int i = 0; i < MENU_ITEM_INDEX_LENGTH - 1; i++)
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
     {
-        set_variable_value(&menu_item[i], menu_item[i].percentage);
-        ESP_LOGI("Hid_Task", "Variable %s loaded from storage", menu_item[i].name_displayed);
+        if (menu_item[i].has_corresponding_value)
+        {
+            set_variable_value(i, menu_value[i].percentage);
+        }
     }
 }
 
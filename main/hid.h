@@ -9,18 +9,20 @@
  *  - When the encoder rotates the value is increased/decreased.
  *  - When the encoder is clicked, the next parameter is selected.
  *  - The last parameter allow to permanently save values
- * - PLAY mode: shows the current bpm value
- * - TAP mode: shows the number of the hits received (0 to 4)
+ * - PLAY mode: shows the current bpm value (turn the encoder to switch to the tracking page, see visualizer.h)
+ * - TAP mode: shows the number of the hits received (0 to TAP Taps)
  * - SLEEP mode: the display is turned off
  * 
+ * The hid task is event-driven: it sleeps on its queue until a message arrives (encoder, mode change,
+ * tempo change published by the other modules) and redraws the display only when something has changed,
+ * at most once every HID_REDRAW_MIN_INTERVAL_US.
+ * 
  * To be editable by the user, every parameter must have an entry on the menu.
  * To add a menu entry:
- * - Add a value on the menu_item_index enum (file: hid.h) to select the order for the parameter name in the menu
- * - Add the parameter values definitions (file: menu_parameters.h).
- * - Add in the menu_init function (file: hid.c) the instructions to fill all the
- * struct fields. Remember to set the pointer to the variable to NULL. 
- * - After that, place a call to the set_menu_item_pointer_to_vrb function inside the module which contains the variable
- * to register the pointer to the struct.
+ * - Add a line to the BC_MENU_ENTRIES list (file: menu_parameters.h), in the position of the entry
+ *   in the menu: the enum, the table of the entries and their compile-time checks are generated from it.
+ * - Place a call to the set_menu_item_pointer_to_vrb function inside the module which contains the variable
+ * to register the pointer to the variable.
  */
 
 #ifndef BC_HID_H
@@ -70,24 +72,51 @@
  * @}
  */
 
+/**
+ * @{ \name Acceleration of the encoder
+ * Every ENCODER_ACCELERATION_RATE detents/s add a step per detent (up to ENCODER_ACCELERATION_MAX steps),
+ * only for the entries whose percentage step is at most ENCODER_ACCELERATION_MAX_STEP (the ones with
+ * about 20 choices or less, e.g. the NOTE OUT channel, move by one choice per detent)
+ */
+#define ENCODER_ACCELERATION_RATE 6
+#define ENCODER_ACCELERATION_MAX 8
+#define ENCODER_ACCELERATION_MAX_STEP 5
+/**
+ * @}
+ */
+
+/**
+ * @brief Min time between two redraws of the display (us): the changes in between are drawn together
+ */
+#define HID_REDRAW_MIN_INTERVAL_US 100000
+
 /**
  * @brief Type of message sent to the queue.
  * Every message that the queue receives has to be one of the types specified here
  */
 typedef enum
 {
-    ENCODER_INCREASE = 4, /**< Actual value from the pulse counter (1 click = 4 steps) */
-    ENCODER_DECREASE = -4, /**< Actual value from the pulse counter (-1 click = -4 steps) */
+    ENCODER_INCREASE = 4, /**< Limit of the pulse counter (1 detent = 4 steps), not sent to the queue */
+    ENCODER_DECREASE = -4, /**< Limit of the pulse counter (-1 detent = -4 steps), not sent to the queue */
     ENCODER_CLICK = 1, /**< Asks the hid to change the currently selected menu item */
+    ENCODER_MOVED = 2, /**< The encoder has moved (the detents are counted apart and applied once per frame) */
     HID_PLAY_MODE_SELECT = 12, /**< Asks the hid to shift to bpm mode (shows current bpm) */
     HID_SETTINGS_MODE_SELECT = 13, /**< Asks the hid to shift to settings mode (allows menu diving) */
-    HID_TAP_MODE_SELECT = 14, /**< Asks the hid to shift to tap mode (shows 0->1->2->3->4 for every hit) */
+    HID_TAP_MODE_SELECT = 14, /**< Asks the hid to shift to tap mode (shows 0->1->2->... for every hit) */
     HID_ENTER_SLEEP_MODE = 15, /**< Asks the hid to turn off screen */
     HID_TAP_0, /**< Asks the hid in tap mode to show 0 */
     HID_TAP_1, /**< Asks the hid in tap mode to show 1 */
     HID_TAP_2, /**< Asks the hid in tap mode to show 2 */
     HID_TAP_3, /**< Asks the hid in tap mode to show 3 */
     HID_TAP_4, /**< Asks the hid in tap mode to show 4 */
+    HID_TAP_5, /**< Asks the hid in tap mode to show 5 */
+    HID_TAP_6, /**< Asks the hid in tap mode to show 6 */
+    HID_TAP_7, /**< Asks the hid in tap mode to show 7 */
+    HID_TAP_8, /**< Asks the hid in tap mode to show 8 */
+    HID_TEMPO_CHANGED, /**< The bpm to display has changed (see hid_publish_bpm) */
+    HID_DRUMMER_OFFSET_CHANGED, /**< The offset of the drummer against the external clock has changed */
+    HID_TRACKING_UPDATED, /**< A new evaluation of the tracking is ready for the tracking page (see visualizer.h) */
+    HID_TELEMETRY_UPDATED, /**< A new report is ready for the telemetry page (see telemetry.h) */
 } hid_queue_msg;
 
 /**
@@ -97,63 +126,55 @@ typedef enum
  */
 typedef enum
 {
-    BC_FLOAT, /**< float */
+    BC_NONE, /**< No variable (the entry only shows a text) */
+    BC_DOUBLE, /**< double (range in hundredths, see MENU_DOUBLE_SCALE) */
     BC_UINT16, /**< uint16_t */
     BC_UINT64, /**< uint64_t */
     BC_YESNO, /**< bool */
 } bc_variable_type;
 
 /**
- * @brief Container for the min/max values of the variable in the menu entry.
- * This union is used to contain values from differen variables type by using a single pointer
- * (the casting of the pointer is then made using the vrb type specified in the bc_variable_type enum)
+ * @brief Scale of the range of the BC_DOUBLE entries (min and max are in hundredths)
  */
-typedef union
-{
-    uint16_t u16;
-    uint64_t u64;
-    float f;
-    bool b;
-} range_values;
+#define MENU_DOUBLE_SCALE 100
 
 /**
- * @brief Entry of the settings menu.
+ * @brief Entry of the settings menu (constant, generated from BC_MENU_ENTRIES).
  * Every variable whose value can be modified by the user has an entry
- * modeled by this struct
+ * modeled by this struct. The value is a percentage of the range: the variable gets
+ * min + (max - min) * percentage / 100, rounded to the nearest integer.
  */
 typedef struct
 {
-    char top_name_displayed[16]; /**< Name of the parameter to be displayed on top*/
-    char name_displayed[16]; /**< Name of the parameter to be displayed */
-    char storage_key[16]; /**< Name of the parameter to be displayed */
-    void *pointer_to_vrb; /**< Pointer to the variable */
+    const char *top_name_displayed; /**< Name of the parameter to be displayed on top*/
+    const char *name_displayed; /**< Name of the parameter to be displayed */
+    const char *storage_key; /**< Key of the percentage in the NVS partition */
     bc_variable_type vrb_type; /**< Type of variable choosen from the bc_variable_type enum */
-    range_values min; /**< Minimum value the variable can assume */
-    range_values max; /**< Maximum value the variable can assume */
-    uint8_t percentage; /**< Current value of the variable in percentage (min to max) */
+    int32_t min; /**< Minimum value the variable can assume */
+    int32_t max; /**< Maximum value the variable can assume */
+    uint8_t default_percentage; /**< Value of the variable in percentage until a value is stored */
     uint8_t percentage_step; /**< Increase/decrease percentage value with every step for the encoder */
     bool has_corresponding_value; /**< If set to false, the parameter is just a dummy value for something else ("Save values","Gain") */
 } hid_parameter_entry;
 
+/**
+ * @brief Current value of a menu entry
+ */
+typedef struct
+{
+    void *pointer_to_vrb; /**< Pointer to the variable (registered by the module that owns it) */
+    uint8_t percentage; /**< Current value of the variable in percentage (min to max) */
+} hid_parameter_value;
+
 /**
  * @brief Index for the menu entries.
- * Change the order of this enum to change the order of the presentation of entries in the menu
+ * The order of the entries is the order of BC_MENU_ENTRIES (menu_parameters.h)
  */
 typedef enum
 {
-    MENU_INDEX_CHECK_GAIN,
-    MENU_INDEX_SYNC_BETA,
-    MENU_INDEX_TEMPO_ALPHA,
-    MENU_INDEX_TEMPO_SPREAD,
-    MENU_INDEX_KICK_THRESHOLD,
-    MENU_INDEX_KICK_GATE,
-    MENU_INDEX_KICK_FILTER,
-    MENU_INDEX_KICK_DELTA_X,
-    MENU_INDEX_SNARE_THRESHOLD,
-    MENU_INDEX_SNARE_GATE,
-    MENU_INDEX_SNARE_FILTER,
-    MENU_INDEX_SNARE_DELTA_X,
-    MENU_INDEX_SAVE_VALUES,
+#define MENU_INDEX_OF_ENTRY(id, ...) MENU_INDEX_##id,
+    BC_MENU_ENTRIES(MENU_INDEX_OF_ENTRY)
+#undef MENU_INDEX_OF_ENTRY
     MENU_ITEM_INDEX_LENGTH,
 } menu_item_index;
 
@@ -189,4 +210,20 @@ void hid_set_up_values();
  */
 void set_menu_item_pointer_to_vrb(menu_item_index index, void *ptr);
 
+/**
+ * @brief Publishes the bpm to the hid: the hid is woken up only if the bpm displayed changes.
+ * Called by the modules that change the tempo (from a task, not from an ISR).
+ */
+void hid_publish_bpm(uint16_t bpm);
+
+/**
+ * @brief Wakeups of the hid task per second (measured over the time between two reports)
+ */
+extern volatile uint32_t hid_wakeups_per_second;
+
+/**
+ * @brief Redraws of the display per second (measured over the time between two reports)
+ */
+extern volatile uint32_t hid_redraws_per_second;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+/**
+ * @file bc_sequence_test.c
+ * @brief Torture test of the sequence counter of the seqlock of bc (bc_sequence.h) on the host.
+ * Two writer threads, serialized by a mutex as the spinlock of bc_seqlock.c does on the target,
+ * keep changing a struct shaped like bc (64-bit and 32-bit fields) so that all its fields are
+ * derived from the same counter. Two reader threads copy it as bc_read does and check that every
+ * snapshot is consistent: a torn copy fails the test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "bc_sequence.h"
+
+/**
+ * @brief Writes of every writer thread
+ */
+#define TEST_WRITES 5000000
+
+/**
+ * @{ \name Threads of the test
+ */
+#define TEST_WRITERS 2
+#define TEST_READERS 2
+/**
+ * @}
+ */
+
+/**
+ * @brief Struct shaped like main_runtime_vrbs: every field is derived from value
+ */
+typedef struct
+{
+    uint32_t tau;
+    uint8_t bar_position;
+    uint8_t layer;
+    uint32_t expected_beat;
+    uint32_t most_recent_onset_index;
+    uint64_t time_epoch;
+    uint64_t value;
+} test_vrbs;
+
+static test_vrbs shared;
+static volatile uint32_t sequence = 0;
+static pthread_mutex_t write_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile bool writers_done = false;
+
+/**
+ * @brief Returns the struct of the given value
+ */
+static test_vrbs test_vrbs_of(uint64_t value)
+{
+    test_vrbs vrbs = {
+        .tau = (uint32_t)value,
+        .bar_position = (uint8_t)(value % 16),
+        .layer = (uint8_t)(value >> 4),
+        .expected_beat = ~(uint32_t)value,
+        .most_recent_onset_index = (uint32_t)(value >> 32),
+        .time_epoch = value * 0x100000001ULL,
+        .value = value,
+    };
+    return vrbs;
+}
+
+/**
+ * @brief Returns true if all the fields come from the same value
+ */
+static bool test_vrbs_is_consistent(const test_vrbs *vrbs)
+{
+    test_vrbs expected = test_vrbs_of(vrbs->value);
+    return vrbs->tau == expected.tau && vrbs->bar_position == expected.bar_position &&
+           vrbs->layer == expected.layer && vrbs->expected_beat == expected.expected_beat &&
+           vrbs->most_recent_onset_index == expected.most_recent_onset_index &&
+           vrbs->time_epoch == expected.time_epoch;
+}
+
+static void *writer(void *arg)
+{
+    uint64_t base = (uint64_t)(uintptr_t)arg << 40;
+    for (uint64_t i = 0; i < TEST_WRITES; i++)
+    {
+        pthread_mutex_lock(&write_mutex);
+        bc_seqlock_write_begin(&sequence);
+        test_vrbs next = test_vrbs_of(base + (i * 0x10001ULL));
+        /*
+        Field by field, as the writers of bc do
+        */
+        volatile test_vrbs *target = &shared;
+        target->tau = next.tau;
+        target->bar_position = next.bar_position;
+        target->layer = next.layer;
+        target->expected_beat = next.expected_beat;
+        target->most_recent_onset_index = next.most_recent_onset_index;
+        target->time_epoch = next.time_epoch;
+        target->value = next.value;
+        bc_seqlock_write_end(&sequence);
+        pthread_mutex_unlock(&write_mutex);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Result of a reader thread
+ */
+typedef struct
+{
+    uint64_t reads;
+    uint64_t retries;
+    uint64_t torn;
+} reader_result;
+
+static void *reader(void *arg)
+{
+    reader_result *result = arg;
+    while (!writers_done)
+    {
+        test_vrbs snapshot;
+        uint32_t start_value = bc_seqlock_read_begin(&sequence);
+        snapshot = *(const volatile test_vrbs *)&shared;
+        while (bc_seqlock_read_retry(&sequence, start_value))
+        {
+            result->retries++;
+            start_value = bc_seqlock_read_begin(&sequence);
+            snapshot = *(const volatile test_vrbs *)&shared;
+        }
+        result->reads++;
+        if (!test_vrbs_is_consistent(&snapshot))
+        {
+            result->torn++;
+        }
+    }
+    return NULL;
+}
+
+int main()
+{
+    pthread_t writers[TEST_WRITERS];
+    pthread_t readers[TEST_READERS];
+    reader_result results[TEST_READERS] = {0};
+    shared = test_vrbs_of(0);
+    for (int i = 0; i < TEST_READERS; i++)
+    {
+        pthread_create(&readers[i], NULL, reader, &results[i]);
+    }
+    for (int i = 0; i < TEST_WRITERS; i++)
+    {
+        pthread_create(&writers[i], NULL, writer, (void *)(uintptr_t)(i + 1));
+    }
+    for (int i = 0; i < TEST_WRITERS; i++)
+    {
+        pthread_join(writers[i], NULL);
+    }
+    writers_done = true;
+    uint64_t torn = 0;
+    for (int i = 0; i < TEST_READERS; i++)
+    {
+        pthread_join(readers[i], NULL);
+        printf("reader %d: %llu reads, %llu retries, %llu torn\n", i, (unsigned long long)results[i].reads,
+               (unsigned long long)results[i].retries, (unsigned long long)results[i].torn);
+        torn += results[i].torn;
+    }
+    if (sequence != 2ULL * TEST_WRITERS * TEST_WRITES)
+    {
+        printf("FAIL: sequence %u after %d writes\n", sequence, TEST_WRITERS * TEST_WRITES);
+        return EXIT_FAILURE;
+    }
+    if (torn > 0)
+    {
+        printf("FAIL: %llu torn snapshots\n", (unsigned long long)torn);
+        return EXIT_FAILURE;
+    }
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
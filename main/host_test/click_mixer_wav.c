@@ -0,0 +1,149 @@
+/**
+ * @file click_mixer_wav.c
+ * @brief Renders the audio click (click_mixer.h) on the host to a WAV file and checks it.
+ * The clicks are scheduled as the clock ISR does (the time of the quarter, CLOCK_LEAD_US before it,
+ * with a tempo that does not fall on the frames) and rendered a DMA buffer at a time as the audio
+ * task does. A transport stop comes after a click has been scheduled and before it is heard.
+ * The test checks that:
+ * - every click is a copy of its sample starting on the frame nearest to its time (sample accurate)
+ * - the click scheduled before the stop is never heard and the output is silent after it
+ * - no click is late or dropped
+ * Usage: click_mixer_wav [file.wav] (click_mixer.wav by default)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "click_mixer.h"
+
+/**
+ * @{ \name Timeline of the test
+ */
+#define TEST_BUFFER_FRAMES 64 // frames of a DMA buffer of the audio task
+#define TEST_LEAD_US 24000 // the clock schedules the click this amount of us before it
+#define TEST_START_US 1000000 // time of the first frame
+#define TEST_FIRST_CLICK_US 1020000
+#define TEST_QUARTER_US 500037 // 120 bpm, not a multiple of the frame period
+#define TEST_CLICKS 8 // clicks of the clock
+#define TEST_STOP_CLICK 5 // the stop comes after this click has been scheduled and before its time
+#define TEST_STOP_ADVANCE_US 10000 // time from the stop to the click dropped
+#define TEST_FRAMES (CLICK_MIXER_SAMPLE_RATE * 5) // 5 s
+/**
+ * @}
+ */
+
+static click_mixer mixer;
+static int16_t output[TEST_FRAMES];
+static int16_t expected[TEST_FRAMES];
+
+/**
+ * @brief Returns the time of a click of the clock
+ */
+static uint64_t test_click_time(uint32_t click_index)
+{
+    return TEST_FIRST_CLICK_US + ((uint64_t)click_index * TEST_QUARTER_US);
+}
+
+/**
+ * @brief Writes the frames as a 16-bit mono WAV file. Returns false on error.
+ */
+static bool test_write_wav(const char *path, const int16_t *frames, uint32_t length)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    uint32_t data_size = length * sizeof(int16_t);
+    uint32_t riff_size = 36 + data_size;
+    uint32_t format_size = 16;
+    uint16_t format = 1; // PCM
+    uint16_t channels = 1;
+    uint32_t sample_rate = CLICK_MIXER_SAMPLE_RATE;
+    uint32_t byte_rate = CLICK_MIXER_SAMPLE_RATE * sizeof(int16_t);
+    uint16_t block_align = sizeof(int16_t);
+    uint16_t bits = 16;
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riff_size, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&format_size, 4, 1, file);
+    fwrite(&format, 2, 1, file);
+    fwrite(&channels, 2, 1, file);
+    fwrite(&sample_rate, 4, 1, file);
+    fwrite(&byte_rate, 4, 1, file);
+    fwrite(&block_align, 2, 1, file);
+    fwrite(&bits, 2, 1, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&data_size, 4, 1, file);
+    bool written = fwrite(frames, sizeof(int16_t), length, file) == length;
+    return fclose(file) == 0 && written;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "click_mixer.wav";
+    click_mixer_init(&mixer);
+    /*
+    Expected output: the clicks before the stop on the frame nearest to their time (they do not overlap)
+    */
+    for (uint32_t c = 0; c < TEST_STOP_CLICK; c++)
+    {
+        uint32_t frame = (((test_click_time(c) - TEST_START_US) * CLICK_MIXER_SAMPLE_RATE) + 500000) / 1000000;
+        memcpy(&expected[frame], mixer.samples[(c % 4) == 0 ? CLICK_ACCENT : CLICK_NORMAL], sizeof(mixer.samples[0]));
+    }
+    /*
+    Render a buffer at a time, scheduling the clicks and the stop as the clock does
+    */
+    uint32_t scheduled = 0;
+    bool stopped = false;
+    uint64_t stop_time = test_click_time(TEST_STOP_CLICK) - TEST_STOP_ADVANCE_US;
+    for (uint32_t first = 0; first + TEST_BUFFER_FRAMES <= TEST_FRAMES; first += TEST_BUFFER_FRAMES)
+    {
+        uint64_t start_time = TEST_START_US + (((uint64_t)first * 1000000) / CLICK_MIXER_SAMPLE_RATE);
+        while (!stopped && scheduled < TEST_CLICKS && test_click_time(scheduled) <= start_time + TEST_LEAD_US)
+        {
+            click_mixer_schedule(&mixer, test_click_time(scheduled), (scheduled % 4) == 0 ? CLICK_ACCENT : CLICK_NORMAL);
+            scheduled++;
+        }
+        if (!stopped && start_time >= stop_time)
+        {
+            click_mixer_schedule(&mixer, start_time, CLICK_STOP);
+            stopped = true;
+        }
+        click_mixer_render(&mixer, &output[first], TEST_BUFFER_FRAMES, start_time);
+    }
+    if (!test_write_wav(path, output, TEST_FRAMES))
+    {
+        printf("FAIL: can not write %s\n", path);
+        return EXIT_FAILURE;
+    }
+    /*
+    Compare the output with the expected one
+    */
+    int errors = 0;
+    uint32_t first_error = 0;
+    for (uint32_t i = 0; i < TEST_FRAMES; i++)
+    {
+        if (output[i] != expected[i] && errors++ == 0)
+        {
+            first_error = i;
+        }
+    }
+    if (errors > 0)
+    {
+        printf("%d frames differ from the expected ones (first at frame %u)\n", errors, first_error);
+    }
+    if (scheduled <= TEST_STOP_CLICK)
+    {
+        printf("the click after the stop was not scheduled before it\n");
+        errors++;
+    }
+    if (mixer.late != 0 || mixer.dropped != 0)
+    {
+        printf("%u clicks late, %u dropped\n", mixer.late, mixer.dropped);
+        errors++;
+    }
+    printf("%s written: %d clicks, stop before click %d\n", path, TEST_STOP_CLICK, TEST_STOP_CLICK);
+    printf("%s\n", errors == 0 ? "PASS" : "FAIL");
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,264 @@
+/**
+ * @file kalman_test.c
+ * @brief Test of the Kalman tracking engine (kalman.h) against the B-Keeper path (sync.h and tempo.h) on the host.
+ * The same stream of drum onsets is played to each engine in a closed loop: the loop plays the role of the clock
+ * and of onset_adc, it logs the onsets of the window of every 8th (a third of an 8th around the beat), runs the
+ * evaluation as the tracking task does and applies the corrections on the next 8th (at once, without ramps).
+ * The stream has:
+ * - a steady tempo, started from a tap tempo a little slow and late
+ * - jittered onsets (deterministic pseudo-random, every run is the same)
+ * - an outlier: a hit TEST_OUTLIER_US late in the steady part
+ * - a tempo step (the drummer speeds up) and the same tempo to the end
+ * The test checks that:
+ * - both engines converge on the tempo and the phase of the drummer before the step and at the end
+ * - the innovation gate of the filter rejects the outlier (and the running filter is not pulled by it)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "kalman.h"
+#include "sync.h"
+#include "tempo.h"
+#include "onset_adc.h"
+#include "hid.h"
+
+/**
+ * @{ \name Stream of the drummer (us)
+ */
+#define TEST_PERIOD_US 250000 // 8th at 120 bpm
+#define TEST_STEP_PERIOD_US 238095 // 8th at 126 bpm
+#define TEST_STEP_8TH (TWO_BAR_LENGTH_IN_8TH * 12) // the drummer speeds up here
+#define TEST_8THS (TWO_BAR_LENGTH_IN_8TH * 24)
+#define TEST_JITTER_US 4000 // the hits are up to this amount early or late
+#define TEST_OUTLIER_8TH (TWO_BAR_LENGTH_IN_8TH * 8 + 4)
+#define TEST_OUTLIER_US 70000
+/**
+ * @}
+ */
+
+/**
+ * @{ \name Start of the sequence: tap tempo 1% slow and 10 ms late
+ */
+#define TEST_START_TAU 252500
+#define TEST_START_PHASE_US 10000
+#define TEST_START_SPREAD_US 5000
+/**
+ * @}
+ */
+
+/**
+ * @{ \name Convergence: checked over the last TEST_CHECK_8THS before the step and before the end
+ */
+#define TEST_CHECK_8THS (TWO_BAR_LENGTH_IN_8TH * 2)
+#define TEST_MAX_TAU_ERROR_US 1500 // 0.6% of the 8th
+#define TEST_MAX_PHASE_ERROR_US 8000 // mean of |clock beat - beat of the drummer|
+/**
+ * @}
+ */
+
+typedef enum
+{
+    TEST_ENGINE_B_KEEPER,
+    TEST_ENGINE_KALMAN,
+} test_engine;
+
+/**
+ * @brief Errors of the clock over a check period
+ */
+typedef struct
+{
+    double tau_error; // |tau - period of the drummer| at the end of the period
+    double phase_error; // mean |clock beat - beat of the drummer|
+} test_errors;
+
+onset_entry onsets[ONSET_BUFFER_SIZE];
+static uint32_t test_seed = 1;
+
+/*
+Host stand-ins of the functions of the firmware used by the engines
+*/
+void set_menu_item_pointer_to_vrb(menu_item_index index, void *ptr) {}
+
+uint32_t onset_lower_bound(bc_time_t time, uint32_t first_index, uint32_t last_index)
+{
+    uint32_t i = first_index;
+    while (i != last_index && BC_TIME_DIFF(onsets[i].time, time) < 0)
+    {
+        i = (i + 1) % ONSET_BUFFER_SIZE;
+    }
+    return i;
+}
+
+/**
+ * @brief Returns a pseudo-random jitter in [-TEST_JITTER_US, TEST_JITTER_US]
+ */
+static int32_t test_jitter()
+{
+    test_seed = (test_seed * 1103515245) + 12345;
+    return (int32_t)((test_seed >> 16) % (2 * TEST_JITTER_US + 1)) - TEST_JITTER_US;
+}
+
+/**
+ * @brief Returns the period of the drummer on the 8th
+ */
+static uint32_t test_period(int n)
+{
+    return n < TEST_STEP_8TH ? TEST_PERIOD_US : TEST_STEP_PERIOD_US;
+}
+
+/**
+ * @brief Plays the stream to the engine and sets the errors of the clock before the step and at the end.
+ * Returns the correction of the phase sent on the 8th of the outlier.
+ */
+static long long test_run(test_engine engine, test_errors *before_step, test_errors *at_end)
+{
+    test_seed = 1;
+    kalman_tracking_enabled = engine == TEST_ENGINE_KALMAN;
+    sync_reset(TEST_START_TAU, TEST_START_SPREAD_US);
+    tempo_reset(TEST_START_TAU, TEST_START_SPREAD_US);
+    kalman_tracking_reset(TEST_START_TAU, TEST_START_SPREAD_US);
+    double drummer_beat = 1000000; // nominal time of the 8th of the drummer
+    double clock_beat = drummer_beat + TEST_START_PHASE_US;
+    double tau = TEST_START_TAU;
+    uint32_t most_recent = ONSET_BUFFER_SIZE - 1;
+    uint32_t first_tempo = 0;
+    long long outlier_sync = 0;
+    double phase_sum = 0;
+    for (int n = 0; n < TEST_8THS; n++)
+    {
+        /*
+        Window of the 8th: the hit of the drummer is logged if it falls in it
+        */
+        bc_time_t hit = (bc_time_t)llround(drummer_beat + test_jitter() + (n == TEST_OUTLIER_8TH ? TEST_OUTLIER_US : 0));
+        tracking_snapshot snapshot = {
+            .there_is_an_onset = false,
+            .tau = (uint32_t)llround(tau),
+            .expected_beat = (bc_time_t)llround(clock_beat),
+            .bar_position = n % TWO_BAR_LENGTH_IN_8TH,
+            .layer = (n % 8 == 0) ? 3 : (n % 4 == 0) ? 2 : (n % 2 == 0) ? 1 : 0,
+            .first_sync_index = (most_recent + 1) % ONSET_BUFFER_SIZE,
+            .first_tempo_index = first_tempo,
+        };
+        snapshot.now = snapshot.expected_beat + (snapshot.tau / 3);
+        if (BC_TIME_DIFF(hit, snapshot.expected_beat - (snapshot.tau / 3)) >= 0 && BC_TIME_DIFF(hit, snapshot.now) < 0)
+        {
+            most_recent = (most_recent + 1) % ONSET_BUFFER_SIZE;
+            onsets[most_recent] = (onset_entry){.time = hit, .type = n % 2};
+            snapshot.there_is_an_onset = true;
+        }
+        snapshot.most_recent_onset_index = most_recent;
+        /*
+        Evaluation of the tracking task
+        */
+        long long delta_tau_sync = 0;
+        long long delta_tau_tempo = 0;
+        bool send_corrections;
+        if (engine == TEST_ENGINE_KALMAN)
+        {
+            send_corrections = kalman_tracking_evaluate(&snapshot, &delta_tau_sync, &delta_tau_tempo);
+            if (send_corrections)
+            {
+                kalman_tracking_corrections_sent(delta_tau_sync, delta_tau_tempo);
+            }
+        }
+        else
+        {
+            send_corrections = sync_evaluate(&snapshot, &delta_tau_sync);
+            send_corrections |= tempo_evaluate(&snapshot, &delta_tau_tempo);
+            first_tempo = snapshot.first_tempo_index;
+        }
+        if (n == TEST_OUTLIER_8TH)
+        {
+            outlier_sync = delta_tau_sync;
+        }
+        /*
+        Errors of the 8th
+        */
+        int last_of_period = (n < TEST_STEP_8TH) ? TEST_STEP_8TH - 1 : TEST_8THS - 1;
+        if (n > last_of_period - TEST_CHECK_8THS)
+        {
+            phase_sum += fabs(clock_beat - drummer_beat);
+        }
+        if (n == last_of_period)
+        {
+            test_errors *errors = (n < TEST_STEP_8TH) ? before_step : at_end;
+            errors->tau_error = fabs(tau - test_period(n));
+            errors->phase_error = phase_sum / TEST_CHECK_8THS;
+            phase_sum = 0;
+        }
+        /*
+        The clock applies the corrections on the next 8th (tempo rejected if it goes back in time)
+        */
+        if (send_corrections && tau + delta_tau_tempo > 0)
+        {
+            tau += delta_tau_tempo;
+        }
+        clock_beat += tau + (send_corrections ? delta_tau_sync : 0);
+        drummer_beat += test_period(n + 1);
+    }
+    return outlier_sync;
+}
+
+/**
+ * @brief Checks that the gate of a converged filter rejects the outlier and leaves the state untouched
+ */
+static int test_gate()
+{
+    kalman_state k;
+    kalman_reset(&k, TEST_PERIOD_US);
+    test_seed = 1;
+    for (int n = 0; n < TWO_BAR_LENGTH_IN_8TH * 4; n++)
+    {
+        kalman_predict(&k);
+        kalman_update(&k, test_jitter(), 1);
+    }
+    kalman_predict(&k);
+    kalman_state before = k;
+    bool accepted = kalman_update(&k, TEST_OUTLIER_US, 1);
+    printf("gate: outlier of %d us against a phase sigma of %.0f us: %s\n", TEST_OUTLIER_US, kalman_phase_uncertainty(&before),
+           accepted ? "accepted" : "rejected");
+    if (accepted || memcmp(&k, &before, sizeof(k)) != 0)
+    {
+        printf("the gate does not reject the outlier\n");
+        return 1;
+    }
+    if (!kalman_update(&k, test_jitter(), 1))
+    {
+        printf("the gate rejects a hit in the jitter\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks the errors of a period and prints them. Returns the number of errors.
+ */
+static int test_check(const char *engine, const char *period, const test_errors *errors)
+{
+    bool converged = errors->tau_error <= TEST_MAX_TAU_ERROR_US && errors->phase_error <= TEST_MAX_PHASE_ERROR_US;
+    printf("%-8s %-12s tau error %6.0f us, phase error %6.0f us%s\n", engine, period, errors->tau_error, errors->phase_error,
+           converged ? "" : " (not converged)");
+    return converged ? 0 : 1;
+}
+
+int main()
+{
+    int errors = test_gate();
+    test_errors before_step;
+    test_errors at_end;
+    long long outlier_sync = test_run(TEST_ENGINE_B_KEEPER, &before_step, &at_end);
+    errors += test_check("B-Keeper", "before step", &before_step);
+    errors += test_check("B-Keeper", "at end", &at_end);
+    printf("B-Keeper sync correction on the outlier: %lld us\n", outlier_sync);
+    outlier_sync = test_run(TEST_ENGINE_KALMAN, &before_step, &at_end);
+    errors += test_check("Kalman", "before step", &before_step);
+    errors += test_check("Kalman", "at end", &at_end);
+    printf("Kalman sync correction on the outlier: %lld us\n", outlier_sync);
+    if (llabs(outlier_sync) > 2 * TEST_JITTER_US)
+    {
+        printf("the running filter has been pulled by the outlier\n");
+        errors++;
+    }
+    printf("%s\n", errors == 0 ? "PASS" : "FAIL");
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file midi_out_test.c
+ * @brief Test of the MIDI output engine (midi_out.h) on the host, with a fake UART.
+ * The loop plays the role of the clock ISR: it queues a MIDI Clock byte every tick (24 PPQN),
+ * services the port up to the next tick and sleeps until the time the port asks for. A task
+ * queues bursts of notes (note on, then note off with velocity 0) and a SONG POSITION + CONTINUE
+ * is sent in the middle of the sequence.
+ * The fake UART puts the bytes on a wire at 31250 baud. The test checks that:
+ * - every MIDI Clock byte starts on the wire at the time of its tick (no jitter)
+ * - the bytes on the wire never overlap (one byte at a time in the UART)
+ * - the channel and system messages decoded from the wire (running status included) are the ones queued
+ * - running status saves bytes and nothing is dropped
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "midi_out.h"
+
+/**
+ * @{ \name Timeline of the test (us)
+ */
+#define TEST_TICK_PERIOD 20833 // 120 bpm at 24 PPQN
+#define TEST_TICKS 480 // 10 s
+#define TEST_FIRST_TICK 10000
+#define TEST_BURST_PERIOD 61111 // a burst of notes about every 16th (drifting over the phase of the ticks)
+#define TEST_SONG_POSITION_TIME 3000000
+/**
+ * @}
+ */
+
+/**
+ * @brief Notes of every burst (a drum hit on kick, snare, hi-hat...)
+ */
+#define TEST_BURST_NOTES 4
+
+/**
+ * @brief Max bytes recorded on the wire
+ */
+#define TEST_MAX_BYTES 16384
+
+/**
+ * @brief Max messages queued by the test
+ */
+#define TEST_MAX_MESSAGES 2048
+
+/**
+ * @brief Byte on the wire of the fake UART
+ */
+typedef struct
+{
+    uint8_t byte;
+    uint64_t start; /**< Time the start bit goes on the wire */
+} wire_byte;
+
+static wire_byte wire[TEST_MAX_BYTES];
+static uint32_t wire_length = 0;
+static uint64_t wire_end = 0; // time the UART has sent all the bytes written
+static uint64_t test_now = 0; // time of the ISR (the fake UART needs it)
+
+static midi_message expected[TEST_MAX_MESSAGES]; // channel and system messages, in the order they are queued
+static uint32_t expected_length = 0;
+
+/**
+ * @brief Fake UART: the byte goes on the wire when the previous one has been sent
+ */
+static void fake_uart_write(int uart, uint8_t byte)
+{
+    if (wire_length == TEST_MAX_BYTES)
+    {
+        return;
+    }
+    uint64_t start = wire_end > test_now ? wire_end : test_now;
+    wire[wire_length++] = (wire_byte){.byte = byte, .start = start};
+    wire_end = start + MIDI_OUT_BYTE_TIME_US;
+}
+
+/**
+ * @brief Queues a channel message as a task does and keeps it as expected on the wire
+ */
+static void test_send(midi_out *out, uint8_t status, uint8_t data_1, uint8_t data_2)
+{
+    midi_message message = {.bytes = {status, data_1, data_2}, .length = 3};
+    if (midi_out_send(out, &message) && expected_length < TEST_MAX_MESSAGES)
+    {
+        /*
+        On the wire a note off with velocity 0 is a note on with velocity 0
+        */
+        if ((status & 0xF0) == 0x80 && data_2 == 0)
+        {
+            message.bytes[0] = 0x90 | (status & 0x0F);
+        }
+        expected[expected_length++] = message;
+    }
+}
+
+/**
+ * @brief Decodes the messages of the wire (realtime bytes removed, running status applied)
+ * and compares them with the expected ones. Returns the number of errors.
+ */
+static int test_check_messages()
+{
+    int errors = 0;
+    uint32_t decoded = 0;
+    uint8_t running_status = 0;
+    midi_message message = {0};
+    uint8_t data_needed = 0;
+    for (uint32_t i = 0; i < wire_length; i++)
+    {
+        uint8_t byte = wire[i].byte;
+        if (byte >= 0xF8)
+        {
+            continue; // realtime: can be anywhere
+        }
+        if (byte & 0x80)
+        {
+            message = (midi_message){.bytes = {byte}, .length = 1};
+            running_status = byte < 0xF0 ? byte : 0;
+            data_needed = (byte == 0xF2 || byte < 0xF0) ? 2 : 0;
+        }
+        else
+        {
+            if (message.length == 0 || message.length == 3)
+            {
+                if (running_status == 0)
+                {
+                    printf("data byte 0x%02X without status at %llu us\n", byte, (unsigned long long)wire[i].start);
+                    errors++;
+                    continue;
+                }
+                message = (midi_message){.bytes = {running_status}, .length = 1};
+                data_needed = 2;
+            }
+            message.bytes[message.length++] = byte;
+            data_needed--;
+        }
+        if (data_needed == 0 && message.length > 0)
+        {
+            if (decoded >= expected_length || memcmp(&message, &expected[decoded], sizeof(midi_message)) != 0)
+            {
+                printf("message %u: 0x%02X %02X %02X differs from the one queued\n", decoded, message.bytes[0],
+                       message.bytes[1], message.bytes[2]);
+                errors++;
+            }
+            decoded++;
+            message.length = 3; // the next data byte starts a message with running status
+        }
+    }
+    if (decoded != expected_length)
+    {
+        printf("%u messages decoded, %u queued\n", decoded, expected_length);
+        errors++;
+    }
+    return errors;
+}
+
+int main()
+{
+    midi_out out = {.write = fake_uart_write, .uart = 1};
+    uint64_t tick_times[TEST_TICKS];
+    uint32_t tick = 0;
+    uint64_t next_tick = TEST_FIRST_TICK;
+    uint64_t next_burst = TEST_FIRST_TICK + 1000;
+    uint32_t bursts = 0;
+    bool song_position_sent = false;
+    uint64_t next_service = UINT64_MAX;
+    while (tick < TEST_TICKS || next_service != UINT64_MAX)
+    {
+        /*
+        Wake up at the earliest of: tick, burst of notes, service asked by the port
+        */
+        test_now = next_service;
+        if (tick < TEST_TICKS && next_tick < test_now)
+        {
+            test_now = next_tick;
+        }
+        if (tick < TEST_TICKS && next_burst < test_now)
+        {
+            test_now = next_burst;
+        }
+        /*
+        Task: a burst of note on (odd bursts: the note off of the previous one)
+        */
+        if (tick < TEST_TICKS && test_now == next_burst)
+        {
+            for (uint8_t n = 0; n < TEST_BURST_NOTES; n++)
+            {
+                test_send(&out, (bursts % 2) ? 0x89 : 0x99, 36 + n, (bursts % 2) ? 0 : 100 + n);
+            }
+            bursts++;
+            next_burst += TEST_BURST_PERIOD;
+        }
+        /*
+        ISR: the clock byte of the tick, the SONG POSITION + CONTINUE once
+        */
+        if (tick < TEST_TICKS && test_now == next_tick)
+        {
+            if (!song_position_sent && test_now >= TEST_SONG_POSITION_TIME)
+            {
+                const uint8_t song_position[4] = {0xF2, 0x10, 0x01, 0xFB};
+                midi_out_system(&out, song_position, 4);
+                expected[expected_length++] = (midi_message){.bytes = {0xF2, 0x10, 0x01}, .length = 3};
+                song_position_sent = true;
+            }
+            midi_out_realtime(&out, 0xF8);
+            tick_times[tick++] = test_now;
+            next_tick += TEST_TICK_PERIOD;
+        }
+        uint64_t deadline = tick < TEST_TICKS ? next_tick : UINT64_MAX;
+        next_service = midi_out_service(&out, test_now, deadline);
+        if (next_service != UINT64_MAX && next_service <= test_now)
+        {
+            printf("service asked at %llu us, not after %llu us\n", (unsigned long long)next_service, (unsigned long long)test_now);
+            return EXIT_FAILURE;
+        }
+    }
+    /*
+    Clock bytes on time and bytes on the wire one after the other
+    */
+    int errors = 0;
+    uint32_t clock = 0;
+    int64_t max_jitter = 0;
+    for (uint32_t i = 0; i < wire_length; i++)
+    {
+        if (i > 0 && wire[i].start < wire[i - 1].start + MIDI_OUT_BYTE_TIME_US)
+        {
+            printf("byte %u overlaps the previous one\n", i);
+            errors++;
+        }
+        if (wire[i].byte == 0xF8 && clock < TEST_TICKS)
+        {
+            int64_t jitter = (int64_t)(wire[i].start - tick_times[clock++]);
+            max_jitter = jitter > max_jitter ? jitter : max_jitter;
+        }
+    }
+    if (clock != TEST_TICKS)
+    {
+        printf("%u clock bytes on the wire, %d expected\n", clock, TEST_TICKS);
+        errors++;
+    }
+    if (max_jitter > 0)
+    {
+        printf("clock bytes delayed up to %lld us\n", (long long)max_jitter);
+        errors++;
+    }
+    errors += test_check_messages();
+    midi_out_stats stats;
+    midi_out_get_stats(&out, &stats);
+    printf("%u bytes, %u messages, %u status bytes saved, %u dropped, wire busy %.1f%%\n", stats.bytes, expected_length,
+           stats.running_status_saved, stats.dropped, (100.0 * stats.busy_time) / wire_end);
+    if (stats.dropped != 0 || stats.running_status_saved == 0 || stats.bytes != wire_length)
+    {
+        errors++;
+    }
+    printf("%s\n", errors == 0 ? "PASS" : "FAIL");
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
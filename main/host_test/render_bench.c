@@ -0,0 +1,215 @@
+/**
+ * @file render_bench.c
+ * @brief Benchmark of the big chars of the display on the host (big_font.h and the 3x text of the SSD1306 driver).
+ * It first checks the framebuffers:
+ * - big_font_draw of the numbers 0-999 and of the texts of the TAP screen: every glyph copied from the
+ *   atlas, centered, the rest of the pages blank
+ * - ssd1306_display_text_x3 of every printable char (plain and inverted): the same columns as the
+ *   expansion of the font bit by bit (the code before the lookup table)
+ * then it prints the time of a frame of each one (and of the bit by bit expansion, for reference).
+ * The I2C and SPI functions of the driver are replaced by empty ones: only the drawing into the
+ * framebuffer is measured, not the transfer (see display.h).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "big_font.h"
+#include "font8x8_basic.h"
+
+/**
+ * @brief Frames of every measure
+ */
+#define BENCH_FRAMES 200000
+
+/**
+ * @{ \name Size of the display
+ */
+#define BENCH_WIDTH 128
+#define BENCH_HEIGHT 32
+/**
+ * @}
+ */
+
+/*
+The transfer to the display is not measured
+*/
+void i2c_init(SSD1306_t *dev, int width, int height)
+{
+    dev->_width = width;
+    dev->_height = height;
+    dev->_pages = height / 8;
+}
+void i2c_display_image(SSD1306_t *dev, int page, int seg, uint8_t *images, int width) {}
+void i2c_contrast(SSD1306_t *dev, int contrast) {}
+void i2c_hardware_scroll(SSD1306_t *dev, ssd1306_scroll_type_t scroll) {}
+void spi_init(SSD1306_t *dev, int width, int height) {}
+void spi_display_image(SSD1306_t *dev, int page, int seg, uint8_t *images, int width) {}
+void spi_contrast(SSD1306_t *dev, int contrast) {}
+void spi_hardware_scroll(SSD1306_t *dev, ssd1306_scroll_type_t scroll) {}
+int64_t esp_timer_get_time(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Returns the time of the host in ns
+ */
+static double bench_now()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (time.tv_sec * 1e9) + time.tv_nsec;
+}
+
+/**
+ * @brief Returns the number of pages of dev that differ from the reference
+ */
+static int bench_compare(SSD1306_t *dev, uint8_t reference[][BENCH_WIDTH], int first_page, int pages)
+{
+    int errors = 0;
+    for (int page = first_page; page < first_page + pages; page++)
+    {
+        if (memcmp(dev->_page[page]._segs, reference[page], BENCH_WIDTH) != 0)
+        {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief Reference of big_font_draw: the glyphs of the atlas centered on blank pages
+ */
+static void bench_big_font_reference(const char *text, uint8_t reference[][BENCH_WIDTH])
+{
+    int length = strlen(text) < BIG_FONT_MAX_LENGTH ? strlen(text) : BIG_FONT_MAX_LENGTH;
+    int start = (BENCH_WIDTH - (length * BIG_FONT_WIDTH)) / 2;
+    for (int page = 0; page < BIG_FONT_PAGES; page++)
+    {
+        memset(reference[page], 0, BENCH_WIDTH);
+        for (int i = 0; i < length; i++)
+        {
+            memcpy(&reference[page][start + (i * BIG_FONT_WIDTH)], BIG_CHARS[big_font_glyph(text[i])][page], BIG_FONT_WIDTH);
+        }
+    }
+}
+
+/**
+ * @brief 3x text expanded bit by bit and copied into the framebuffer (the code of the driver before the lookup table)
+ */
+static void bench_x3_bit_by_bit(SSD1306_t *dev, int page, const char *text, int text_len, bool invert)
+{
+    int seg = 0;
+    for (int n = 0; n < text_len && n < 5; n++)
+    {
+        const uint8_t *in_columns = font8x8_basic_tr[(uint8_t)text[n]];
+        uint32_t out_columns[8];
+        for (int x = 0; x < 8; x++)
+        {
+            out_columns[x] = 0;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                if (in_columns[x] & (1 << bit))
+                {
+                    out_columns[x] |= 0x7UL << (3 * bit);
+                }
+            }
+        }
+        for (int y = 0; y < 3; y++)
+        {
+            uint8_t image[24];
+            for (int x = 0; x < 8; x++)
+            {
+                image[x * 3] = image[(x * 3) + 1] = image[(x * 3) + 2] = (out_columns[x] >> (8 * y)) & 0xFF;
+            }
+            if (invert)
+            {
+                ssd1306_invert(image, 24);
+            }
+            ssd1306_display_image(dev, page + y, seg, image, 24);
+        }
+        seg += 24;
+    }
+}
+
+int main()
+{
+    SSD1306_t dev = {._address = I2CAddress};
+    SSD1306_t bit_by_bit = {._address = I2CAddress};
+    ssd1306_init(&dev, BENCH_WIDTH, BENCH_HEIGHT);
+    ssd1306_init(&bit_by_bit, BENCH_WIDTH, BENCH_HEIGHT);
+    uint8_t reference[BIG_FONT_PAGES][BENCH_WIDTH];
+    int errors = 0;
+    /*
+    Big chars: numbers of the bpm and hits, texts of the TAP screen
+    */
+    const char *texts[] = {"TAP", "TAP 4", "120", "0", "1/4", "ABCDE", "VWXYZ", "123456"};
+    char text[8];
+    for (int v = 0; v < 1000 + (int)(sizeof(texts) / sizeof(texts[0])); v++)
+    {
+        if (v < 1000)
+        {
+            snprintf(text, sizeof(text), "%d", v);
+        }
+        else
+        {
+            snprintf(text, sizeof(text), "%s", texts[v - 1000]);
+        }
+        big_font_draw(&dev, text);
+        bench_big_font_reference(text, reference);
+        if (bench_compare(&dev, reference, 0, BIG_FONT_PAGES) != 0 && errors++ < 5)
+        {
+            printf("big_font_draw(\"%s\") differs from the atlas\n", text);
+        }
+    }
+    /*
+    3x text: every printable char, plain and inverted
+    */
+    for (int c = ' '; c < 127; c++)
+    {
+        for (int invert = 0; invert < 2; invert++)
+        {
+            char chars[5] = {c, c + 1, c, c + 1, c};
+            ssd1306_clear_screen(&dev, false);
+            ssd1306_clear_screen(&bit_by_bit, false);
+            ssd1306_display_text_x3(&dev, 0, chars, 5, invert);
+            bench_x3_bit_by_bit(&bit_by_bit, 0, chars, 5, invert);
+            for (int page = 0; page < 3; page++)
+            {
+                memcpy(reference[page], bit_by_bit._page[page]._segs, BENCH_WIDTH);
+            }
+            if (bench_compare(&dev, reference, 0, 3) != 0 && errors++ < 5)
+            {
+                printf("ssd1306_display_text_x3('%c', invert %d) differs from the bit by bit expansion\n", c, invert);
+            }
+        }
+    }
+    /*
+    Time of a frame
+    */
+    double start = bench_now();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        snprintf(text, sizeof(text), "%d", 60 + (i % 200));
+        big_font_draw(&dev, text);
+    }
+    double big_font_time = (bench_now() - start) / BENCH_FRAMES;
+    start = bench_now();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        ssd1306_display_text_x3(&dev, 0, "12345", 5, i & 1);
+    }
+    double x3_time = (bench_now() - start) / BENCH_FRAMES;
+    start = bench_now();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        bench_x3_bit_by_bit(&bit_by_bit, 0, "12345", 5, i & 1);
+    }
+    double x3_bit_time = (bench_now() - start) / BENCH_FRAMES;
+    printf("big_font_draw: %.0f ns/frame\n", big_font_time);
+    printf("ssd1306_display_text_x3: %.0f ns/frame (bit by bit expansion: %.0f ns/frame)\n", x3_time, x3_bit_time);
+    printf("%s\n", errors == 0 ? "PASS" : "FAIL");
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,6 @@
+/* Host stand-in of driver/spi_master.h for the host tests (host_test/CMakeLists.txt) */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+typedef void *spi_device_handle_t;
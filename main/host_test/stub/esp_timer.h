@@ -0,0 +1,4 @@
+/* Host stand-in of esp_timer.h for the host tests (host_test/CMakeLists.txt) */
+#pragma once
+#include <stdint.h>
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,4 @@
+/* Host stand-in of freertos/FreeRTOS.h for the host tests (host_test/CMakeLists.txt) */
+#pragma once
+#include <stdint.h>
+typedef uint32_t TickType_t;
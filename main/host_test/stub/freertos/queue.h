@@ -0,0 +1,3 @@
+/* Host stand-in of freertos/queue.h for the host tests (host_test/CMakeLists.txt) */
+#pragma once
+typedef void *QueueHandle_t;
@@ -0,0 +1,2 @@
+/* Host stand-in of sdkconfig.h for the host tests (host_test/CMakeLists.txt) */
+#pragma once
@@ -0,0 +1,165 @@
+#include "kalman.h"
+#include "onset_adc.h"
+#include "hid.h"
+
+extern onset_entry onsets[];
+extern const double SYNC_WEIGHT[2][TWO_BAR_LENGTH_IN_8TH];
+
+bool kalman_tracking_enabled = false;
+volatile uint32_t kalman_phase_uncertainty_us = 0;
+
+void kalman_reset(kalman_state *k, double tau)
+{
+    double phase_sigma = tau / KALMAN_INITIAL_PHASE_WIDTH_FACTOR;
+    double period_sigma = tau / KALMAN_INITIAL_PERIOD_WIDTH_FACTOR;
+    k->phase = 0;
+    k->period = 0;
+    k->p[0][0] = phase_sigma * phase_sigma;
+    k->p[0][1] = 0;
+    k->p[1][0] = 0;
+    k->p[1][1] = period_sigma * period_sigma;
+}
+
+void kalman_predict(kalman_state *k)
+{
+    /*
+    x = F x with F = [1 1; 0 1]: the period error moves the phase by one 8th
+    */
+    k->phase += k->period;
+    /*
+    P = F P F' + Q
+    */
+    double p00 = k->p[0][0] + k->p[0][1] + k->p[1][0] + k->p[1][1];
+    double p01 = k->p[0][1] + k->p[1][1];
+    double p10 = k->p[1][0] + k->p[1][1];
+    double p11 = k->p[1][1];
+    k->p[0][0] = p00 + (double)KALMAN_PROCESS_PHASE_SIGMA_US * KALMAN_PROCESS_PHASE_SIGMA_US;
+    k->p[0][1] = p01;
+    k->p[1][0] = p10;
+    k->p[1][1] = p11 + (double)KALMAN_PROCESS_PERIOD_SIGMA_US * KALMAN_PROCESS_PERIOD_SIGMA_US;
+}
+
+bool kalman_update(kalman_state *k, double error, double weight)
+{
+    if (weight <= 0)
+    {
+        return false;
+    }
+    /*
+    Measurement z = H x + v with H = [1 0]; weak positions get a larger noise
+    */
+    double r = ((double)KALMAN_MEASUREMENT_SIGMA_US * KALMAN_MEASUREMENT_SIGMA_US) / weight;
+    double innovation = error - k->phase;
+    double s = k->p[0][0] + r;
+    /*
+    Innovation gate (replaces the accuracy threshold of B-Keeper)
+    */
+    if (innovation * innovation > (double)KALMAN_GATE_SIGMAS * KALMAN_GATE_SIGMAS * s)
+    {
+        return false;
+    }
+    /*
+    K = P H' / S, x = x + K y, P = (I - K H) P
+    */
+    double k0 = k->p[0][0] / s;
+    double k1 = k->p[1][0] / s;
+    k->phase += k0 * innovation;
+    k->period += k1 * innovation;
+    double p00 = k->p[0][0];
+    double p01 = k->p[0][1];
+    k->p[0][0] -= k0 * p00;
+    k->p[0][1] -= k0 * p01;
+    k->p[1][0] -= k1 * p00;
+    k->p[1][1] -= k1 * p01;
+    return true;
+}
+
+void kalman_apply_corrections(kalman_state *k, double delta_phase, double delta_period)
+{
+    k->phase -= delta_phase;
+    k->period -= delta_period;
+}
+
+double kalman_phase_uncertainty(const kalman_state *k)
+{
+    return sqrt(k->p[0][0]);
+}
+
+uint32_t kalman_get_phase_uncertainty_us()
+{
+    return kalman_phase_uncertainty_us;
+}
+
+/*
+State of the running filter
+*/
+static kalman_state filter;
+
+void kalman_tracking_reset(uint32_t tau, uint32_t spread)
+{
+    /*
+    A new sequence is starting: reset the filter with the new tau
+    (more phase uncertainty if the start taps were sloppy)
+    */
+    kalman_reset(&filter, tau);
+    double spread_sigma = (double)TRACKING_START_SPREAD_SIGMAS * spread;
+    if (filter.p[0][0] < spread_sigma * spread_sigma)
+    {
+        filter.p[0][0] = spread_sigma * spread_sigma;
+    }
+    kalman_phase_uncertainty_us = (uint32_t)kalman_phase_uncertainty(&filter);
+}
+
+bool kalman_tracking_evaluate(const tracking_snapshot *snapshot, long long *delta_tau_sync, long long *delta_tau_tempo)
+{
+    /*
+    Advance the filter to the current 8th
+    */
+    kalman_predict(&filter);
+    if (snapshot->there_is_an_onset)
+    {
+        /*
+        Update the filter once for every onset of the window
+        */
+        int i = snapshot->first_sync_index;
+        while (1)
+        {
+            int32_t error = BC_TIME_DIFF(onsets[i].time, snapshot->expected_beat);
+            kalman_update(&filter, error, SYNC_WEIGHT[onsets[i].type][snapshot->bar_position]);
+            if (i == snapshot->most_recent_onset_index)
+            {
+                break;
+            }
+            i = (i + 1) % ONSET_BUFFER_SIZE;
+        }
+    }
+    kalman_phase_uncertainty_us = (uint32_t)kalman_phase_uncertainty(&filter);
+    /*
+    Prepare both corrections: the tempo is changed only outside the dead band
+    and never so much to go back in time (as the clock does)
+    */
+    *delta_tau_sync = llround(filter.phase);
+    *delta_tau_tempo = llround(filter.period);
+    if (*delta_tau_tempo < KALMAN_MIN_TEMPO_CORRECTION_US && *delta_tau_tempo > -KALMAN_MIN_TEMPO_CORRECTION_US)
+    {
+        *delta_tau_tempo = 0;
+    }
+    if (*delta_tau_tempo <= (long long)(snapshot->tau * -0.8))
+    {
+        *delta_tau_tempo = 0;
+    }
+    return (*delta_tau_sync != 0 || *delta_tau_tempo != 0);
+}
+
+void kalman_tracking_corrections_sent(long long delta_tau_sync, long long delta_tau_tempo)
+{
+    kalman_apply_corrections(&filter, delta_tau_sync, delta_tau_tempo);
+}
+
+void kalman_init()
+{
+    /*
+    Add the engine selection to the menu
+    */
+    set_menu_item_pointer_to_vrb(MENU_INDEX_TRACKING_KALMAN, &kalman_tracking_enabled);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file kalman.h
+ * @brief KALMAN module is an alternative tracking engine to the Sync and Tempo modules.
+ * Instead of two separate B-Keeper evaluations, the module models the clock with a 2-state
+ * Kalman filter: the phase error (distance between the onsets and the expected beat) and the
+ * period error (difference between the 8th of the drummer and bc.tau), both in us.
+ * Every 8th the filter is advanced by one step and then updated once for every onset logged
+ * in the window. Onsets whose innovation falls outside the gate (KALMAN_GATE_SIGMAS times the
+ * predicted standard deviation) are rejected: the gate replaces the gaussian accuracy threshold.
+ * Both corrections are returned to the tracking module that sends them to the clock.
+ *
+ * The engine is selected from the menu (TRACKING entry). When it is enabled, the tracking module
+ * runs the filter instead of the sync and tempo evaluations.
+ *
+ * The filter functions (kalman_reset, kalman_predict, kalman_update, ...) only use plain C math
+ * so that they can be compiled and run on the host next to the B-Keeper path (host_test/kalman_test.c).
+ */
+
+#ifndef BC_KALMAN_H
+#define BC_KALMAN_H
+
+#include "main_defs.h"
+#include "tracking.h"
+
+/**
+ * @{ \name Filter parameters (all values in us)
+ */
+#define KALMAN_MEASUREMENT_SIGMA_US 12000 // timing jitter of the drummer on a full weight position
+#define KALMAN_PROCESS_PHASE_SIGMA_US 2000 // phase drift allowed for every 8th
+#define KALMAN_PROCESS_PERIOD_SIGMA_US 1000 // period drift allowed for every 8th
+#define KALMAN_INITIAL_PHASE_WIDTH_FACTOR 10 // initial phase sigma is tau / factor (as sigma_sync)
+#define KALMAN_INITIAL_PERIOD_WIDTH_FACTOR 20 // initial period sigma is tau / factor (as sigma_tempo)
+#define KALMAN_GATE_SIGMAS 3 // innovation gate (in standard deviations)
+#define KALMAN_MIN_TEMPO_CORRECTION_US 900 // same dead band used by the tempo module
+/**
+ * @}
+ */
+
+/**
+ * @brief State of the filter.
+ * x = [phase, period], P is the covariance of the estimate.
+ */
+typedef struct
+{
+    double phase; /**< Phase error of the clock (onset time - expected beat) */
+    double period; /**< Period error of the clock (drummer 8th - bc.tau) */
+    double p[2][2]; /**< Covariance matrix of [phase, period] */
+} kalman_state;
+
+/**
+ * @brief Enables the Kalman engine in place of the Sync and Tempo modules.
+ * Registered to the menu (TRACKING entry).
+ */
+extern bool kalman_tracking_enabled;
+
+/**
+ * @brief Resets the filter for a new sequence with the given 8th period.
+ */
+void kalman_reset(kalman_state *k, double tau);
+
+/**
+ * @brief Advances the filter by one 8th note.
+ */
+void kalman_predict(kalman_state *k);
+
+/**
+ * @brief Updates the filter with a single onset.
+ * The error is the distance of the onset from the expected beat. The weight (0-1] scales the
+ * measurement noise: onsets on weak positions are trusted less.
+ * Returns false if the onset has been rejected by the innovation gate.
+ */
+bool kalman_update(kalman_state *k, double error, double weight);
+
+/**
+ * @brief Removes from the state the corrections that have been applied to the clock.
+ */
+void kalman_apply_corrections(kalman_state *k, double delta_phase, double delta_period);
+
+/**
+ * @brief Standard deviation of the phase estimate (us).
+ */
+double kalman_phase_uncertainty(const kalman_state *k);
+
+/**
+ * @brief Standard deviation of the phase estimate of the running filter (us).
+ * It can be read from other modules to display the tracking confidence.
+ */
+uint32_t kalman_get_phase_uncertainty_us();
+
+/**
+ * @brief Resets the running filter for a new sequence with the given tau.
+ * The phase uncertainty is at least TRACKING_START_SPREAD_SIGMAS times the spread of the start taps.
+ */
+void kalman_tracking_reset(uint32_t tau, uint32_t spread);
+
+/**
+ * @brief Runs the filter on the onsets of the current window.
+ * Returns true (and sets both corrections) if the clock has to be changed.
+ */
+bool kalman_tracking_evaluate(const tracking_snapshot *snapshot, long long *delta_tau_sync, long long *delta_tau_tempo);
+
+/**
+ * @brief Removes from the running filter the corrections that have been sent to the clock.
+ */
+void kalman_tracking_corrections_sent(long long delta_tau_sync, long long delta_tau_tempo);
+
+/**
+ * @brief Init function for the kalman module
+ * The function adds the engine selection to the menu
+ */
+void kalman_init();
+
+#endif
@@ -6,11 +6,15 @@
 #include "main_defs.h"
 #include "onset_adc.h"
 #include "sync.h"
+#include "kalman.h"
+#include "tracking.h"
 #include "clock.h"
+#include "clock_in.h"
 #include "tap.h"
 #include "mode_switch.h"
 #include "tempo.h"
 #include "hid.h"
+#include "telemetry.h"
 #include "driver/gpio.h"
 #include "../components/ssd1306/ssd1306.h"
 #include "../components/ssd1306/font8x8_basic.h"
@@ -25,16 +29,11 @@ onset_entry onsets[ONSET_BUFFER_SIZE];
  */
 volatile main_mode mode = MODE_TAP;
 
-/**
- * @brief Mutex for protecting the bc variable
- */
-SemaphoreHandle_t bc_mutex_handle = NULL;
-
 /**
  * @brief Main runtime variable of the system
  */
 main_runtime_vrbs bc = {
-    .tau = 250, // 8th time in ms (bpm120)
+    .tau = 250000, // 8th time in us (bpm120)
     .bar_position = 0, // current bar position onto two bars (0-15)
     .layer = 0, // current layer value of the bar position
     .expected_beat = 0, // position of the next expected beat
@@ -42,6 +41,7 @@ main_runtime_vrbs bc = {
     .most_recent_onset_index = 0, // index of the most recent onset inside the array
     .last_relevant_onset_index_for_sync = -1, // index of the last relevant onset for sync calculation
     .last_relevant_onset_index_for_tempo = 0, // index of the last relevant onset for tempo calculation
+    .time_epoch = 0, // absolute time of the start of the sequence (epoch of bc_time_t)
 };
 
 /**
@@ -54,10 +54,6 @@ void app_main(void)
     */
     gpio_install_isr_service(0);
     /*
-    Create the mutex of bc variable
-    */
-    bc_mutex_handle = xSemaphoreCreateMutex();
-    /*
     Start all the modules
     */
     ESP_LOGI("main.c","hid_init");
@@ -68,10 +64,16 @@ void app_main(void)
     onset_adc_init();
     sync_init();
     tempo_init();
+    kalman_init();
+    tracking_init();
     ESP_LOGI("main.c","tap_init");
     tap_init();
     ESP_LOGI("main.c","clock_init");
     clock_init();
+    ESP_LOGI("main.c","clock_in_init");
+    clock_in_init();
+    ESP_LOGI("main.c","telemetry_init");
+    telemetry_init();
     /*
     Refresh the menu values after all the modules setted their pointer
     */
@@ -25,11 +25,14 @@
  */
 #define TAP_TASK_PRIORITY 10
 #define CLOCK_TASK_PRIORITY 11
-#define TEMPO_TASK_PRIORITY 10
-#define SYNC_TASK_PRIORITY 10
+#define TRACKING_TASK_PRIORITY 10
 #define ONSET_ADC_TASK_PRIORITY 10
 #define HID_TASK_PRIORITY 10
 #define MODE_SWITCH_TASK_PRIORITY 10
+#define CLOCK_IN_TASK_PRIORITY 10
+#define AUDIO_CLICK_TASK_PRIORITY 11
+#define DISPLAY_TASK_PRIORITY 5
+#define TELEMETRY_TASK_PRIORITY 1
 /**
  * @}
  */
@@ -39,15 +42,23 @@
  */
 #define TAP_TASK_STACK_SIZE 4096
 #define CLOCK_TASK_STACK_SIZE 4096
-#define TEMPO_TASK_STACK_SIZE 4096
-#define SYNC_TASK_STACK_SIZE 4096
+#define TRACKING_TASK_STACK_SIZE 4096
 #define ONSET_ADC_TASK_STACK_SIZE 4096
 #define HID_TASK_STACK_SIZE 4096
 #define MODE_SWITCH_STACK_SIZE 4096
+#define CLOCK_IN_TASK_STACK_SIZE 4096
+#define AUDIO_CLICK_TASK_STACK_SIZE 4096
+#define DISPLAY_TASK_STACK_SIZE 4096
+#define TELEMETRY_TASK_STACK_SIZE 4096
 /**
  * @}
  */
 
+/**
+ * @brief Number of 8th notes contained in a bar
+ */
+#define BAR_LENGTH_IN_8TH 8
+
 /**
  * @brief Number of 8th notes contained in two bars
  */
@@ -56,7 +67,14 @@
 /**
  * @brief Max number of onsets that can be stored at the same time
  */
-#define ONSET_BUFFER_SIZE 300
+#define ONSET_BUFFER_SIZE 600
+
+/**
+ * @brief Set to 1 to log the latency of the tracking stage.
+ * The clock module measures the time from MIDI_CLOCK_SECOND_THIRD (end of the onset window)
+ * to the moment the correction is applied and logs max and average every two bars.
+ */
+#define TRACKING_LATENCY_LOG 0
 
 /**
  * @brief Macros that gives the current time in ms
@@ -68,6 +86,28 @@
  */
 #define US_TO_MS(time_us) ((time_us + 500) / 1000)      
 
+/**
+ * @brief Time of the sequence: us since bc.time_epoch (start of the sequence).
+ * It wraps every ~71 minutes: always compare two values with BC_TIME_DIFF, never with < or >.
+ */
+typedef uint32_t bc_time_t;
+
+/**
+ * @brief Macros that gives the signed distance (a - b) in us between two bc_time_t (wrap safe)
+ */
+#define BC_TIME_DIFF(a, b) ((int32_t)((bc_time_t)(a) - (bc_time_t)(b)))
+
+/**
+ * @brief Macros that converts an absolute time (esp_timer) in bc_time_t, with the epoch of vrbs
+ * (a snapshot of bc taken with bc_read, or bc itself inside a write section)
+ */
+#define BC_TIME_FROM_US(vrbs, time_us) ((bc_time_t)((time_us) - (vrbs).time_epoch))
+
+/**
+ * @brief Macros that gives the current time as bc_time_t, with the epoch of vrbs
+ */
+#define BC_TIME_NOW(vrbs) BC_TIME_FROM_US(vrbs, esp_timer_get_time())
+
 /**
  * @brief Enum of the four main modes of the system
  */
@@ -85,14 +125,15 @@ typedef enum
  */
 typedef struct
 {
-    uint64_t tau; // 8th time in ms (bpm120)
+    uint32_t tau; // 8th time in us
     uint8_t bar_position;
     uint8_t layer;
-    uint64_t expected_beat;
+    bc_time_t expected_beat;
     bool there_is_an_onset;
     uint32_t most_recent_onset_index;
     int last_relevant_onset_index_for_sync;
     uint32_t last_relevant_onset_index_for_tempo;
+    uint64_t time_epoch; // absolute time (esp_timer) of the start of the sequence, epoch of bc_time_t
 } main_runtime_vrbs;
 
 #endif
\ No newline at end of file
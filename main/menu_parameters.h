@@ -1,173 +1,93 @@
 /**
  * @file menu_parameters.h
  * @brief This file contains the parameters for each menu entry
+ *
+ * Every entry of the menu is a line of BC_MENU_ENTRIES, in the order of presentation:
+ * X(id, top name, name, storage key, type, min, max, default percentage, percentage step, stored)
+ * - id: the entry is MENU_INDEX_<id> (see menu_item_index in hid.h)
+ * - top name/name: the two lines shown in SETTINGS mode (15 characters at most)
+ * - storage key: NVS key of the stored percentage (an identifier, 15 characters at most, unique)
+ * - type: type of the variable (bc_variable_type in hid.h)
+ * - min/max: range of the variable (integers, in hundredths for BC_DOUBLE)
+ * - default percentage/percentage step: starting value and encoder step (0 to 100)
+ * - stored: the value is saved in the NVS partition (false for the entries that are not parameters)
+ * The table, the enum and the compile-time checks of the entries (lengths, ranges, unique keys)
+ * are all generated from this list, so adding a parameter is a line here plus the call to
+ * set_menu_item_pointer_to_vrb in the module that owns the variable.
  */
 
 #ifndef BC_MENU_PARAMETERS
 #define BC_MENU_PARAMETERS
 
 /**
- * @brief Name displayed when the system asks to save values
+ * @{ \name Text of the gain entry (the first one)
  */
-#define SAVE_VALUES_PARAMETER_NAME_TOP "SAVE VALUES    "
-#define SAVE_VALUES_PARAMETER_NAME "SAVE VALUES    "
-
-#define CHECK_GAIN_NAME_TOP "GAIN:          "
-#define CHECK_GAIN_NAME "Set the gain so"
 #define CHECK_GAIN_TEXT_1 "the light don't"
-#define CHECK_GAIN_TEXT_2 "blink.         " 
-
-/**
- * @{ \name alpha menu entry parameters
- */
-#define ALPHA_PARAMETER_NAME_TOP "TEMPO          "
-#define ALPHA_PARAMETER_NAME "Responsiveness:"
-#define ALPHA_STORAGE_KEY "tempo_alpha    "
-#define ALPHA_MIN_VALUE 0.2
-#define ALPHA_MAX_VALUE 1.2
-#define ALPHA_DEFAULT_PERCENTAGE 50
-#define ALPHA_PERCENTAGE_STEP 1
-/**
- * @}
- */
-
-/**
- * @{ \name beta menu entry parameters
- */
-#define BETA_PARAMETER_NAME_TOP "SYNC           "
-#define BETA_PARAMETER_NAME "Responsiveness:"
-#define BETA_STORAGE_KEY "sync_beta      "
-#define BETA_MIN_VALUE 0.2
-#define BETA_MAX_VALUE 1.2
-#define BETA_DEFAULT_PERCENTAGE 50
-#define BETA_PERCENTAGE_STEP 1
-/**
- * @}
- */
-
-/**
- * @{ \name Tempo spread menu entry parameters
- */
-#define SPREAD_PARAMETER_NAME_TOP "SYNC           "
-#define SPREAD_PARAMETER_NAME "Increase value:"
-#define SPREAD_STORAGE_KEY "sync_beta      "
-#define SPREAD_MIN_VALUE 0
-#define SPREAD_MAX_VALUE 8
-#define SPREAD_DEFAULT_PERCENTAGE 50
-#define SPREAD_PERCENTAGE_STEP 13
-/**
- * @}
- */
-
-/**
- * @{ \name kick low pass menu entry parameters
- */
-#define KICK_LOW_PASS_PARAMETER_NAME_TOP "KICK           "
-#define KICK_LOW_PASS_PARAMETER_NAME "Filter:        "
-#define KICK_LOW_PASS_STORAGE_KEY "kick_filter    "
-#define KICK_LOW_PASS_MIN_VALUE 1
-#define KICK_LOW_PASS_MAX_VALUE 100
-#define KICK_LOW_PASS_DEFAULT_PERCENTAGE 50
-#define KICK_LOW_PASS_PERCENTAGE_STEP 1
-/**
- * @}
- */
-
-/**
- * @{ \name kick threshold menu entry parameters
- */
-#define KICK_THRESHOLD_PARAMETER_NAME_TOP "KICK           "
-#define KICK_THRESHOLD_PARAMETER_NAME "Threshold:     "
-#define KICK_THRESHOLD_STORAGE_KEY "kick_thresh    "
-#define KICK_THRESHOLD_MIN_VALUE 0
-#define KICK_THRESHOLD_MAX_VALUE 4096
-#define KICK_THRESHOLD_DEFAULT_PERCENTAGE 50
-#define KICK_THRESHOLD_PERCENTAGE_STEP 1
-/**
- * @}
- */
-
-/**
- * @{ \name kick gate menu entry parameters
- */
-#define KICK_GATE_TIMER_PARAMETER_NAME_TOP "KICK           "
-#define KICK_GATE_TIMER_PARAMETER_NAME "Retrigger gate:"
-#define KICK_GATE_TIMER_STORAGE_KEY "kick_gate      "
-#define KICK_GATE_TIMER_MIN_VALUE 70000 // 70ms (72ms is the distance between two 16th notes at ~208bpm)
-#define KICK_GATE_TIMER_MAX_VALUE 500000 // 500ms (1500ms is the distance between two 4th notes at ~40bpm)
-#define KICK_GATE_TIMER_DEFAULT_PERCENTAGE 50
-#define KICK_GATE_TIMER_PERCENTAGE_STEP 1
+#define CHECK_GAIN_TEXT_2 "blink.         "
 /**
  * @}
  */
 
 /**
- * @{ \name kick delta menu entry parameters
- */
-#define KICK_DELTA_X_PARAMETER_NAME_TOP "KICK           "
-#define KICK_DELTA_X_PARAMETER_NAME "Onset length:  "
-#define KICK_DELTA_X_STORAGE_KEY "kick_delta     "
-#define KICK_DELTA_X_MIN_VALUE 3
-#define KICK_DELTA_X_MAX_VALUE 200
-#define KICK_DELTA_X_DEFAULT_PERCENTAGE 50
-#define KICK_DELTA_X_PERCENTAGE_STEP 1
-/**
- * @}
- */
+ * @brief Entries of the menu
+ * - PRESET: slot of the preset selected (see presets.h), the values are stored in the slot
+ * - SETLIST_SONG: 0: off, 1 to SETLIST_MAX_SONGS: song selected (see setlist.h)
+ * - SETLIST_BPM/METER/PRESET: nominal tempo, beats of the bar and preset (0: keep) of the song selected
+ * - SETLIST_RANGE: % of tolerance of the tap tempo around the nominal tempo of the song
+ * - TEMPO_SPREAD: 8th notes over which a tempo correction is spread
+ * - CLOCK_RAMP_CURVE: 0: step, 1: linear, 2: exponential, 3: critically damped (see clock_ramp.h)
+ * - CLOCK_RAMP_LENGTH: MIDI Clock ticks; CLOCK_RAMP_MAX_RATE: us of period change for every tick
+ * - MIDI_x_OFFSET: us of latency compensation, the port is early of this amount
+ * - MIDI_x_RATE: 0: 24 PPQN, 1: half-time (12 PPQN), 2: double-time (48 PPQN)
+ * - SYNC_OUT_RATE: 0: off, 1: 1 PPQN, 2: 2 PPQN, 3: 4 PPQN, 4: 24 PPQN (DIN sync)
+ * - TRANSPORT_CONTINUE: a new start continues the song from the bar after the stop (SONG POSITION + CONTINUE)
+ * - CLOCK_IN_SOURCE: 0: internal (tap and drummer tracking), 1: follow MIDI IN 1, 2: follow MIDI IN 2 (slave mode)
+ * - TAP_COUNT_IN: the onsets of the drums in TAP mode can start the clock (hands-free count-in, see count_in.h)
+ * - TAP_TAPS: number of taps of the tap tempo
+ * - NOTE_OUT_PORT: 0: off, 1: MIDI OUT 1, 2: MIDI OUT 2, 3: both; channel 10 and notes 36/38 by default
+ * - KICK/SNARE_GATE: us (72ms is the distance between two 16th notes at ~208bpm)
+ */
+#define BC_MENU_ENTRIES(X)                                                                                                                   \
+    X(CHECK_GAIN, "GAIN:          ", "Set the gain so", dummy_gain_name, BC_NONE, 0, 1, 50, 1, false)                                        \
+    X(PRESET, "PRESET         ", "Slot:          ", preset_slot, BC_UINT16, 0, PRESETS_SLOTS - 1, 0, PRESETS_MENU_STEP, false)               \
+    X(SETLIST_SONG, "SETLIST        ", "Song:          ", setlist_song, BC_UINT16, 0, SETLIST_MAX_SONGS, 0, SETLIST_MENU_STEP, false)        \
+    X(SETLIST_BPM, "SETLIST        ", "Tempo:         ", setlist_bpm, BC_UINT16, 60, 260, 30, 1, false)                                      \
+    X(SETLIST_METER, "SETLIST        ", "Meter:         ", setlist_meter, BC_UINT16, 2, 8, 34, 17, false)                                    \
+    X(SETLIST_PRESET, "SETLIST        ", "Preset:        ", setlist_preset, BC_UINT16, 0, PRESETS_SLOTS, 0, SETLIST_PRESET_MENU_STEP, false) \
+    X(SETLIST_RANGE, "SETLIST        ", "Range:         ", setlist_range, BC_UINT16, 2, 20, 33, 6, true)                                     \
+    X(SYNC_BETA, "SYNC           ", "Responsiveness:", sync_beta, BC_DOUBLE, 20, 120, 50, 1, true)                                           \
+    X(TEMPO_ALPHA, "TEMPO          ", "Responsiveness:", tempo_alpha, BC_DOUBLE, 20, 120, 50, 1, true)                                       \
+    X(TEMPO_SPREAD, "SYNC           ", "Increase value:", tempo_spread, BC_UINT16, 0, 8, 50, 13, true)                                       \
+    X(CLOCK_RAMP_CURVE, "CLOCK RAMP     ", "Curve:         ", ramp_curve, BC_UINT16, 0, 3, 34, 34, true)                                     \
+    X(CLOCK_RAMP_LENGTH, "CLOCK RAMP     ", "Length:        ", ramp_length, BC_UINT16, 6, 192, 10, 1, true)                                  \
+    X(CLOCK_RAMP_MAX_RATE, "CLOCK RAMP     ", "Max rate:      ", ramp_max_rate, BC_UINT16, 50, 2050, 22, 1, true)                            \
+    X(MIDI_1_OFFSET, "MIDI OUT 1     ", "Offset:        ", midi_1_offset, BC_UINT16, 0, MIDI_OFFSET_MAX_VALUE, 0, 1, true)                   \
+    X(MIDI_2_OFFSET, "MIDI OUT 2     ", "Offset:        ", midi_2_offset, BC_UINT16, 0, MIDI_OFFSET_MAX_VALUE, 0, 1, true)                   \
+    X(MIDI_1_RATE, "MIDI OUT 1     ", "Rate:          ", midi_1_rate, BC_UINT16, 0, 2, 0, 50, true)                                          \
+    X(MIDI_2_RATE, "MIDI OUT 2     ", "Rate:          ", midi_2_rate, BC_UINT16, 0, 2, 0, 50, true)                                          \
+    X(SYNC_OUT_RATE, "SYNC OUT       ", "Rate:          ", sync_out_rate, BC_UINT16, 0, 4, 0, 25, true)                                      \
+    X(TRANSPORT_CONTINUE, "TRANSPORT      ", "Continue:      ", transport_cont, BC_YESNO, 0, 1, 0, 100, true)                                \
+    X(CLOCK_IN_SOURCE, "CLOCK IN       ", "Source:        ", clock_in_src, BC_UINT16, 0, 2, 0, 50, true)                                     \
+    X(TAP_COUNT_IN, "TAP            ", "Count-in:      ", tap_count_in, BC_YESNO, 0, 1, 0, 100, true)                                        \
+    X(TAP_TAPS, "TAP            ", "Taps:          ", tap_taps, BC_UINT16, 3, 8, 20, 20, true)                                               \
+    X(NOTE_OUT_PORT, "NOTE OUT       ", "Port:          ", note_out_port, BC_UINT16, 0, 3, 0, 34, true)                                      \
+    X(NOTE_OUT_CHANNEL, "NOTE OUT       ", "Channel:       ", note_out_chan, BC_UINT16, 1, 16, 60, 6, true)                                  \
+    X(NOTE_OUT_KICK, "NOTE OUT       ", "Kick note:     ", note_out_kick, BC_UINT16, 24, 87, 19, 1, true)                                    \
+    X(NOTE_OUT_SNARE, "NOTE OUT       ", "Snare note:    ", note_out_snare, BC_UINT16, 24, 87, 22, 1, true)                                  \
+    X(KICK_THRESHOLD, "KICK           ", "Threshold:     ", kick_thresh, BC_UINT16, 0, 4096, 50, 1, true)                                    \
+    X(KICK_GATE, "KICK           ", "Retrigger gate:", kick_gate, BC_UINT64, 70000, 500000, 50, 1, true)                                     \
+    X(KICK_FILTER, "KICK           ", "Filter:        ", kick_filter, BC_UINT16, 1, 100, 50, 1, true)                                        \
+    X(KICK_DELTA_X, "KICK           ", "Onset length:  ", kick_delta, BC_UINT16, 3, 200, 50, 1, true)                                        \
+    X(SNARE_THRESHOLD, "SNARE          ", "Threshold:     ", snare_thresh, BC_UINT16, 0, 4096, 50, 1, true)                                  \
+    X(SNARE_GATE, "SNARE          ", "Retrigger gate:", snare_gate, BC_UINT64, 1000, 500000, 50, 1, true)                                    \
+    X(SNARE_FILTER, "SNARE          ", "Filter:        ", snare_filter, BC_UINT16, 1, 100, 50, 1, true)                                      \
+    X(SNARE_DELTA_X, "SNARE          ", "Onset length:  ", snare_delta, BC_UINT16, 3, 200, 50, 1, true)                                      \
+    X(TRACKING_KALMAN, "TRACKING       ", "Kalman filter: ", track_kalman, BC_YESNO, 0, 1, 0, 100, true)                                     \
+    X(SAVE_VALUES, "SAVE VALUES    ", "SAVE VALUES    ", dummy_saves, BC_YESNO, 0, 1, 0, 100, false)
 
 /**
- * @{ \name snare low pass menu entry parameters
- */
-#define SNARE_LOW_PASS_PARAMETER_NAME_TOP "SNARE          "
-#define SNARE_LOW_PASS_PARAMETER_NAME "Filter:        "
-#define SNARE_LOW_PASS_STORAGE_KEY "snare_filter   "
-#define SNARE_LOW_PASS_MIN_VALUE 1
-#define SNARE_LOW_PASS_MAX_VALUE 100
-#define SNARE_LOW_PASS_DEFAULT_PERCENTAGE 50
-#define SNARE_LOW_PASS_PERCENTAGE_STEP 1
-/**
- * @}
+ * @brief Max latency compensation of a MIDI OUT port (us)
  */
+#define MIDI_OFFSET_MAX_VALUE 25000
 
-/**
- * @{ \name snare threshold menu entry parameters
- */
-#define SNARE_THRESHOLD_PARAMETER_NAME_TOP "SNARE          "
-#define SNARE_THRESHOLD_PARAMETER_NAME "Threshold:     "
-#define SNARE_THRESHOLD_STORAGE_KEY "snare_thresh   "
-#define SNARE_THRESHOLD_MIN_VALUE 0
-#define SNARE_THRESHOLD_MAX_VALUE 4096
-#define SNARE_THRESHOLD_DEFAULT_PERCENTAGE 50
-#define SNARE_THRESHOLD_PERCENTAGE_STEP 1
-/**
- * @}
- */
-
-/**
- * @{ \name snare gate menu entry parameters
- */
-#define SNARE_GATE_TIMER_PARAMETER_NAME_TOP "SNARE          "
-#define SNARE_GATE_TIMER_PARAMETER_NAME "Retrigger gate:"
-#define SNARE_GATE_TIMER_STORAGE_KEY "snare_gate     "
-#define SNARE_GATE_TIMER_MIN_VALUE 1000
-#define SNARE_GATE_TIMER_MAX_VALUE 500000
-#define SNARE_GATE_TIMER_DEFAULT_PERCENTAGE 50
-#define SNARE_GATE_TIMER_PERCENTAGE_STEP 1
-/**
- * @}
- */
-
-/**
- * @{ \name snare delta menu entry parameters
- */
-#define SNARE_DELTA_X_PARAMETER_NAME_TOP "SNARE          "
-#define SNARE_DELTA_X_PARAMETER_NAME "Onset length:  "
-#define SNARE_DELTA_X_STORAGE_KEY "snare_delta    "
-#define SNARE_DELTA_X_MIN_VALUE 3
-#define SNARE_DELTA_X_MAX_VALUE 200
-#define SNARE_DELTA_X_DEFAULT_PERCENTAGE 50
-#define SNARE_DELTA_X_PERCENTAGE_STEP 1
-/**
- * @}
- */
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,234 @@
+/**
+ * @file midi_out.h
+ * @brief MIDI OUT is the output engine of a MIDI port: every byte sent on the port goes through it.
+ * It has three lanes, served in order of priority:
+ * - realtime: single bytes (MIDI CLOCK, START, CONTINUE, STOP). They are written at once, so they
+ *   wait at most for the byte already on the wire and can be sent in the middle of another message
+ * - system: one message written by the clock (SONG POSITION POINTER + CONTINUE)
+ * - channel: the midi_queue filled by the tasks (notes...). Running status is applied: the status byte
+ *   is skipped when it is the same as the previous one (a note off with velocity 0 is sent as a note on)
+ * System and channel messages are written one byte at a time (so that a realtime byte is never
+ * queued behind a whole message) and only if the byte is completely sent before the deadline
+ * given by the caller (the next realtime byte): realtime bytes are never delayed.
+ * The engine keeps track of the time of the bytes on the wire at 31250 baud and counts bytes,
+ * dropped messages and status bytes saved.
+ *
+ * A port is defined with its write function and UART set and everything else zeroed.
+ * All the functions, except midi_out_send, are called by a single context (the clock ISR) with the
+ * time of the timer in us. The UART is reached through the write function of the port, so that the
+ * engine only uses plain C and can be compiled on the host with a fake UART.
+ */
+
+#ifndef BC_MIDI_OUT_H
+#define BC_MIDI_OUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "midi_queue.h"
+
+/**
+ * @brief Baud rate of MIDI
+ */
+#define MIDI_OUT_BAUD_RATE 31250
+
+/**
+ * @brief Time of a byte on the wire in us (start bit, 8 data bits, stop bit)
+ */
+#define MIDI_OUT_BYTE_TIME_US ((10 * 1000000) / MIDI_OUT_BAUD_RATE)
+
+/**
+ * @brief Number of realtime bytes that can wait (power of two)
+ */
+#define MIDI_OUT_REALTIME_SIZE 8
+
+/**
+ * @brief Max length of a system message
+ */
+#define MIDI_OUT_SYSTEM_LENGTH 4
+
+/**
+ * @brief Function that writes a byte on the UART of the port
+ */
+typedef void (*midi_out_write_fn)(int uart, uint8_t byte);
+
+/**
+ * @brief Counters of a port
+ */
+typedef struct
+{
+    uint32_t depth; /**< Channel messages waiting */
+    uint32_t dropped; /**< Messages dropped because a lane was full */
+    uint32_t bytes; /**< Bytes written on the wire */
+    uint32_t running_status_saved; /**< Status bytes not sent thanks to running status */
+    uint64_t busy_time; /**< Time spent by the bytes on the wire (us) */
+} midi_out_stats;
+
+/**
+ * @brief State of a port
+ */
+typedef struct
+{
+    midi_out_write_fn write; /**< Writes a byte on the UART */
+    int uart; /**< UART of the port (argument of write) */
+    midi_queue channel; /**< Channel messages (written by a task) */
+    uint8_t realtime[MIDI_OUT_REALTIME_SIZE]; /**< Realtime bytes waiting */
+    uint8_t realtime_head; /**< Number of realtime bytes pushed */
+    uint8_t realtime_tail; /**< Number of realtime bytes written */
+    uint8_t system[MIDI_OUT_SYSTEM_LENGTH]; /**< System message waiting */
+    uint8_t system_length; /**< Length of the system message waiting (0 if none) */
+    uint8_t message[MIDI_OUT_SYSTEM_LENGTH]; /**< Message being written */
+    uint8_t message_length; /**< Length of the message being written */
+    uint8_t message_index; /**< Next byte of the message to write */
+    uint8_t running_status; /**< Status byte of the last channel message (0 if none) */
+    uint64_t wire_free_time; /**< Time at which the UART will have sent all the bytes written */
+    uint32_t dropped; /**< Realtime and system messages dropped */
+    uint32_t bytes; /**< Bytes written */
+    uint32_t running_status_saved; /**< Status bytes skipped */
+} midi_out;
+
+/**
+ * @brief Adds a channel message to the port (task). It never blocks: returns false if the queue is full.
+ */
+static inline bool midi_out_send(midi_out *out, const midi_message *message)
+{
+    return midi_queue_push(&out->channel, message);
+}
+
+/**
+ * @brief Adds a realtime byte to the port. Returns false if the lane is full.
+ */
+static inline bool midi_out_realtime(midi_out *out, uint8_t byte)
+{
+    if ((uint8_t)(out->realtime_head - out->realtime_tail) == MIDI_OUT_REALTIME_SIZE)
+    {
+        out->dropped++;
+        return false;
+    }
+    out->realtime[out->realtime_head++ % MIDI_OUT_REALTIME_SIZE] = byte;
+    return true;
+}
+
+/**
+ * @brief Sets the system message of the port. Returns false if the previous one is still waiting.
+ */
+static inline bool midi_out_system(midi_out *out, const uint8_t *bytes, uint8_t length)
+{
+    if (out->system_length != 0 || length == 0 || length > MIDI_OUT_SYSTEM_LENGTH)
+    {
+        out->dropped++;
+        return false;
+    }
+    for (uint8_t i = 0; i < length; i++)
+    {
+        out->system[i] = bytes[i];
+    }
+    out->system_length = length;
+    return true;
+}
+
+/**
+ * @brief Writes a byte on the UART and accounts its time on the wire
+ */
+static inline void midi_out_write(midi_out *out, uint8_t byte, uint64_t now)
+{
+    out->write(out->uart, byte);
+    out->wire_free_time = (out->wire_free_time > now ? out->wire_free_time : now) + MIDI_OUT_BYTE_TIME_US;
+    out->bytes++;
+}
+
+/**
+ * @brief Takes the next message to write: the system one, otherwise the oldest channel message.
+ * Returns false if there is none.
+ */
+static inline bool midi_out_load(midi_out *out)
+{
+    out->message_index = 0;
+    if (out->system_length != 0)
+    {
+        for (uint8_t i = 0; i < out->system_length; i++)
+        {
+            out->message[i] = out->system[i];
+        }
+        out->message_length = out->system_length;
+        out->system_length = 0;
+        out->running_status = 0; // system common messages cancel running status
+        return true;
+    }
+    const midi_message *next = midi_queue_peek(&out->channel);
+    if (next == NULL)
+    {
+        out->message_length = 0;
+        return false;
+    }
+    midi_message message = *next;
+    midi_queue_pop(&out->channel);
+    out->message_length = message.length;
+    for (uint8_t i = 0; i < message.length; i++)
+    {
+        out->message[i] = message.bytes[i];
+    }
+    /*
+    A note off with velocity 0 becomes a note on with velocity 0 (same meaning)
+    so that notes on and off share the running status
+    */
+    if ((out->message[0] & 0xF0) == 0x80 && message.length == 3 && out->message[2] == 0)
+    {
+        out->message[0] = 0x90 | (out->message[0] & 0x0F);
+    }
+    if (out->message[0] == out->running_status)
+    {
+        out->message_index = 1;
+        out->running_status_saved++;
+    }
+    else
+    {
+        out->running_status = out->message[0] < 0xF0 ? out->message[0] : 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes what the port can write now.
+ * The realtime bytes are always written; then a byte of a system or channel message if the wire
+ * is free and the byte ends before deadline (time of the next realtime byte).
+ * Returns the time at which the port has to be serviced again (UINT64_MAX if it can wait the deadline).
+ */
+static inline uint64_t midi_out_service(midi_out *out, uint64_t now, uint64_t deadline)
+{
+    while (out->realtime_tail != out->realtime_head)
+    {
+        midi_out_write(out, out->realtime[out->realtime_tail++ % MIDI_OUT_REALTIME_SIZE], now);
+    }
+    if (out->message_index == out->message_length && !midi_out_load(out))
+    {
+        return UINT64_MAX; // nothing to send
+    }
+    if (out->wire_free_time > now)
+    {
+        return out->wire_free_time; // one byte at a time: wait for the wire
+    }
+    if (now + MIDI_OUT_BYTE_TIME_US > deadline)
+    {
+        return UINT64_MAX; // it would delay the realtime byte: retry after it
+    }
+    midi_out_write(out, out->message[out->message_index++], now);
+    if (out->message_index == out->message_length && !midi_out_load(out))
+    {
+        return UINT64_MAX;
+    }
+    return out->wire_free_time;
+}
+
+/**
+ * @brief Copies the counters of the port
+ */
+static inline void midi_out_get_stats(midi_out *out, midi_out_stats *stats)
+{
+    stats->depth = midi_queue_depth(&out->channel);
+    stats->dropped = out->dropped + __atomic_load_n(&out->channel.dropped, __ATOMIC_RELAXED);
+    stats->bytes = out->bytes;
+    stats->running_status_saved = out->running_status_saved;
+    stats->busy_time = (uint64_t)out->bytes * MIDI_OUT_BYTE_TIME_US;
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file midi_queue.h
+ * @brief MIDI QUEUE is a lock-free queue of outgoing MIDI channel messages.
+ * It has a single producer (a task, e.g. onset_adc_task for the drum notes) and a single consumer
+ * (the clock ISR, that owns the UARTs and sends the messages between the MIDI Clock bytes).
+ * The producer never blocks: if the queue is full the message is dropped and counted.
+ * The queue only uses plain C (and gcc atomics) so that it can be compiled on the host.
+ */
+
+#ifndef BC_MIDI_QUEUE_H
+#define BC_MIDI_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of messages of the queue (power of two)
+ */
+#define MIDI_QUEUE_SIZE 32
+
+/**
+ * @brief MIDI channel message (status byte and up to two data bytes)
+ */
+typedef struct
+{
+    uint8_t bytes[3];
+    uint8_t length;
+} midi_message;
+
+/**
+ * @brief Queue of the messages.
+ * head is written only by the producer and tail only by the consumer.
+ */
+typedef struct
+{
+    midi_message messages[MIDI_QUEUE_SIZE];
+    uint32_t head; /**< Number of messages pushed */
+    uint32_t tail; /**< Number of messages popped */
+    uint32_t dropped; /**< Number of messages dropped because the queue was full (producer) */
+} midi_queue;
+
+/**
+ * @brief Adds a message to the queue (producer). Returns false if the queue is full.
+ */
+static inline bool midi_queue_push(midi_queue *queue, const midi_message *message)
+{
+    uint32_t head = queue->head;
+    if (head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) == MIDI_QUEUE_SIZE)
+    {
+        queue->dropped++;
+        return false;
+    }
+    queue->messages[head % MIDI_QUEUE_SIZE] = *message;
+    /*
+    Publish the message only after it has been written
+    */
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Returns the oldest message of the queue without removing it (consumer). NULL if empty.
+ */
+static inline const midi_message *midi_queue_peek(midi_queue *queue)
+{
+    uint32_t tail = queue->tail;
+    if (tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+    return &queue->messages[tail % MIDI_QUEUE_SIZE];
+}
+
+/**
+ * @brief Removes the oldest message of the queue (consumer). Call it only after a successful peek.
+ */
+static inline void midi_queue_pop(midi_queue *queue)
+{
+    /*
+    Release the slot only after the message has been read
+    */
+    __atomic_store_n(&queue->tail, queue->tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Returns the number of messages waiting in the queue
+ */
+static inline uint32_t midi_queue_depth(midi_queue *queue)
+{
+    return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+}
+
+#endif
@@ -137,6 +137,11 @@ static void mode_switch_task(void *arg)
                 Change main mode
                 */
                 mode = MODE_PLAY;
+                /*
+                Ask hid to switch to bpm mode
+                */
+                msg_to_hid = HID_PLAY_MODE_SELECT;
+                xQueueSend(hid_task_queue, &msg_to_hid, (TickType_t)0);
                 break;
             case MODE_SWITCH_TO_SETTINGS:
                 /*
@@ -1,10 +1,16 @@
 #include "main_defs.h"
+#include <sys/param.h>
 #include "esp_adc/adc_continuous.h"
 #include "driver/gptimer.h"
 #include "driver/gpio.h"
 #include "onset_adc.h"
 #include "sync.h"
+#include "tracking.h"
+#include "bc_seqlock.h"
 #include "hid.h"
+#include "clock.h"
+#include "midi_out.h"
+#include "tap.h"
 
 /**
  * Uncomment this to enable ADC testing mode:
@@ -82,6 +88,17 @@ uint32_t index_for_adc_test = 0;
  * @}
  */
 
+/**
+ * @{ \name Drum to MIDI note parameters
+ */
+#define NOTE_VELOCITY_WINDOW_US 2000 // max time to find the peak of the envelope after the onset
+#define NOTE_LENGTH_US 50000 // time between note on and note off
+#define MIDI_NOTE_ON 0x90
+#define MIDI_NOTE_OFF 0x80
+/**
+ * @}
+ */
+
 /**
  * @brief Config struct for the ADC channel
  * It includes values for the onset detection.
@@ -114,14 +131,28 @@ typedef struct
     uint64_t last_onset_time;// Last time a onset has been triggered
     uint16_t past_samples_current_onset_index;// Index of the current sample in the array of past samples
     uint16_t past_samples[MAX_ONSET_DELTA_X_LENGTH];// Array of the past samples
+    uint16_t note_peak;// Peak of the envelope after the onset (velocity of the note)
+    uint64_t note_on_time;// Time of the onset whose note is waiting for the peak (0 if none)
+    uint64_t note_off_time;// Time to send the note off of the last note (0 if none)
 } runtime_onset_values;
 
+/**
+ * @brief Config struct for the drum to MIDI notes
+*/
+typedef struct
+{
+    uint16_t port; // 0: off, 1: MIDI OUT 1, 2: MIDI OUT 2, 3: both
+    uint16_t channel; // MIDI channel (1-16)
+    uint16_t note[2]; // Note number of kick and snare
+} drum_notes_cfg;
+
 extern TaskHandle_t onset_adc_task_handle; // onset_adc task handle 
-extern SemaphoreHandle_t bc_mutex_handle; // mutex for the access to bc struct 
-extern TaskHandle_t sync_task_handle; // sync_task handle
+extern TaskHandle_t tracking_task_handle; // tracking_task handle
 extern main_runtime_vrbs bc; // global struct with runtime vrbs
 extern onset_entry onsets[]; // array of onsets
 extern void set_menu_item_pointer_to_vrb(menu_item_index index, void *ptr);
+extern midi_out midi_ports[]; // output engines of MIDI OUT 1 and 2
+extern volatile main_mode mode; // current mode of the system
 
 TaskHandle_t onset_adc_task_handle = NULL;
 QueueHandle_t onset_adc_task_queue = NULL;
@@ -280,7 +311,124 @@ void turn_on_adc(){
     adc_continuous_start(adc_handle);
 }
 
-/** 
+/** @brief Function to log an onset
+ * The entry is written in the next slot of the onsets array before publishing the new index,
+ * so that the tracking module never reads a slot that is still being written
+*/
+static void log_onset(uint64_t time_us, uint8_t type)
+{
+    main_runtime_vrbs current;
+    bc_read(&current);
+    uint32_t current_onset_index = (current.most_recent_onset_index + 1) % ONSET_BUFFER_SIZE;
+    onsets[current_onset_index].time = BC_TIME_FROM_US(current, time_us);
+    onsets[current_onset_index].type = type;
+    bc_write_begin();
+    bc.most_recent_onset_index = current_onset_index;
+    bc_write_end();
+}
+
+/** @brief Function to send an onset to the count-in of the tap module
+ * Only in TAP mode and if TAP Count-in is set (the tap task can start the clock from the onsets)
+*/
+static void send_count_in_onset(uint64_t time)
+{
+    if (mode == MODE_TAP && tap_count_in && tap_task_queue != NULL)
+    {
+        uint64_t tap_task_msg = time | TAP_TASK_QUEUE_ONSET;
+        xQueueSend(tap_task_queue, &tap_task_msg, (TickType_t)0);
+    }
+}
+
+/** @brief Function to send a note message on the selected MIDI outputs
+ * The message is pushed in the output engine of the port (it never blocks) and the clock ISR sends it
+ * between the MIDI Clock bytes.
+*/
+static void send_note_message(const drum_notes_cfg *cfg, uint8_t status, uint8_t note, uint8_t velocity)
+{
+    midi_message message = {
+        .bytes = {status | ((cfg->channel - 1) & 0x0F), note & 0x7F, velocity & 0x7F},
+        .length = 3,
+    };
+    if (cfg->port & 1)
+    {
+        midi_out_send(&midi_ports[0], &message);
+    }
+    if (cfg->port & 2)
+    {
+        midi_out_send(&midi_ports[1], &message);
+    }
+    clock_kick();
+}
+
+/** @brief Function to start the note of an onset
+ * The note on waits for the peak of the envelope (see update_note) to calculate the velocity.
+ * If the note of the previous onset is still on, it is turned off first.
+*/
+static void start_note(const drum_notes_cfg *cfg, runtime_onset_values *drum, uint8_t type, uint64_t time)
+{
+    if (cfg->port == 0)
+    {
+        return;
+    }
+    if (drum->note_off_time != 0)
+    {
+        send_note_message(cfg, MIDI_NOTE_OFF, cfg->note[type], 0);
+        drum->note_off_time = 0;
+    }
+    drum->note_on_time = time;
+    drum->note_peak = drum->current_sample;
+}
+
+/** @brief Function to update the note of a drum for every sample
+ * The note on is sent when the envelope stops rising (or after NOTE_VELOCITY_WINDOW_US) with
+ * the velocity given by the peak, the note off NOTE_LENGTH_US later.
+*/
+static void update_note(const drum_notes_cfg *cfg, runtime_onset_values *drum, uint8_t type, uint64_t time)
+{
+    if (drum->note_on_time != 0)
+    {
+        if (drum->current_sample > drum->note_peak)
+        {
+            drum->note_peak = drum->current_sample;
+        }
+        else if (drum->current_sample < drum->note_peak || time >= drum->note_on_time + NOTE_VELOCITY_WINDOW_US)
+        {
+            uint8_t velocity = 1 + ((uint32_t)MIN(drum->note_peak, 4095) * 126) / 4095;
+            send_note_message(cfg, MIDI_NOTE_ON, cfg->note[type], velocity);
+            drum->note_on_time = 0;
+            drum->note_off_time = time + NOTE_LENGTH_US;
+        }
+    }
+    else if (drum->note_off_time != 0 && time >= drum->note_off_time)
+    {
+        send_note_message(cfg, MIDI_NOTE_OFF, cfg->note[type], 0);
+        drum->note_off_time = 0;
+    }
+}
+
+uint32_t onset_lower_bound(bc_time_t time, uint32_t first_index, uint32_t last_index)
+{
+    /*
+    Search on the offset from first_index (the ring is ordered from there)
+    */
+    uint32_t low = 0;
+    uint32_t high = (last_index + ONSET_BUFFER_SIZE - first_index) % ONSET_BUFFER_SIZE;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (BC_TIME_DIFF(onsets[(first_index + middle) % ONSET_BUFFER_SIZE].time, time) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return (first_index + low) % ONSET_BUFFER_SIZE;
+}
+
+/**
  * @brief Main task for the adc and onset detection module
 */
 void onset_adc_task(void *arg)
@@ -317,6 +465,18 @@ void onset_adc_task(void *arg)
     set_menu_item_pointer_to_vrb(MENU_INDEX_SNARE_THRESHOLD, &snare_onset_cfg.delta_threshold);
     set_menu_item_pointer_to_vrb(MENU_INDEX_SNARE_GATE, &snare_onset_cfg.gate_time_us);
     set_menu_item_pointer_to_vrb(MENU_INDEX_SNARE_FILTER, &snare_onset_cfg.decrease);
+    /*
+    Set up drum to MIDI notes (off by default) and add it to the menu
+    */
+    static drum_notes_cfg notes_cfg = {
+        .port = 0,
+        .channel = 10,
+        .note = {36, 38},
+    };
+    set_menu_item_pointer_to_vrb(MENU_INDEX_NOTE_OUT_PORT, &notes_cfg.port);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_NOTE_OUT_CHANNEL, &notes_cfg.channel);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_NOTE_OUT_KICK, &notes_cfg.note[KICK]);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_NOTE_OUT_SNARE, &notes_cfg.note[SNARE]);
 
     /*
     Set up runtime onset structs with zero values
@@ -326,12 +486,18 @@ void onset_adc_task(void *arg)
         .last_onset_time = 0,
         .past_samples_current_onset_index = 0,
         .past_samples = {0},
+        .note_peak = 0,
+        .note_on_time = 0,
+        .note_off_time = 0,
     };
     static runtime_onset_values snare = {
         .current_sample = 0,
         .last_onset_time = 0,
         .past_samples_current_onset_index = 0,
         .past_samples = {0},
+        .note_peak = 0,
+        .note_on_time = 0,
+        .note_off_time = 0,
     };
 
     #ifdef ADC_TEST
@@ -367,10 +533,10 @@ void onset_adc_task(void *arg)
                         /*
                         Start logging onsets
                         */
-                        xSemaphoreTake(bc_mutex_handle, portMAX_DELAY);
+                        bc_write_begin();
                         bc.last_relevant_onset_index_for_sync = (bc.most_recent_onset_index + 1) % ONSET_BUFFER_SIZE;
                         bc.there_is_an_onset = false;
-                        xSemaphoreGive(bc_mutex_handle);
+                        bc_write_end();
                         has_onset = false;
                         allow_onset = true;
                         display_gain = false;
@@ -388,13 +554,13 @@ void onset_adc_task(void *arg)
                         */
                         allow_onset = false;
                         display_gain = false;
-                        xSemaphoreTake(bc_mutex_handle, portMAX_DELAY);
+                        bc_write_begin();
                         bc.there_is_an_onset = has_onset;
-                        xSemaphoreGive(bc_mutex_handle);
+                        bc_write_end();
                         /*
-                        Notify sync to start evaluation
+                        Notify the tracking module to start evaluation
                         */
-                        xTaskNotify(sync_task_handle, SYNC_START_EVALUATION_NOTIFY, eSetValueWithOverwrite);
+                        xTaskNotify(tracking_task_handle, TRACKING_START_EVALUATION_NOTIFY, eSetValueWithOverwrite);
                         break;
                     case ONSET_ADC_START_DISPLAY_GAIN:
                         /*
@@ -535,16 +701,19 @@ void onset_adc_task(void *arg)
                                 /*
                                 Log onset (if allowed)
                                 */
-                                xSemaphoreTake(bc_mutex_handle, portMAX_DELAY);
-                                bc.most_recent_onset_index = (bc.most_recent_onset_index + 1) % ONSET_BUFFER_SIZE;
-                                uint32_t current_onset_index = bc.most_recent_onset_index;
-                                xSemaphoreGive(bc_mutex_handle);
-                                onsets[current_onset_index].time = current_time_us;
-                                onsets[current_onset_index].type = KICK;
+                                log_onset(current_time_us, KICK);
                             }
                             kick.last_onset_time = current_time_us;
                             has_onset = true;
                             /*
+                            Start the MIDI note (if enabled)
+                            */
+                            start_note(&notes_cfg, &kick, KICK, current_time_us);
+                            /*
+                            Count-in (if in TAP mode)
+                            */
+                            send_count_in_onset(current_time_us);
+                            /*
                             Blink led
                             */
                             blink_led(onset_led[KICK]);
@@ -564,22 +733,30 @@ void onset_adc_task(void *arg)
                                 /*
                                 Log onset (if allowed)
                                 */
-                                xSemaphoreTake(bc_mutex_handle, portMAX_DELAY);
-                                bc.most_recent_onset_index = (bc.most_recent_onset_index + 1) % ONSET_BUFFER_SIZE;
-                                uint32_t current_onset_index = bc.most_recent_onset_index;
-                                xSemaphoreGive(bc_mutex_handle);
-                                onsets[current_onset_index].time = current_time_us;
-                                onsets[current_onset_index].type = SNARE;
+                                log_onset(current_time_us, SNARE);
                             }
                             snare.last_onset_time = current_time_us;
                             has_onset = true;
                             /*
+                            Start the MIDI note (if enabled)
+                            */
+                            start_note(&notes_cfg, &snare, SNARE, current_time_us);
+                            /*
+                            Count-in (if in TAP mode)
+                            */
+                            send_count_in_onset(current_time_us);
+                            /*
                             Blink led
                             */
                             blink_led(onset_led[SNARE]);
                         }
                     }
                     /*
+                    Send the MIDI notes waiting for the velocity or for the note off
+                    */
+                    update_note(&notes_cfg, &kick, KICK, current_time_us);
+                    update_note(&notes_cfg, &snare, SNARE, current_time_us);
+                    /*
                     Update past sample index and update its index
                     */
                     kick.past_samples_current_onset_index = (kick.past_samples_current_onset_index + 1) % MAX_ONSET_DELTA_X_LENGTH;
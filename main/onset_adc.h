@@ -58,11 +58,11 @@ typedef enum
 /**
  * @brief Struct of the onset log entry.
  *
- * Struct of the onset log entry.
+ * Struct of the onset log entry (8 bytes).
  */
 typedef struct
 {
-    uint64_t time; /**< Absolute time of the onset */
+    bc_time_t time; /**< Time of the onset (relative to bc.time_epoch) */
     uint8_t type; /**< Type of onset: 0 for kick and 1 for snare */
 } onset_entry;
 
@@ -73,6 +73,16 @@ typedef struct
  */
 void onset_adc_init();
 
+/**
+ * @brief Finds the first onset logged at or after a given time.
+ *
+ * Binary search over the onsets logged from first_index to last_index (included, in ring order).
+ * The onsets are logged in time order, so the search takes O(log n) and needs no lock: the
+ * indexes have to be taken from a snapshot of bc. If all the onsets are older than time,
+ * last_index is returned.
+ */
+uint32_t onset_lower_bound(bc_time_t time, uint32_t first_index, uint32_t last_index);
+
 void turn_off_adc();
 
 void turn_on_adc();
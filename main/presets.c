@@ -0,0 +1,286 @@
+#include "presets.h"
+#include "hid.h"
+#include <stddef.h>
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_rom_crc.h"
+
+extern const hid_parameter_entry menu_item[MENU_ITEM_INDEX_LENGTH];
+
+_Static_assert(MENU_ITEM_INDEX_LENGTH <= PRESETS_MAX_VALUES, "PRESETS_MAX_VALUES is smaller than the menu");
+
+/**
+ * @brief NVS key of the slot selected
+ */
+#define PRESETS_ACTIVE_KEY "preset_active"
+
+/**
+ * @brief Value of a menu entry in the blob
+ */
+typedef struct
+{
+    uint32_t key; // CRC32 of the storage key of the entry
+    uint8_t percentage; // value of the entry
+} presets_value;
+
+/**
+ * @brief Blob of a slot (only the first count values are stored)
+ */
+typedef struct
+{
+    uint16_t version; // PRESETS_BLOB_VERSION
+    uint16_t count; // number of values
+    uint32_t crc; // CRC32 of the values
+    presets_value values[PRESETS_MAX_VALUES];
+} presets_blob;
+
+static nvs_handle_t presets_nvs_handle;
+static bool presets_nvs_open = false;
+static uint32_t presets_keys[MENU_ITEM_INDEX_LENGTH]; // hashes of the storage keys of the entries
+static uint8_t presets_shadow[PRESETS_SLOTS][MENU_ITEM_INDEX_LENGTH]; // values of the slots (RAM shadow)
+static bool presets_stored[PRESETS_SLOTS]; // the slot has been stored
+static uint8_t presets_active = 0; // slot selected
+static uint8_t presets_active_stored = 0; // slot selected in the NVS partition
+static presets_blob presets_buffer; // blob read or written (too big for the stack of the callers)
+
+/**
+ * @brief Writes the NVS key of the slot
+ */
+static void presets_slot_key(uint8_t slot, char *key)
+{
+    snprintf(key, NVS_KEY_NAME_MAX_SIZE, "preset_%u", slot);
+}
+
+/**
+ * @brief Returns the size of a blob with count values
+ */
+static size_t presets_blob_size(uint16_t count)
+{
+    return offsetof(presets_blob, values) + (count * sizeof(presets_value));
+}
+
+/**
+ * @brief Returns the CRC32 of the values of the blob
+ */
+static uint32_t presets_blob_crc(const presets_blob *blob)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)blob->values, blob->count * sizeof(presets_value));
+}
+
+/**
+ * @brief Reads the blob of the slot into the shadow (the entries not found keep their default value).
+ * Returns false if the slot is empty or if the blob is not valid.
+ */
+static bool presets_read_slot(uint8_t slot)
+{
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    presets_slot_key(slot, key);
+    size_t size = sizeof(presets_buffer);
+    esp_err_t err = nvs_get_blob(presets_nvs_handle, key, &presets_buffer, &size);
+    if (err != ESP_OK)
+    {
+        if (err != ESP_ERR_NVS_NOT_FOUND)
+        {
+            ESP_LOGW("presets", "Error (%s) reading %s", esp_err_to_name(err), key);
+        }
+        return false;
+    }
+    if (presets_buffer.version != PRESETS_BLOB_VERSION || presets_buffer.count > PRESETS_MAX_VALUES ||
+        size != presets_blob_size(presets_buffer.count) || presets_buffer.crc != presets_blob_crc(&presets_buffer))
+    {
+        ESP_LOGW("presets", "%s is not valid (version %u, %u values, %u bytes): ignored", key, presets_buffer.version, presets_buffer.count, size);
+        return false;
+    }
+    /*
+    Match the values to the entries by key
+    */
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+    {
+        presets_shadow[slot][i] = menu_item[i].default_percentage;
+        for (uint16_t v = 0; v < presets_buffer.count; v++)
+        {
+            if (presets_buffer.values[v].key == presets_keys[i] && presets_buffer.values[v].percentage <= 100)
+            {
+                presets_shadow[slot][i] = presets_buffer.values[v].percentage;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+void presets_init()
+{
+    /*
+    Check NVS status
+    */
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        /*
+        NVS partition was truncated and needs to be erased
+        Retry nvs_flash_init
+        */
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+    /*
+    The handle stays open: every save is a single blob and a single commit
+    */
+    err = nvs_open("storage", NVS_READWRITE, &presets_nvs_handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE("presets", "Error (%s) opening NVS handle!", esp_err_to_name(err));
+        return;
+    }
+    presets_nvs_open = true;
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+    {
+        presets_keys[i] = esp_rom_crc32_le(0, (const uint8_t *)menu_item[i].storage_key, strlen(menu_item[i].storage_key));
+    }
+    /*
+    Read all the slots into the shadow
+    */
+    for (uint8_t slot = 0; slot < PRESETS_SLOTS; slot++)
+    {
+        presets_stored[slot] = presets_read_slot(slot);
+        ESP_LOGI("presets", "Slot %u: %s", slot + 1, presets_stored[slot] ? "stored" : "empty");
+    }
+    uint8_t active;
+    if (nvs_get_u8(presets_nvs_handle, PRESETS_ACTIVE_KEY, &active) == ESP_OK && active < PRESETS_SLOTS)
+    {
+        presets_active = active;
+        presets_active_stored = active;
+    }
+}
+
+uint8_t presets_get_active()
+{
+    return presets_active;
+}
+
+bool presets_is_stored(uint8_t slot)
+{
+    return slot < PRESETS_SLOTS && presets_stored[slot];
+}
+
+bool presets_get(uint8_t slot, uint8_t *percentages)
+{
+    if (!presets_is_stored(slot))
+    {
+        return false;
+    }
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+    {
+        if (menu_item[i].has_corresponding_value)
+        {
+            percentages[i] = presets_shadow[slot][i];
+        }
+    }
+    return true;
+}
+
+bool presets_get_legacy(uint8_t *percentages)
+{
+    if (!presets_nvs_open)
+    {
+        return false;
+    }
+    bool found = false;
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+    {
+        if (menu_item[i].has_corresponding_value)
+        {
+            /*
+            The keys of the values stored one by one are padded with spaces to 15 characters
+            */
+            char key[NVS_KEY_NAME_MAX_SIZE];
+            uint8_t percentage;
+            snprintf(key, sizeof(key), "%-15s", menu_item[i].storage_key);
+            if (nvs_get_u8(presets_nvs_handle, key, &percentage) == ESP_OK && percentage <= 100)
+            {
+                percentages[i] = percentage;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Writes the slot selected if it differs from the stored one (without commit).
+ * Returns true if it has been written.
+ */
+static bool presets_write_active()
+{
+    if (presets_active == presets_active_stored || nvs_set_u8(presets_nvs_handle, PRESETS_ACTIVE_KEY, presets_active) != ESP_OK)
+    {
+        return false;
+    }
+    presets_active_stored = presets_active;
+    return true;
+}
+
+void presets_save(uint8_t slot, const uint8_t *percentages)
+{
+    if (slot >= PRESETS_SLOTS || !presets_nvs_open)
+    {
+        return;
+    }
+    presets_active = slot;
+    bool written = presets_write_active();
+    /*
+    Write the blob only if a value has changed
+    */
+    bool changed = !presets_stored[slot];
+    for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH && !changed; i++)
+    {
+        changed = menu_item[i].has_corresponding_value && percentages[i] != presets_shadow[slot][i];
+    }
+    if (changed)
+    {
+        memset(&presets_buffer, 0, sizeof(presets_buffer));
+        presets_buffer.version = PRESETS_BLOB_VERSION;
+        for (menu_item_index i = 0; i < MENU_ITEM_INDEX_LENGTH; i++)
+        {
+            if (menu_item[i].has_corresponding_value)
+            {
+                presets_buffer.values[presets_buffer.count].key = presets_keys[i];
+                presets_buffer.values[presets_buffer.count].percentage = percentages[i];
+                presets_buffer.count++;
+            }
+        }
+        presets_buffer.crc = presets_blob_crc(&presets_buffer);
+        char key[NVS_KEY_NAME_MAX_SIZE];
+        presets_slot_key(slot, key);
+        esp_err_t err = nvs_set_blob(presets_nvs_handle, key, &presets_buffer, presets_blob_size(presets_buffer.count));
+        if (err == ESP_OK)
+        {
+            memcpy(presets_shadow[slot], percentages, MENU_ITEM_INDEX_LENGTH);
+            presets_stored[slot] = true;
+            written = true;
+        }
+        else
+        {
+            ESP_LOGE("presets", "Error (%s) writing %s", esp_err_to_name(err), key);
+        }
+    }
+    if (written)
+    {
+        esp_err_t err = nvs_commit(presets_nvs_handle);
+        ESP_LOGI("presets", "Slot %u saved: %s", slot + 1, (err != ESP_OK) ? "Failed!" : "Done");
+    }
+    else
+    {
+        ESP_LOGI("presets", "Slot %u unchanged", slot + 1);
+    }
+}
+
+void presets_set_active(uint8_t slot)
+{
+    if (slot < PRESETS_SLOTS)
+    {
+        presets_active = slot;
+    }
+}
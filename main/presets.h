@@ -0,0 +1,81 @@
+/**
+ * @file presets.h
+ * @brief PRESETS module keeps the values of the menu in the NVS partition, in PRESETS_SLOTS slots
+ * (e.g. one per song or per drum kit).
+ * Every slot is stored as a single blob (one nvs_set_blob and one commit for the whole set of values):
+ * - a header with the version of the format, the number of values and the CRC32 of the values
+ * - the values, each one with the hash of its storage key: the values are matched to the menu entries by
+ *   key, so a firmware that adds or removes entries still loads the others
+ * A blob with a different version, a wrong length or a wrong CRC is ignored (the slot is empty).
+ * At boot the NVS partition is initialized and opened once and all the slots are read into a RAM shadow:
+ * switching preset is a copy from RAM, and a slot is written only if its values have changed
+ * (saving the same values again does not wear the flash). The slot selected is kept in RAM and
+ * stored only by presets_save (SAVE VALUES), as the song selected of the setlist.
+ * If the slot selected has not been stored yet, the values stored one by one by the older firmwares
+ * are loaded (and saved into the slot at the next save).
+ */
+
+#ifndef BC_PRESETS_H
+#define BC_PRESETS_H
+
+#include "main_defs.h"
+
+/**
+ * @brief Number of preset slots
+ */
+#define PRESETS_SLOTS 4
+
+/**
+ * @brief Encoder step of the preset entry of the menu (one slot per step)
+ */
+#define PRESETS_MENU_STEP ((100 + PRESETS_SLOTS - 2) / (PRESETS_SLOTS - 1))
+
+/**
+ * @brief Version of the format of the blob (a blob of another version is ignored)
+ */
+#define PRESETS_BLOB_VERSION 1
+
+/**
+ * @brief Max number of values in a blob
+ */
+#define PRESETS_MAX_VALUES 64
+
+/**
+ * @brief Initializes the NVS partition and reads all the slots into the RAM shadow
+ */
+void presets_init();
+
+/**
+ * @brief Returns the slot selected (read from the NVS partition at boot)
+ */
+uint8_t presets_get_active();
+
+/**
+ * @brief Returns true if the slot has been stored
+ */
+bool presets_is_stored(uint8_t slot);
+
+/**
+ * @brief Copies the percentages of the slot (from the RAM shadow) into the ones of the stored menu entries.
+ * Returns false (and leaves the percentages untouched) if the slot is empty.
+ */
+bool presets_get(uint8_t slot, uint8_t *percentages);
+
+/**
+ * @brief Loads the values stored one by one by the older firmwares into the percentages (the ones
+ * found). Returns false if none has been found.
+ */
+bool presets_get_legacy(uint8_t *percentages);
+
+/**
+ * @brief Stores the percentages of the stored menu entries in the slot and selects it.
+ * The flash is written only if the values (or the slot selected) have changed.
+ */
+void presets_save(uint8_t slot, const uint8_t *percentages);
+
+/**
+ * @brief Selects the slot (in RAM only: the selection is stored at the next presets_save)
+ */
+void presets_set_active(uint8_t slot);
+
+#endif
@@ -0,0 +1,173 @@
+#include "setlist.h"
+#include <stddef.h>
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_rom_crc.h"
+
+/**
+ * @{ \name NVS keys of the setlist and of the song selected
+ */
+#define SETLIST_KEY "setlist"
+#define SETLIST_CURRENT_KEY "setlist_song"
+/**
+ * @}
+ */
+
+/**
+ * @brief Blob of the setlist
+ */
+typedef struct
+{
+    uint16_t version; // SETLIST_BLOB_VERSION
+    uint16_t count; // number of songs
+    uint32_t crc; // CRC32 of the songs
+    setlist_song songs[SETLIST_MAX_SONGS];
+} setlist_blob;
+
+setlist_song setlist_edit = {SETLIST_DEFAULT_BPM, SETLIST_DEFAULT_METER, 0};
+uint16_t setlist_range = 8;
+
+static nvs_handle_t setlist_nvs_handle;
+static bool setlist_nvs_open = false;
+static setlist_song setlist_songs[SETLIST_MAX_SONGS]; // songs (RAM)
+static setlist_song setlist_stored[SETLIST_MAX_SONGS]; // songs as stored (RAM shadow)
+static uint8_t setlist_current = 0; // song selected (0: off)
+static uint8_t setlist_current_stored = 0; // song selected as stored
+static portMUX_TYPE setlist_spinlock = portMUX_INITIALIZER_UNLOCKED; // the song is read by tap_task
+
+/**
+ * @brief Returns the CRC32 of the songs of the blob
+ */
+static uint32_t setlist_blob_crc(const setlist_blob *blob)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)blob->songs, blob->count * sizeof(setlist_song));
+}
+
+/**
+ * @brief Returns true if the song can be used (tempo and meter not zero)
+ */
+static bool setlist_song_is_valid(const setlist_song *song)
+{
+    return song->bpm > 0 && song->meter > 0;
+}
+
+void setlist_init()
+{
+    for (uint8_t s = 0; s < SETLIST_MAX_SONGS; s++)
+    {
+        setlist_songs[s] = (setlist_song){SETLIST_DEFAULT_BPM, SETLIST_DEFAULT_METER, 0};
+    }
+    /*
+    The handle stays open: the setlist is a single blob and a single commit
+    */
+    esp_err_t err = nvs_open("storage", NVS_READWRITE, &setlist_nvs_handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE("setlist", "Error (%s) opening NVS handle!", esp_err_to_name(err));
+        memcpy(setlist_stored, setlist_songs, sizeof(setlist_stored));
+        return;
+    }
+    setlist_nvs_open = true;
+    setlist_blob blob;
+    size_t size = sizeof(blob);
+    err = nvs_get_blob(setlist_nvs_handle, SETLIST_KEY, &blob, &size);
+    if (err == ESP_OK && blob.version == SETLIST_BLOB_VERSION && blob.count <= SETLIST_MAX_SONGS &&
+        size == offsetof(setlist_blob, songs) + (blob.count * sizeof(setlist_song)) && blob.crc == setlist_blob_crc(&blob))
+    {
+        for (uint16_t s = 0; s < blob.count; s++)
+        {
+            if (setlist_song_is_valid(&blob.songs[s]))
+            {
+                setlist_songs[s] = blob.songs[s];
+            }
+        }
+    }
+    else if (err != ESP_ERR_NVS_NOT_FOUND)
+    {
+        ESP_LOGW("setlist", "Setlist not valid (%s): ignored", esp_err_to_name(err));
+    }
+    memcpy(setlist_stored, setlist_songs, sizeof(setlist_stored));
+    uint8_t current;
+    if (nvs_get_u8(setlist_nvs_handle, SETLIST_CURRENT_KEY, &current) == ESP_OK && current <= SETLIST_MAX_SONGS)
+    {
+        setlist_current_stored = current;
+    }
+    setlist_select(setlist_current_stored);
+}
+
+uint8_t setlist_get_current()
+{
+    return setlist_current;
+}
+
+bool setlist_get_current_song(setlist_song *song)
+{
+    portENTER_CRITICAL(&setlist_spinlock);
+    bool selected = setlist_current > 0;
+    if (selected)
+    {
+        *song = setlist_songs[setlist_current - 1];
+    }
+    portEXIT_CRITICAL(&setlist_spinlock);
+    return selected;
+}
+
+void setlist_select(uint8_t song)
+{
+    if (song > SETLIST_MAX_SONGS)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&setlist_spinlock);
+    setlist_current = song;
+    if (song > 0)
+    {
+        setlist_edit = setlist_songs[song - 1];
+    }
+    portEXIT_CRITICAL(&setlist_spinlock);
+}
+
+void setlist_update()
+{
+    portENTER_CRITICAL(&setlist_spinlock);
+    if (setlist_current > 0)
+    {
+        setlist_songs[setlist_current - 1] = setlist_edit;
+    }
+    portEXIT_CRITICAL(&setlist_spinlock);
+}
+
+void setlist_save()
+{
+    if (!setlist_nvs_open)
+    {
+        return;
+    }
+    bool written = false;
+    if (memcmp(setlist_songs, setlist_stored, sizeof(setlist_songs)) != 0)
+    {
+        setlist_blob blob = {.version = SETLIST_BLOB_VERSION, .count = SETLIST_MAX_SONGS};
+        memcpy(blob.songs, setlist_songs, sizeof(blob.songs));
+        blob.crc = setlist_blob_crc(&blob);
+        esp_err_t err = nvs_set_blob(setlist_nvs_handle, SETLIST_KEY, &blob, sizeof(blob));
+        if (err == ESP_OK)
+        {
+            memcpy(setlist_stored, setlist_songs, sizeof(setlist_stored));
+            written = true;
+        }
+        else
+        {
+            ESP_LOGE("setlist", "Error (%s) writing the setlist", esp_err_to_name(err));
+        }
+    }
+    if (setlist_current != setlist_current_stored && nvs_set_u8(setlist_nvs_handle, SETLIST_CURRENT_KEY, setlist_current) == ESP_OK)
+    {
+        setlist_current_stored = setlist_current;
+        written = true;
+    }
+    if (written)
+    {
+        esp_err_t err = nvs_commit(setlist_nvs_handle);
+        ESP_LOGI("setlist", "Setlist saved: %s", (err != ESP_OK) ? "Failed!" : "Done");
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file setlist.h
+ * @brief SETLIST module keeps an ordered list of SETLIST_MAX_SONGS songs, each one with its nominal
+ * tempo, its meter and the preset of its parameters (presets.h).
+ * A song is selected from the menu (SETLIST Song) or with the encoder in TAP mode; song 0 turns the setlist off.
+ * When a song is selected:
+ * - its preset is selected and the tempo of the tracking is preloaded from the nominal one
+ * - the tap tempo only needs the phase: two hits are enough and the period is constrained to the
+ *   nominal one within the tolerance of the menu (SETLIST Range, see tap_tempo_prior in tap_tempo.h)
+ * - the count-in bar has the beats of the meter and only the periods near the nominal one are candidates
+ * The songs are stored in the NVS partition as a single blob (version, number of songs, CRC32 of the songs),
+ * written only if they have changed, together with the song selected.
+ */
+
+#ifndef BC_SETLIST_H
+#define BC_SETLIST_H
+
+#include "main_defs.h"
+#include "presets.h"
+
+/**
+ * @brief Number of songs of the setlist
+ */
+#define SETLIST_MAX_SONGS 8
+
+/**
+ * @brief Encoder step of the song entry of the menu (one song per step)
+ */
+#define SETLIST_MENU_STEP ((100 + SETLIST_MAX_SONGS - 1) / SETLIST_MAX_SONGS)
+
+/**
+ * @brief Encoder step of the preset entry of the song (one slot per step, 0 keeps the current values)
+ */
+#define SETLIST_PRESET_MENU_STEP ((100 + PRESETS_SLOTS - 1) / PRESETS_SLOTS)
+
+/**
+ * @brief Version of the format of the blob (a blob of another version is ignored)
+ */
+#define SETLIST_BLOB_VERSION 1
+
+/**
+ * @{ \name Values of a song that has not been edited
+ */
+#define SETLIST_DEFAULT_BPM 120
+#define SETLIST_DEFAULT_METER 4
+/**
+ * @}
+ */
+
+/**
+ * @brief Song of the setlist (the fields are the variables of the SETLIST entries of the menu)
+ */
+typedef struct
+{
+    uint16_t bpm; /**< Nominal tempo */
+    uint16_t meter; /**< Beats of the bar (the count-in bar) */
+    uint16_t preset; /**< Slot of the preset + 1 (0 keeps the current values) */
+} setlist_song;
+
+/**
+ * @brief Song selected, edited by the menu (changes are copied into the setlist with setlist_update)
+ */
+extern setlist_song setlist_edit;
+
+/**
+ * @brief Tolerance around the nominal tempo of the song (%, SETLIST Range menu entry)
+ */
+extern uint16_t setlist_range;
+
+/**
+ * @brief Reads the setlist and the song selected from the NVS partition (after presets_init, that
+ * initializes the partition)
+ */
+void setlist_init();
+
+/**
+ * @brief Returns the song selected (0 if the setlist is off)
+ */
+uint8_t setlist_get_current();
+
+/**
+ * @brief Copies the song selected into song. Returns false if the setlist is off.
+ */
+bool setlist_get_current_song(setlist_song *song);
+
+/**
+ * @brief Selects the song (0 turns the setlist off) and copies it into setlist_edit
+ */
+void setlist_select(uint8_t song);
+
+/**
+ * @brief Copies setlist_edit into the song selected (nothing if the setlist is off)
+ */
+void setlist_update();
+
+/**
+ * @brief Stores the setlist and the song selected in the NVS partition (only if they have changed)
+ */
+void setlist_save();
+
+#endif
@@ -2,15 +2,16 @@
  * @file sync.h
  * @brief SYNC module evaluates the need of a sincronization of the midi clock.
  * For every onset, the sync module calculates the distance from the expected and evaluates the
- * need for a sincronization. If this is the case, the module sends a message to the clock module
- * asking to set delta_tau_sync value.
- * The module starts its job when notified by the onset_adc module.
+ * need for a sincronization. If this is the case, the module returns the delta_tau_sync value
+ * that the tracking module sends to the clock.
+ * The evaluation is run by the tracking module (tracking.h) once every 8th.
  */
 
 #ifndef BC_SYNC_H
 #define BC_SYNC_H
 
 #include "main_defs.h"
+#include "tracking.h"
 
 /**
  * @brief Headroom value suggested for the B-Keeper algorithm
@@ -18,22 +19,20 @@
 #define HEADROOM_VALUE_SYNC 0.1
 
 /**
- * @brief Notify codes for sync_task.
+ * @brief Evaluates the onsets of the current window.
+ * Returns true (and sets delta_tau_sync) if the clock has to be synced.
  */
-typedef enum
-{
-    SYNC_START_EVALUATION_NOTIFY,
-    SYNC_RESET_PARAMETERS,
-} sync_task_notify_code;
+bool sync_evaluate(const tracking_snapshot *snapshot, long long *delta_tau_sync);
 
 /**
- * @brief Handle of the sync_task.
+ * @brief Resets the parameters of the algorithm for a new sequence with the given tau.
+ * The window (sigma_sync) is at least TRACKING_START_SPREAD_SIGMAS times the spread of the start taps.
  */
-extern TaskHandle_t sync_task_handle;
+void sync_reset(uint32_t tau, uint32_t spread);
 
 /**
  * @brief Init function for the sync module
- * The function sets parameters and starts sync_task
+ * The function adds the parameters to the menu
  */
 void sync_init();
 
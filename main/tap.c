@@ -1,12 +1,17 @@
 #include "main_defs.h"
 #include "tap.h"
+#include "bc_seqlock.h"
 #include "clock.h"
-#include "sync.h"
 #include "driver/gpio.h"
 #include "esp_sleep.h"
-#include "tempo.h"
+#include "tracking.h"
 #include "hid.h"
 #include "mode_switch.h"
+#include "clock_in.h"
+#include "count_in.h"
+#include "tap_tempo.h"
+#include "setlist.h"
+#include <sys/param.h>
 
 /**
  * @brief Timeout for going to sleep when waiting for hit
@@ -15,14 +20,16 @@
 
 extern QueueHandle_t clock_task_queue;
 extern TaskHandle_t clock_task_handle;
-extern TaskHandle_t sync_task_handle;
-extern TaskHandle_t tempo_task_handle;
+extern TaskHandle_t tracking_task_handle;
 extern main_runtime_vrbs bc;
 extern volatile main_mode mode;
-extern SemaphoreHandle_t bc_mutex_handle; // mutex for the access to bc struct
+extern uint16_t clock_in_source;
+extern void set_menu_item_pointer_to_vrb(menu_item_index index, void *ptr);
 
 QueueHandle_t tap_task_queue = NULL;
 TaskHandle_t tap_task_handle = NULL;
+bool tap_count_in = false;
+uint16_t tap_taps = 4;
 
 clock_task_queue_entry clock_tx_buffer;
 
@@ -70,6 +77,61 @@ static void IRAM_ATTR tap_tempo_isr_handler(void *args)
     }
 }
 
+/**
+ * @brief Starts the sequence from the estimate of tempo and phase
+ * The sequence begins on the beat of the first hit, the first beat to play is the one after the last hit.
+ * The spread of the hits opens the windows of the tracking at the start of the sequence.
+*/
+static void tap_start(const tap_tempo_result *estimate)
+{
+    uint64_t period = estimate->period;
+    uint64_t first_beat = estimate->next_beat;
+    ESP_LOGI("TAP", "period %llu us, spread %lu us, %u hits used, confidence %.2f", period, estimate->spread, estimate->used, estimate->confidence);
+    /*
+    Notify the mode_switch_task to go in PLAY mode
+    */
+    xTaskNotify(mode_switch_task_handle, MODE_SWITCH_TO_PLAY, eSetValueWithOverwrite);
+    bc_write_begin();
+    bc.time_epoch = estimate->first_beat; // the sequence starts from the first hit
+    bc.tau = period / 2;     // 8th note
+    bc.expected_beat = BC_TIME_FROM_US(bc, first_beat);
+    bc_write_end();
+    /*
+    Notify the new bpm (and how much it can be trusted) to the tracking module
+    */
+    tracking_start_spread = estimate->spread;
+    xTaskNotify(tracking_task_handle, TRACKING_RESET_PARAMETERS, eSetValueWithOverwrite);
+    /*
+    Reset the clock queue, ask to start sequence and resume its task
+    */
+    xQueueReset(clock_task_queue);
+    clock_tx_buffer.type = CLOCK_QUEUE_START;
+    clock_tx_buffer.value = first_beat,
+    clock_tx_buffer.value_tempo = -1; // the clock chooses the song position
+    xQueueSend(clock_task_queue, &clock_tx_buffer, (TickType_t)0);
+    vTaskResume(clock_task_handle);
+}
+
+/**
+ * @brief Reads the song selected in the setlist: with a song, the count-in bar has the beats of its meter
+ * and the tempo is constrained around its nominal one (prior).
+ * Returns true if a song is selected.
+*/
+static bool tap_configure(count_in *count_in_onsets, tap_tempo_prior *prior)
+{
+    setlist_song song;
+    bool has_song = setlist_get_current_song(&song);
+    *prior = (tap_tempo_prior){0};
+    if (has_song)
+    {
+        prior->period = 60000000 / song.bpm;
+        prior->tolerance = setlist_range / 100.0;
+        ESP_LOGI("TAP", "song %u: period %llu us (+-%u%%), %u beats", setlist_get_current(), prior->period, setlist_range, song.meter);
+    }
+    count_in_configure(count_in_onsets, has_song ? song.meter : COUNT_IN_BEATS, has_song ? prior : NULL);
+    return has_song;
+}
+
 /**
  * @brief Main task of the Tap module
 */
@@ -78,14 +140,19 @@ static void tap_task(void *arg)
     /*
     Initialize parameters
     */
-    uint64_t tap_tempo_onsets[4] = {0};
+    uint64_t tap_tempo_onsets[TAP_TEMPO_MAX_TAPS] = {0};
     uint64_t tap_task_queue_result = 0;
     uint8_t counter = 0;
     uint64_t time_of_last_hit = 0;
+    count_in count_in_onsets;
+    count_in_result count_in_found = {0};
+    bool count_in_complete = false;
+    tap_tempo_prior prior;
+    bool has_song = tap_configure(&count_in_onsets, &prior);
     /*
-    Create queue
+    Create queue (the onsets of the count-in can come in bursts)
     */
-    tap_task_queue = xQueueCreate(2, sizeof(tap_tempo_onsets[0]));
+    tap_task_queue = xQueueCreate(8, sizeof(tap_tempo_onsets[0]));
 
     while (1)
     {
@@ -97,11 +164,28 @@ static void tap_task(void *arg)
             if (tap_task_queue_result == TAP_TASK_QUEUE_RESET_COUNTER)
             {
                 /*
-                If the message ask to reset counter:
+                If the message ask to reset counter (read the song selected again):
                 */
                 counter = 0;
+                has_song = tap_configure(&count_in_onsets, &prior);
+            }
+            else if (tap_task_queue_result & TAP_TASK_QUEUE_ONSET)
+            {
+                /*
+                If there is an onset, run the tempo induction of the count-in
+                (ignored while following an external clock)
+                */
+                if (clock_in_source == CLOCK_IN_SOURCE_INTERNAL)
+                {
+                    count_in_complete = count_in_add(&count_in_onsets, tap_task_queue_result & ~TAP_TASK_QUEUE_ONSET, &count_in_found);
+                    /*
+                    Ask hid module to display the beats of the count-in found so far
+                    */
+                    int msg_to_hid = HID_TAP_0 + count_in_found.beats;
+                    xQueueSend(hid_task_queue, &msg_to_hid, (TickType_t)0);
+                }
             }
-            else
+            else if (counter < TAP_TEMPO_MAX_TAPS)
             {
                 /*
                 If there is a hit, log it into the array and increase the counter
@@ -119,40 +203,36 @@ static void tap_task(void *arg)
             */
             time_of_last_hit = esp_timer_get_time();
         }
-        if (counter == 4)
+        uint8_t taps_needed = has_song ? TAP_TEMPO_PRIOR_TAPS : MIN(MAX(tap_taps, TAP_TEMPO_MIN_TAPS), TAP_TEMPO_MAX_TAPS);
+        tap_tempo_result tap_estimate;
+        if (count_in_complete)
         {
             /*
-            If it is the last hit:
-            Notify the mode_switch_task to go in PLAY mode
-            */
-            xTaskNotify(mode_switch_task_handle, MODE_SWITCH_TO_PLAY, eSetValueWithOverwrite);
-            /*
-            Calculate bpm
+            The count-in bar has been played on the pads: start on the downbeat that follows it
             */
-            uint64_t tap_period = 0;
-            for (int i = 0; i < 3; i++)
-            {
-                tap_period += tap_tempo_onsets[i + 1] - tap_tempo_onsets[i];
-            }
-            tap_period = tap_period / 3; // 4th note
-            xSemaphoreTake(bc_mutex_handle, portMAX_DELAY);
-            bc.tau = tap_period / 2;     // 8th note
-            bc.expected_beat = tap_tempo_onsets[3] + tap_period;
-            xSemaphoreGive(bc_mutex_handle);
+            tap_start(&count_in_found.estimate);
+        }
+        else if (counter >= taps_needed && !tap_tempo_estimate(tap_tempo_onsets, counter, has_song ? &prior : NULL, &tap_estimate))
+        {
             /*
-            Notify the new bpm to sync and tempo modules
+            The hits cannot give a tempo (all on the same beat): start counting again
             */
-            xTaskNotify(sync_task_handle, SYNC_RESET_PARAMETERS, eSetValueWithOverwrite);
-            xTaskNotify(tempo_task_handle, TEMPO_RESET_PARAMETERS, eSetValueWithOverwrite);
+            counter = 0;
+            int msg_to_hid = HID_TAP_0;
+            xQueueSend(hid_task_queue, &msg_to_hid, (TickType_t)0);
+        }
+        else if (counter >= taps_needed)
+        {
             /*
-            Reset the clock queue, ask to start sequence and resume its task
+            If it is the last hit: estimate bpm and phase from the hits
             */
-            xQueueReset(clock_task_queue);
-            clock_tx_buffer.type = CLOCK_QUEUE_START;
-            clock_tx_buffer.value = bc.expected_beat,
-            xQueueSend(clock_task_queue, &clock_tx_buffer, (TickType_t)0);
-            vTaskResume(clock_task_handle);
+            tap_start(&tap_estimate);
+        }
+        if (counter >= taps_needed || count_in_complete)
+        {
             counter = 0;
+            count_in_complete = false;
+            count_in_reset(&count_in_onsets);
             /*
             Suspend until next tap mode is selected
             */
@@ -165,7 +245,7 @@ static void tap_task(void *arg)
                 /*
                 If there is no hit until timeout time:
                 */
-                if(mode == MODE_TAP){
+                if(mode == MODE_TAP && clock_in_source == CLOCK_IN_SOURCE_INTERNAL){
                     counter = 0;
                     /*
                     Ask mode switch module to go to sleep
@@ -201,6 +281,11 @@ void tap_init()
     gpio_set_intr_type(TAP_TEMPO_PIN, GPIO_INTR_NEGEDGE);
     gpio_isr_handler_add(TAP_TEMPO_PIN, tap_tempo_isr_handler, NULL);
     /*
+    Add the count-in to the menu
+    */
+    set_menu_item_pointer_to_vrb(MENU_INDEX_TAP_COUNT_IN, &tap_count_in);
+    set_menu_item_pointer_to_vrb(MENU_INDEX_TAP_TAPS, &tap_taps);
+    /*
     Create tap_task 
     */
     xTaskCreate(tap_task, "Tap_Task", TAP_TASK_STACK_SIZE, NULL, TAP_TASK_PRIORITY, &tap_task_handle);
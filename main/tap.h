@@ -3,7 +3,12 @@
  * @brief Tap module let the user insert the initial bpm by pressing on the tap button on time.
  * Every time the user presses the button, an interrupt routine send a message to the queue 
  * of the main task with information about the timing and the task keeps track of how many hits has been received.
- * If there are 4 hits, the task calculates the bpm average and starts the clock module.
+ * When the hits set in the menu (TAP Taps) are received, the task estimates bpm and phase from them
+ * (tap_tempo.h, with outlier rejection) and starts the clock module.
+ * If TAP Count-in is set, the onsets of the drums (sent by onset_adc) can start the clock as well:
+ * the count-in module (count_in.h) finds tempo and downbeat from a count-in bar played on the pads.
+ * If a song of the setlist is selected (setlist.h), its nominal tempo is known: two hits are enough
+ * (they give the phase) and the tempo of the hits and of the count-in is kept near the nominal one.
  * If there are no hits before the timeout, the tap ask to switch to sleep mode.
  */
 
@@ -24,6 +29,11 @@
  */
 #define TAP_TASK_QUEUE_RESET_COUNTER 0
 
+/**
+ * @brief Flag of the messages to the queue that carry the time of an onset (not of a hit of the button)
+ */
+#define TAP_TASK_QUEUE_ONSET (1ULL << 63)
+
 /**
  * @brief Debounce value for tap button in us
  */
@@ -33,7 +43,8 @@
  * @brief Queue to send msgs to the tap module.
  *
  * Queue to send msgs to the tap module. If the message is TAP_TASK_QUEUE_RESET_COUNTER, the task
- * resets its internal counter. Otherwise it will interpret it as an absolute value of time for an hit.
+ * resets its internal counter. If the TAP_TASK_QUEUE_ONSET flag is set, the rest of the message
+ * is the absolute time of an onset of the count-in. Otherwise it will interpret it as an absolute value of time for an hit.
  */
 extern QueueHandle_t tap_task_queue;
 
@@ -44,6 +55,11 @@ extern QueueHandle_t tap_task_queue;
  */
 extern TaskHandle_t tap_task_handle;
 
+/**
+ * @brief True if the onsets can start the clock (TAP Count-in menu entry)
+ */
+extern bool tap_count_in;
+
 /**
  * @brief Init function to be called from the main.
  */
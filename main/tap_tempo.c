@@ -0,0 +1,162 @@
+#include "tap_tempo.h"
+#include <math.h>
+
+/**
+ * @brief Returns the median of the values (sorts them)
+ */
+static double tap_tempo_median(double *values, uint8_t length)
+{
+    for (uint8_t i = 1; i < length; i++)
+    {
+        double value = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > value)
+        {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = value;
+    }
+    return (length % 2) ? values[length / 2] : (values[(length / 2) - 1] + values[length / 2]) / 2;
+}
+
+/**
+ * @brief Least-squares line through the taps kept: time = first_beat + beat * period.
+ * With a prior, the period is kept within its tolerance (the nominal one if the taps are all on the
+ * same beat) and the line is the best one with that period.
+ * Returns false if the taps kept are all on the same beat and there is no prior.
+ */
+static bool tap_tempo_fit(const double *times, const double *beats, const bool *kept, uint8_t count, const tap_tempo_prior *prior, double *first_beat, double *period)
+{
+    double n = 0;
+    double mean_beat = 0;
+    double mean_time = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (kept[i])
+        {
+            n++;
+            mean_beat += beats[i];
+            mean_time += times[i];
+        }
+    }
+    mean_beat /= n;
+    mean_time /= n;
+    double numerator = 0;
+    double denominator = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (kept[i])
+        {
+            numerator += (beats[i] - mean_beat) * (times[i] - mean_time);
+            denominator += (beats[i] - mean_beat) * (beats[i] - mean_beat);
+        }
+    }
+    if (denominator == 0 && prior == NULL)
+    {
+        return false;
+    }
+    *period = (denominator == 0) ? (double)prior->period : numerator / denominator;
+    if (prior != NULL)
+    {
+        *period = fmin(fmax(*period, prior->period * (1 - prior->tolerance)), prior->period * (1 + prior->tolerance));
+    }
+    *first_beat = mean_time - (*period * mean_beat);
+    return true;
+}
+
+bool tap_tempo_estimate(const uint64_t *taps, uint8_t count, const tap_tempo_prior *prior, tap_tempo_result *result)
+{
+    if (prior != NULL && prior->period == 0)
+    {
+        prior = NULL;
+    }
+    if (count < (prior != NULL ? 1 : 2) || count > TAP_TEMPO_MAX_TAPS)
+    {
+        return false;
+    }
+    /*
+    Times relative to the first tap (precision of the doubles) and median of the intervals
+    (the nominal period if there is a prior)
+    */
+    double times[TAP_TEMPO_MAX_TAPS];
+    double intervals[TAP_TEMPO_MAX_TAPS];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        times[i] = (double)(taps[i] - taps[0]);
+        if (i > 0)
+        {
+            intervals[i - 1] = times[i] - times[i - 1];
+        }
+    }
+    double median = (prior != NULL) ? (double)prior->period : tap_tempo_median(intervals, count - 1);
+    /*
+    Beat of every tap: a missed tap counts as two beats, a double tap (less than half a beat)
+    stays on the same beat and is not used
+    */
+    double beats[TAP_TEMPO_MAX_TAPS];
+    bool kept[TAP_TEMPO_MAX_TAPS];
+    uint8_t used = count;
+    beats[0] = 0;
+    kept[0] = true;
+    for (uint8_t i = 1; i < count; i++)
+    {
+        double step = round((times[i] - times[i - 1]) / median);
+        beats[i] = beats[i - 1] + step;
+        kept[i] = step > 0;
+        if (!kept[i])
+        {
+            used--;
+        }
+    }
+    double first_beat = 0;
+    double period = median;
+    if (!tap_tempo_fit(times, beats, kept, count, prior, &first_beat, &period))
+    {
+        return false;
+    }
+    /*
+    Reject the worst tap while it is an outlier
+    */
+    while (used > TAP_TEMPO_MIN_TAPS)
+    {
+        int worst = -1;
+        double worst_residual = 0;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            double residual = fabs(times[i] - (first_beat + (period * beats[i])));
+            if (kept[i] && residual > worst_residual)
+            {
+                worst = i;
+                worst_residual = residual;
+            }
+        }
+        if (worst < 0 || worst_residual <= period * TAP_TEMPO_OUTLIER)
+        {
+            break;
+        }
+        kept[worst] = false;
+        used--;
+        tap_tempo_fit(times, beats, kept, count, prior, &first_beat, &period);
+    }
+    /*
+    Spread of the taps kept around the line (two parameters fitted)
+    */
+    double squares = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (kept[i])
+        {
+            double residual = times[i] - (first_beat + (period * beats[i]));
+            squares += residual * residual;
+        }
+    }
+    double spread = used > 2 ? sqrt(squares / (used - 2)) : 0;
+    result->period = (uint64_t)llround(period);
+    result->first_beat = taps[0] + (int64_t)llround(first_beat);
+    result->next_beat = taps[0] + (int64_t)llround(first_beat + (period * (beats[count - 1] + 1)));
+    result->spread = (uint32_t)llround(spread);
+    result->confidence = fmax(0, 1 - (spread / (period * TAP_TEMPO_CONFIDENCE_SPREAD))) * used / count;
+    result->used = used;
+    return true;
+}
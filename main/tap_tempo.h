@@ -0,0 +1,78 @@
+/**
+ * @file tap_tempo.h
+ * @brief TAP TEMPO estimates tempo and phase from a set of taps (or count-in beats).
+ * Every tap gets a beat number from the median of the inter-tap intervals (a missed tap counts as
+ * two beats), then a least-squares line (time = first_beat + beat * period) is fitted through them.
+ * The tap farthest from the line is rejected while it is farther than TAP_TEMPO_OUTLIER of the
+ * period (at least TAP_TEMPO_MIN_TAPS taps are kept), so one sloppy tap does not skew the tempo.
+ * The spread of the taps around the line (standard deviation of the residuals) tells how much the
+ * estimate can be trusted: it is reported as a confidence (that also drops with the taps rejected)
+ * and it is used by the tracking module to open its windows at the start of the sequence.
+ * If the tempo is known in advance (a song of the setlist, see setlist.h) the estimate takes it as a
+ * prior: the taps get their beat numbers from the nominal period and the fitted period is kept within
+ * the tolerance of the nominal one, so a single tap is enough to give the phase.
+ * The module only uses plain C so that it can be compiled on the host.
+ */
+
+#ifndef BC_TAP_TEMPO_H
+#define BC_TAP_TEMPO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Max number of taps of an estimate
+ */
+#define TAP_TEMPO_MAX_TAPS 8
+
+/**
+ * @brief Min number of taps kept by the outlier rejection
+ */
+#define TAP_TEMPO_MIN_TAPS 3
+
+/**
+ * @brief Number of taps asked when the tempo is known in advance (the taps only give the phase)
+ */
+#define TAP_TEMPO_PRIOR_TAPS 2
+
+/**
+ * @brief A tap farther than this from the fitted line (fraction of the period) is an outlier
+ */
+#define TAP_TEMPO_OUTLIER 0.08
+
+/**
+ * @brief Spread of the taps (fraction of the period) at which the confidence is 0
+ */
+#define TAP_TEMPO_CONFIDENCE_SPREAD 0.1
+
+/**
+ * @brief Tempo known in advance
+ */
+typedef struct
+{
+    uint64_t period; /**< Nominal beat period (us) */
+    double tolerance; /**< Max distance of the estimated period from the nominal one (fraction of it) */
+} tap_tempo_prior;
+
+/**
+ * @brief Result of the estimate
+ */
+typedef struct
+{
+    uint64_t period; /**< Beat period (us) */
+    uint64_t first_beat; /**< Fitted time of the beat of the first tap (us) */
+    uint64_t next_beat; /**< Fitted time of the beat after the last tap (us) */
+    uint32_t spread; /**< Standard deviation of the taps kept around the fitted line (us) */
+    double confidence; /**< 1 for perfect taps, 0 for a spread of TAP_TEMPO_CONFIDENCE_SPREAD of the period or more (times the fraction of taps kept) */
+    uint8_t used; /**< Number of taps kept */
+} tap_tempo_result;
+
+/**
+ * @brief Estimates tempo and phase from count taps (us, in time order, at most TAP_TEMPO_MAX_TAPS).
+ * prior is the tempo known in advance (NULL if unknown).
+ * Returns false if there are less than two taps (one with a prior).
+ */
+bool tap_tempo_estimate(const uint64_t *taps, uint8_t count, const tap_tempo_prior *prior, tap_tempo_result *result);
+
+#endif
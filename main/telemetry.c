@@ -0,0 +1,240 @@
+#include "telemetry.h"
+#include "hid.h"
+#include "display.h"
+#include "bc_seqlock.h"
+#include "esp_rom_crc.h"
+#include <sys/param.h>
+
+// #define TELEMETRY_STREAM // Uncomment to write the reports on the console as binary frames
+
+/**
+ * @brief Max number of tasks of the system read with uxTaskGetSystemState
+ */
+#define TELEMETRY_MAX_SYSTEM_TASKS 24
+
+extern TaskHandle_t clock_task_handle;
+extern TaskHandle_t audio_click_task_handle;
+extern TaskHandle_t onset_adc_task_handle;
+extern TaskHandle_t tracking_task_handle;
+extern TaskHandle_t tap_task_handle;
+extern TaskHandle_t clock_in_task_handle;
+extern TaskHandle_t mode_switch_task_handle;
+extern TaskHandle_t hid_task_handle;
+extern TaskHandle_t display_task_handle;
+extern QueueHandle_t clock_task_queue;
+extern QueueHandle_t onset_adc_task_queue;
+extern QueueHandle_t hid_task_queue;
+extern QueueHandle_t tap_task_queue;
+
+_Static_assert(sizeof(telemetry_report) <= UINT8_MAX, "telemetry_report does not fit the length of the frame");
+
+/**
+ * @brief Handles of the tasks measured (read at every report: a task can be created later)
+ */
+static TaskHandle_t *const telemetry_tasks[TELEMETRY_TASKS_LENGTH] = {
+    [TELEMETRY_TASK_CLOCK] = &clock_task_handle,
+    [TELEMETRY_TASK_AUDIO_CLICK] = &audio_click_task_handle,
+    [TELEMETRY_TASK_ONSET_ADC] = &onset_adc_task_handle,
+    [TELEMETRY_TASK_TRACKING] = &tracking_task_handle,
+    [TELEMETRY_TASK_TAP] = &tap_task_handle,
+    [TELEMETRY_TASK_CLOCK_IN] = &clock_in_task_handle,
+    [TELEMETRY_TASK_MODE_SWITCH] = &mode_switch_task_handle,
+    [TELEMETRY_TASK_HID] = &hid_task_handle,
+    [TELEMETRY_TASK_DISPLAY] = &display_task_handle,
+};
+
+/**
+ * @brief Names of the tasks measured (8 characters at most)
+ */
+static const char *const telemetry_task_names[TELEMETRY_TASKS_LENGTH] = {
+    [TELEMETRY_TASK_CLOCK] = "Clock",
+    [TELEMETRY_TASK_AUDIO_CLICK] = "Click",
+    [TELEMETRY_TASK_ONSET_ADC] = "Onset",
+    [TELEMETRY_TASK_TRACKING] = "Tracking",
+    [TELEMETRY_TASK_TAP] = "Tap",
+    [TELEMETRY_TASK_CLOCK_IN] = "Clock in",
+    [TELEMETRY_TASK_MODE_SWITCH] = "Mode",
+    [TELEMETRY_TASK_HID] = "Hid",
+    [TELEMETRY_TASK_DISPLAY] = "Display",
+};
+
+/**
+ * @brief Queues measured
+ */
+static QueueHandle_t *const telemetry_queues[TELEMETRY_QUEUES_LENGTH] = {
+    [TELEMETRY_QUEUE_CLOCK] = &clock_task_queue,
+    [TELEMETRY_QUEUE_ONSET_ADC] = &onset_adc_task_queue,
+    [TELEMETRY_QUEUE_HID] = &hid_task_queue,
+    [TELEMETRY_QUEUE_TAP] = &tap_task_queue,
+};
+
+TaskHandle_t telemetry_task_handle = NULL;
+static telemetry_report telemetry_last = {0}; // last report (read by the hid task)
+static portMUX_TYPE telemetry_spinlock = portMUX_INITIALIZER_UNLOCKED; // protects telemetry_last
+static volatile bool telemetry_page_enabled = false;
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+/**
+ * @brief Sets the load of the tasks over the period from their run-time counters
+ */
+static void telemetry_measure_load(uint8_t *load)
+{
+    static TaskStatus_t status[TELEMETRY_MAX_SYSTEM_TASKS];
+    static configRUN_TIME_COUNTER_TYPE previous_total = 0;
+    static configRUN_TIME_COUNTER_TYPE previous_counter[TELEMETRY_TASKS_LENGTH] = {0};
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t count = uxTaskGetSystemState(status, TELEMETRY_MAX_SYSTEM_TASKS, &total);
+    configRUN_TIME_COUNTER_TYPE elapsed = total - previous_total;
+    previous_total = total;
+    for (telemetry_task_index t = 0; t < TELEMETRY_TASKS_LENGTH; t++)
+    {
+        for (UBaseType_t i = 0; i < count; i++)
+        {
+            if (*telemetry_tasks[t] != NULL && status[i].xHandle == *telemetry_tasks[t])
+            {
+                configRUN_TIME_COUNTER_TYPE delta = status[i].ulRunTimeCounter - previous_counter[t];
+                previous_counter[t] = status[i].ulRunTimeCounter;
+                load[t] = (elapsed > 0) ? MIN(((uint64_t)delta * 100) / elapsed, 100) : 0;
+                break;
+            }
+        }
+    }
+}
+#else
+/**
+ * @brief The run-time stats are not available: the loads stay TELEMETRY_LOAD_UNKNOWN
+ */
+static void telemetry_measure_load(uint8_t *load)
+{
+}
+#endif
+
+#ifdef TELEMETRY_STREAM
+/**
+ * @brief Writes the report on the console as a binary frame
+ */
+static void telemetry_send(const telemetry_report *report)
+{
+    uint8_t frame[4 + sizeof(telemetry_report) + sizeof(uint32_t)];
+    frame[0] = TELEMETRY_SYNC_0;
+    frame[1] = TELEMETRY_SYNC_1;
+    frame[2] = TELEMETRY_FRAME_VERSION;
+    frame[3] = sizeof(telemetry_report);
+    memcpy(&frame[4], report, sizeof(telemetry_report));
+    uint32_t crc = esp_rom_crc32_le(0, &frame[4], sizeof(telemetry_report));
+    memcpy(&frame[4 + sizeof(telemetry_report)], &crc, sizeof(crc));
+    fwrite(frame, 1, sizeof(frame), stdout);
+    fflush(stdout);
+}
+#endif
+
+/**
+ * @brief Main task of the Telemetry module
+ */
+static void telemetry_task(void *arg)
+{
+    uint8_t queue_max[TELEMETRY_QUEUES_LENGTH] = {0};
+    uint8_t samples = 0;
+    bc_seqlock_stats bc_previous;
+    bc_seqlock_get_stats(&bc_previous);
+    uint64_t report_start = esp_timer_get_time();
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TELEMETRY_SAMPLE_MS));
+        /*
+        Sample the queues
+        */
+        for (telemetry_queue_index q = 0; q < TELEMETRY_QUEUES_LENGTH; q++)
+        {
+            if (*telemetry_queues[q] != NULL)
+            {
+                queue_max[q] = MAX(queue_max[q], MIN(uxQueueMessagesWaiting(*telemetry_queues[q]), UINT8_MAX));
+            }
+        }
+        if (++samples < TELEMETRY_REPORT_SAMPLES)
+        {
+            continue;
+        }
+        samples = 0;
+        /*
+        Report of the period: stacks, loads and queues
+        */
+        telemetry_report report = {0};
+        uint64_t now = esp_timer_get_time();
+        uint64_t elapsed = MAX(now - report_start, 1);
+        report_start = now;
+        report.time_ms = now / 1000;
+        for (telemetry_task_index t = 0; t < TELEMETRY_TASKS_LENGTH; t++)
+        {
+            report.stack_free[t] = (*telemetry_tasks[t] != NULL) ? MIN(uxTaskGetStackHighWaterMark(*telemetry_tasks[t]), UINT16_MAX) : 0;
+            report.load[t] = TELEMETRY_LOAD_UNKNOWN;
+        }
+        telemetry_measure_load(report.load);
+        for (telemetry_queue_index q = 0; q < TELEMETRY_QUEUES_LENGTH; q++)
+        {
+            if (*telemetry_queues[q] != NULL)
+            {
+                report.queue_max[q] = queue_max[q];
+                report.queue_length[q] = MIN(uxQueueMessagesWaiting(*telemetry_queues[q]) + uxQueueSpacesAvailable(*telemetry_queues[q]), UINT8_MAX);
+            }
+            queue_max[q] = 0;
+        }
+        /*
+        Accesses to bc over the period
+        */
+        bc_seqlock_stats bc_stats;
+        bc_seqlock_get_stats(&bc_stats);
+        report.bc_writes = MIN(((uint64_t)(bc_stats.writes - bc_previous.writes) * 1000000) / elapsed, UINT16_MAX);
+        report.bc_max_write_ns = MIN(((uint64_t)bc_stats.max_write_cycles * 1000) / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, UINT16_MAX);
+        report.bc_read_retries = MIN(bc_stats.read_retries - bc_previous.read_retries, UINT16_MAX);
+        bc_previous = bc_stats;
+        /*
+        Hid and display
+        */
+        report.hid_wakeups = MIN(hid_wakeups_per_second, UINT16_MAX);
+        report.hid_redraws = MIN(hid_redraws_per_second, UINT16_MAX);
+        report.display_max_blocking_us = MIN(display_get_max_blocking(), UINT16_MAX);
+        portENTER_CRITICAL(&telemetry_spinlock);
+        telemetry_last = report;
+        portEXIT_CRITICAL(&telemetry_spinlock);
+#ifdef TELEMETRY_STREAM
+        telemetry_send(&report);
+#endif
+        if (telemetry_page_enabled)
+        {
+            int msg_to_hid = HID_TELEMETRY_UPDATED;
+            xQueueSend(hid_task_queue, &msg_to_hid, (TickType_t)0);
+        }
+    }
+}
+
+void telemetry_get_report(telemetry_report *report)
+{
+    portENTER_CRITICAL(&telemetry_spinlock);
+    *report = telemetry_last;
+    portEXIT_CRITICAL(&telemetry_spinlock);
+}
+
+const char *telemetry_task_name(telemetry_task_index task)
+{
+    return (task < TELEMETRY_TASKS_LENGTH) ? telemetry_task_names[task] : "";
+}
+
+void telemetry_enable_page(bool enable)
+{
+    telemetry_page_enabled = enable;
+}
+
+bool telemetry_is_page_enabled()
+{
+    return telemetry_page_enabled;
+}
+
+void telemetry_init()
+{
+    /*
+    Create telemetry_task
+    */
+    xTaskCreate(telemetry_task, "Telemetry_Task", TELEMETRY_TASK_STACK_SIZE, NULL, TELEMETRY_TASK_PRIORITY, &telemetry_task_handle);
+}
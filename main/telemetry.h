@@ -0,0 +1,125 @@
+/**
+ * @file telemetry.h
+ * @brief TELEMETRY module measures how close the tasks are to their limits, to size their stacks and priorities.
+ * A low-priority task samples every TELEMETRY_SAMPLE_MS:
+ * - the fill level of the queues (clock, onset_adc, hid and tap), keeping the highest one of the period
+ * and every TELEMETRY_REPORT_SAMPLES samples it makes a report with:
+ * - the free stack of every task at its lowest (high-water mark, uxTaskGetStackHighWaterMark)
+ * - the CPU load of every task over the period (% of a core, from the run-time stats of FreeRTOS:
+ *   TELEMETRY_LOAD_UNKNOWN if CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+ *   are not set: sdkconfig.defaults sets them)
+ * - the highest queue levels of the period
+ * - the accesses to bc: write sections per second and the longest one, copies repeated by the readers
+ *   (bc_seqlock.h)
+ * - the wakeups and redraws per second of the hid and the worst-case time in display_flush
+ * The report is shown on a hidden page of the OLED (turn the encoder back from the bpm page in PLAY mode)
+ * and, if TELEMETRY_STREAM is defined (telemetry.c), it is written on the console as a binary frame:
+ * - 2 sync bytes (TELEMETRY_SYNC_0, TELEMETRY_SYNC_1), the version of the format and the length of the payload
+ * - the payload: telemetry_report, packed, little endian
+ * - the CRC32 of the payload (esp_rom_crc32_le)
+ * The frames can be told apart from the log lines by the sync bytes and the CRC.
+ */
+
+#ifndef BC_TELEMETRY_H
+#define BC_TELEMETRY_H
+
+#include "main_defs.h"
+
+/**
+ * @brief Period of the samples of the queues (ms)
+ */
+#define TELEMETRY_SAMPLE_MS 10
+
+/**
+ * @brief Samples of a report (one report per second)
+ */
+#define TELEMETRY_REPORT_SAMPLES 100
+
+/**
+ * @brief Load of a task when the run-time stats are not available
+ */
+#define TELEMETRY_LOAD_UNKNOWN 0xFF
+
+/**
+ * @{ \name Frame of the console stream
+ */
+#define TELEMETRY_SYNC_0 0xBC
+#define TELEMETRY_SYNC_1 0x7E
+#define TELEMETRY_FRAME_VERSION 1
+/**
+ * @}
+ */
+
+/**
+ * @brief Tasks measured, in the order of the report
+ */
+typedef enum
+{
+    TELEMETRY_TASK_CLOCK,
+    TELEMETRY_TASK_AUDIO_CLICK,
+    TELEMETRY_TASK_ONSET_ADC,
+    TELEMETRY_TASK_TRACKING,
+    TELEMETRY_TASK_TAP,
+    TELEMETRY_TASK_CLOCK_IN,
+    TELEMETRY_TASK_MODE_SWITCH,
+    TELEMETRY_TASK_HID,
+    TELEMETRY_TASK_DISPLAY,
+    TELEMETRY_TASKS_LENGTH,
+} telemetry_task_index;
+
+/**
+ * @brief Queues measured, in the order of the report
+ */
+typedef enum
+{
+    TELEMETRY_QUEUE_CLOCK,
+    TELEMETRY_QUEUE_ONSET_ADC,
+    TELEMETRY_QUEUE_HID,
+    TELEMETRY_QUEUE_TAP,
+    TELEMETRY_QUEUES_LENGTH,
+} telemetry_queue_index;
+
+/**
+ * @brief Report of a period (payload of the frame of the console stream)
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t time_ms; /**< Time of the report since boot */
+    uint16_t stack_free[TELEMETRY_TASKS_LENGTH]; /**< Lowest free stack of every task (bytes, 0 if the task does not exist) */
+    uint8_t load[TELEMETRY_TASKS_LENGTH]; /**< CPU load of every task over the period (% of a core) */
+    uint8_t queue_max[TELEMETRY_QUEUES_LENGTH]; /**< Highest number of messages in every queue over the period */
+    uint8_t queue_length[TELEMETRY_QUEUES_LENGTH]; /**< Capacity of every queue */
+    uint16_t bc_writes; /**< Write sections of bc per second */
+    uint16_t bc_max_write_ns; /**< Longest write section of bc over the period (ns) */
+    uint16_t bc_read_retries; /**< Copies of bc repeated by the readers over the period */
+    uint16_t hid_wakeups; /**< Wakeups of the hid task per second */
+    uint16_t hid_redraws; /**< Redraws of the display per second */
+    uint16_t display_max_blocking_us; /**< Worst-case time spent in display_flush (us) */
+} telemetry_report;
+
+/**
+ * @brief Copies the last report
+ */
+void telemetry_get_report(telemetry_report *report);
+
+/**
+ * @brief Returns the name of the task (as shown on the telemetry page)
+ */
+const char *telemetry_task_name(telemetry_task_index task);
+
+/**
+ * @brief Shows or hides the telemetry page: while it is shown, every report asks the hid to redraw
+ */
+void telemetry_enable_page(bool enable);
+
+/**
+ * @brief Returns true if the telemetry page is shown
+ */
+bool telemetry_is_page_enabled();
+
+/**
+ * @brief Initialization of the Telemetry module (after all the tasks and queues have been created)
+ */
+void telemetry_init();
+
+#endif
@@ -3,35 +3,37 @@
  * @brief Tempo module evaluates the need of a change in the bpm of the midi clock.
  * For every onset, the sync module calculates the IOI with the preceding onsets of the two bars
  * and calculates the accuracy. If the highest accuracy found is higher than the threshold
- * the module sends a message to the clock module asking to set delta_tau_tempo value.
- * The module starts its job when notified by the Sync module.
+ * the module returns the delta_tau_tempo value that the tracking module sends to the clock.
+ * The evaluation is run by the tracking module (tracking.h) right after the sync evaluation.
  */
 
 #ifndef BC_TEMPO_H
 #define BC_TEMPO_H
 
+#include "main_defs.h"
+#include "tracking.h"
+
 /**
  * @brief Headroom value suggested for the B-Keeper algorithm
  */
 #define HEADROOM_VALUE_TEMPO 0.1
 
 /**
- * @brief Handle of the tempo_task.
+ * @brief Evaluates the IOIs of the onsets of the last two bars.
+ * The first_tempo_index of the snapshot is moved forward (binary search) to drop the onsets older than two bars.
+ * Returns true (and sets delta_tau_tempo) if the tempo of the clock has to be changed.
  */
-extern TaskHandle_t tempo_task_handle;
+bool tempo_evaluate(tracking_snapshot *snapshot, long long *delta_tau_tempo);
 
 /**
- * @brief Notify codes for tempo_task.
+ * @brief Resets the parameters of the algorithm for a new sequence with the given tau.
+ * The window (sigma_tempo) is at least TRACKING_START_SPREAD_SIGMAS times the spread of the start taps.
  */
-typedef enum
-{
-    TEMPO_START_EVALUATION_NOTIFY,
-    TEMPO_RESET_PARAMETERS,
-} tempo_task_notify_code;
+void tempo_reset(uint32_t tau, uint32_t spread);
 
 /**
  * @brief Init function for the tempo module
- * The function will set parameters and starts tempo_task
+ * The function adds the parameters to the menu
  */
 void tempo_init();
 
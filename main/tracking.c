@@ -0,0 +1,123 @@
+#include "tracking.h"
+#include "sync.h"
+#include "tempo.h"
+#include "kalman.h"
+#include "clock.h"
+#include "bc_seqlock.h"
+#include "clock_in.h"
+#include "visualizer.h"
+
+extern QueueHandle_t clock_task_queue;
+extern main_runtime_vrbs bc;
+
+TaskHandle_t tracking_task_handle = NULL;
+volatile uint32_t tracking_start_spread = 0;
+
+/**
+ * @brief Main task for the Tracking module
+ */
+static void tracking_task(void *arg)
+{
+    while (1)
+    {
+        /*
+        Block waiting until notified
+        */
+        uint32_t notify_code = 0;
+        xTaskNotifyWait(0, 0, &notify_code, portMAX_DELAY);
+        /*
+        Take a single snapshot of the current runtime values
+        */
+        main_runtime_vrbs current;
+        tracking_snapshot snapshot;
+        long long delta_tau_sync = 0;
+        long long delta_tau_tempo = 0;
+        bool send_corrections;
+        bc_read(&current);
+        snapshot.there_is_an_onset = current.there_is_an_onset;
+        snapshot.now = BC_TIME_NOW(current);
+        snapshot.tau = current.tau;
+        snapshot.expected_beat = current.expected_beat;
+        snapshot.bar_position = current.bar_position;
+        snapshot.layer = current.layer;
+        snapshot.first_sync_index = current.last_relevant_onset_index_for_sync;
+        snapshot.first_tempo_index = current.last_relevant_onset_index_for_tempo;
+        snapshot.most_recent_onset_index = current.most_recent_onset_index;
+        switch (notify_code)
+        {
+        case TRACKING_START_EVALUATION_NOTIFY:
+            if (clock_in_following)
+            {
+                /*
+                Slave mode: the clock follows the external clock, the sync evaluation
+                only measures the offset of the drummer against it
+                */
+                if (sync_evaluate(&snapshot, &delta_tau_sync))
+                {
+                    clock_in_report_drummer_offset(delta_tau_sync);
+                }
+                visualizer_push(&snapshot, delta_tau_sync, 0);
+                break;
+            }
+            if (kalman_tracking_enabled)
+            {
+                send_corrections = kalman_tracking_evaluate(&snapshot, &delta_tau_sync, &delta_tau_tempo);
+            }
+            else
+            {
+                /*
+                Run the B-Keeper evaluations back to back on the same window
+                */
+                send_corrections = sync_evaluate(&snapshot, &delta_tau_sync);
+                send_corrections |= tempo_evaluate(&snapshot, &delta_tau_tempo);
+                /*
+                Store the index of the first onset of the last two bars
+                (only the tracking module moves it while the clock is running)
+                */
+                bc_write_begin();
+                bc.last_relevant_onset_index_for_tempo = snapshot.first_tempo_index;
+                bc_write_end();
+            }
+            if (send_corrections)
+            {
+                /*
+                Send both corrections with a single message
+                */
+                clock_task_queue_entry txBuffer = {
+                    .type = CLOCK_QUEUE_SET_DELTA_TAU_SYNC_AND_TEMPO,
+                    .value = delta_tau_sync,
+                    .value_tempo = delta_tau_tempo,
+                };
+                if (xQueueSend(clock_task_queue, &txBuffer, (TickType_t)0) && kalman_tracking_enabled)
+                {
+                    kalman_tracking_corrections_sent(delta_tau_sync, delta_tau_tempo);
+                }
+            }
+            /*
+            Show the evaluation on the tracking page
+            */
+            visualizer_push(&snapshot, delta_tau_sync, delta_tau_tempo);
+            break;
+        case TRACKING_RESET_PARAMETERS:
+            /*
+            A new sequence is starting: reset all the engines with the new tau
+            and the spread of the taps (sloppy taps open the windows)
+            */
+            sync_reset(snapshot.tau, tracking_start_spread);
+            tempo_reset(snapshot.tau, tracking_start_spread);
+            kalman_tracking_reset(snapshot.tau, tracking_start_spread);
+            visualizer_reset();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void tracking_init()
+{
+    /*
+    Create tracking_task
+    */
+    xTaskCreate(tracking_task, "Tracking_Task", TRACKING_TASK_STACK_SIZE, NULL, TRACKING_TASK_PRIORITY, &tracking_task_handle);
+}
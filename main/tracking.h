@@ -0,0 +1,68 @@
+/**
+ * @file tracking.h
+ * @brief TRACKING module runs the beat tracking once every 8th note.
+ * When notified by the onset_adc module (at the end of the onset window), the tracking_task takes a
+ * single snapshot of the runtime values and of the onset window indexes and runs, back to back,
+ * the evaluations of the selected engine:
+ * - B-Keeper: the sync evaluation (sync.h) and the tempo evaluation (tempo.h)
+ * - Kalman: the joint phase/period filter (kalman.h)
+ * Both corrections are then sent to the clock module with a single
+ * CLOCK_QUEUE_SET_DELTA_TAU_SYNC_AND_TEMPO message.
+ */
+
+#ifndef BC_TRACKING_H
+#define BC_TRACKING_H
+
+#include "main_defs.h"
+
+/**
+ * @brief Notify codes for tracking_task.
+ */
+typedef enum
+{
+    TRACKING_START_EVALUATION_NOTIFY,
+    TRACKING_RESET_PARAMETERS,
+} tracking_task_notify_code;
+
+/**
+ * @brief Snapshot of the runtime values used by one evaluation.
+ * It is filled by tracking_task from a copy of bc taken with bc_read() (under the seqlock, see bc_seqlock.h)
+ * and then shared by all the evaluations so that they work on the same consistent onset window.
+ */
+typedef struct
+{
+    bool there_is_an_onset; /**< There has been an onset in the current window */
+    bc_time_t now; /**< Time of the snapshot */
+    uint32_t tau; /**< Current 8th length */
+    bc_time_t expected_beat; /**< Position of the current expected beat */
+    uint8_t bar_position; /**< Current bar position (0-15) */
+    uint8_t layer; /**< Layer of the current bar position */
+    int first_sync_index; /**< Index of the first onset of the current window */
+    uint32_t first_tempo_index; /**< Index of the first onset of the last two bars */
+    uint32_t most_recent_onset_index; /**< Index of the most recent onset */
+} tracking_snapshot;
+
+/**
+ * @brief At the start of a sequence the windows of the engines are at least this number of
+ * start spreads wide (see tracking_start_spread)
+ */
+#define TRACKING_START_SPREAD_SIGMAS 2
+
+/**
+ * @brief Spread (us) of the taps that started the sequence (0 if unknown), see tap_tempo.h.
+ * It is set before notifying TRACKING_RESET_PARAMETERS.
+ */
+extern volatile uint32_t tracking_start_spread;
+
+/**
+ * @brief Handle of the tracking_task.
+ */
+extern TaskHandle_t tracking_task_handle;
+
+/**
+ * @brief Init function for the tracking module
+ * The function creates tracking_task
+ */
+void tracking_init();
+
+#endif
@@ -0,0 +1,218 @@
+#include "visualizer.h"
+#include "onset_adc.h"
+#include "hid.h"
+
+extern onset_entry onsets[];
+
+visualizer_slot visualizer_slots[TWO_BAR_LENGTH_IN_8TH]; // last evaluation of every bar position
+uint16_t visualizer_changed = 0; // bit mask of the slots to draw
+int8_t visualizer_last_slot = -1; // last slot pushed (-1: none)
+volatile bool visualizer_enabled = false;
+portMUX_TYPE visualizer_spinlock = portMUX_INITIALIZER_UNLOCKED; // protects the slots between the tracking and the hid tasks
+
+void visualizer_push(const tracking_snapshot *snapshot, long long delta_tau_sync, long long delta_tau_tempo)
+{
+    visualizer_slot slot = {
+        .tau = snapshot->tau,
+        .delta_tau_sync = delta_tau_sync,
+        .delta_tau_tempo = delta_tau_tempo,
+        .onsets = 0,
+    };
+    if (snapshot->there_is_an_onset)
+    {
+        int i = snapshot->first_sync_index;
+        while (slot.onsets < VISUALIZER_MAX_ONSETS)
+        {
+            slot.onset_error[slot.onsets] = BC_TIME_DIFF(onsets[i].time, snapshot->expected_beat);
+            slot.onset_type[slot.onsets] = onsets[i].type;
+            slot.onsets++;
+            if (i == snapshot->most_recent_onset_index)
+            {
+                break;
+            }
+            i = (i + 1) % ONSET_BUFFER_SIZE;
+        }
+    }
+    uint8_t position = snapshot->bar_position % TWO_BAR_LENGTH_IN_8TH;
+    portENTER_CRITICAL(&visualizer_spinlock);
+    visualizer_slots[position] = slot;
+    visualizer_changed |= 1 << position;
+    visualizer_last_slot = position;
+    portEXIT_CRITICAL(&visualizer_spinlock);
+    if (visualizer_enabled)
+    {
+        int msg_to_hid = HID_TRACKING_UPDATED;
+        xQueueSend(hid_task_queue, &msg_to_hid, (TickType_t)0);
+    }
+}
+
+void visualizer_reset()
+{
+    portENTER_CRITICAL(&visualizer_spinlock);
+    memset(visualizer_slots, 0, sizeof(visualizer_slots));
+    visualizer_changed = 0xFFFF;
+    visualizer_last_slot = -1;
+    portEXIT_CRITICAL(&visualizer_spinlock);
+}
+
+void visualizer_enable(bool enable)
+{
+    portENTER_CRITICAL(&visualizer_spinlock);
+    visualizer_changed = 0xFFFF;
+    portEXIT_CRITICAL(&visualizer_spinlock);
+    visualizer_enabled = enable;
+}
+
+bool visualizer_is_enabled()
+{
+    return visualizer_enabled;
+}
+
+/**
+ * @brief Returns the column bits of a bar of the phase-error strip (4 rows up or down from the middle)
+ */
+static uint8_t visualizer_bar(int32_t value, uint32_t full_scale)
+{
+    if (full_scale == 0 || value == 0)
+    {
+        return 0;
+    }
+    uint32_t magnitude = abs(value);
+    uint8_t rows = (magnitude * 4 + full_scale - 1) / full_scale; // at least one row if not 0
+    if (rows > 4)
+    {
+        rows = 4;
+    }
+    uint8_t mask = (1 << rows) - 1;
+    return value > 0 ? (uint8_t)(mask << (4 - rows)) : (uint8_t)(mask << 4);
+}
+
+/**
+ * @brief Draws a slot (or clears it if empty) into the three pages of the timeline and of the strip
+ */
+static void visualizer_draw_slot(SSD1306_t *dev, uint8_t position, const visualizer_slot *slot, bool empty)
+{
+    uint8_t top[VISUALIZER_SLOT_WIDTH] = {0};
+    uint8_t bottom[VISUALIZER_SLOT_WIDTH] = {0};
+    uint8_t strip[VISUALIZER_SLOT_WIDTH] = {0};
+    const uint8_t tick = VISUALIZER_MAX_ONSET_SHIFT; // column of the expected beat
+    /*
+    Grid: dotted line on the start of the bars, taller tick on the quarters
+    */
+    if (position % BAR_LENGTH_IN_8TH == 0)
+    {
+        top[tick] = 0x55;
+        bottom[tick] = 0x55;
+    }
+    else
+    {
+        bottom[tick] = position % 2 == 0 ? 0xE0 : 0x80;
+    }
+    if (!empty)
+    {
+        /*
+        Onsets around the tick: kick on the bottom, snare on the top
+        */
+        for (uint8_t i = 0; i < slot->onsets; i++)
+        {
+            int32_t shift = slot->tau ? ((int64_t)slot->onset_error[i] * 4 * VISUALIZER_MAX_ONSET_SHIFT) / (int32_t)slot->tau : 0;
+            if (shift > VISUALIZER_MAX_ONSET_SHIFT)
+            {
+                shift = VISUALIZER_MAX_ONSET_SHIFT;
+            }
+            if (shift < -VISUALIZER_MAX_ONSET_SHIFT)
+            {
+                shift = -VISUALIZER_MAX_ONSET_SHIFT;
+            }
+            uint8_t x = tick + shift;
+            if (slot->onset_type[i] == 0)
+            {
+                bottom[x] |= 0x1E; // solid block
+                if (x > 0)
+                {
+                    bottom[x - 1] |= 0x1E;
+                }
+                bottom[x + 1] |= 0x1E;
+            }
+            else
+            {
+                top[x] |= 0x42; // ring
+                if (x > 0)
+                {
+                    top[x - 1] |= 0x3C;
+                }
+                top[x + 1] |= 0x3C;
+            }
+        }
+        /*
+        Phase-error strip: sync on the left of the tick, tempo on the right
+        */
+        uint8_t sync_bar = visualizer_bar(slot->delta_tau_sync, slot->tau / VISUALIZER_SYNC_FULL_SCALE);
+        uint8_t tempo_bar = visualizer_bar(slot->delta_tau_tempo, slot->tau / VISUALIZER_TEMPO_FULL_SCALE);
+        strip[tick - 2] = sync_bar;
+        strip[tick - 1] = sync_bar;
+        strip[tick + 1] = tempo_bar;
+        strip[tick + 2] = tempo_bar;
+    }
+    strip[tick] = 0x18; // middle line
+    ssd1306_display_image(dev, 0, position * VISUALIZER_SLOT_WIDTH, top, VISUALIZER_SLOT_WIDTH);
+    ssd1306_display_image(dev, 1, position * VISUALIZER_SLOT_WIDTH, bottom, VISUALIZER_SLOT_WIDTH);
+    ssd1306_display_image(dev, 2, position * VISUALIZER_SLOT_WIDTH, strip, VISUALIZER_SLOT_WIDTH);
+}
+
+void visualizer_draw(SSD1306_t *dev, uint16_t bpm)
+{
+    visualizer_slot slots[TWO_BAR_LENGTH_IN_8TH];
+    portENTER_CRITICAL(&visualizer_spinlock);
+    uint16_t changed = visualizer_changed;
+    int8_t last_slot = visualizer_last_slot;
+    visualizer_changed = 0;
+    memcpy(slots, visualizer_slots, sizeof(slots));
+    portEXIT_CRITICAL(&visualizer_spinlock);
+    /*
+    The slot after the last one pushed is the cursor: it is cleared until it is pushed again
+    */
+    int8_t cursor = last_slot < 0 ? -1 : (last_slot + 1) % TWO_BAR_LENGTH_IN_8TH;
+    if (cursor >= 0)
+    {
+        changed |= 1 << cursor;
+    }
+    for (uint8_t position = 0; position < TWO_BAR_LENGTH_IN_8TH; position++)
+    {
+        if (changed & (1 << position))
+        {
+            visualizer_draw_slot(dev, position, &slots[position], position == cursor);
+        }
+    }
+    /*
+    Accuracy: mean distance of the onsets from the expected beat over the two bars (nearest onset of every slot)
+    */
+    uint32_t error_sum = 0;
+    uint8_t error_count = 0;
+    for (uint8_t position = 0; position < TWO_BAR_LENGTH_IN_8TH; position++)
+    {
+        if (slots[position].onsets > 0)
+        {
+            uint32_t nearest = abs(slots[position].onset_error[0]);
+            for (uint8_t i = 1; i < slots[position].onsets; i++)
+            {
+                if ((uint32_t)abs(slots[position].onset_error[i]) < nearest)
+                {
+                    nearest = abs(slots[position].onset_error[i]);
+                }
+            }
+            error_sum += nearest;
+            error_count++;
+        }
+    }
+    char text[17];
+    if (error_count > 0)
+    {
+        snprintf(text, sizeof(text), "%3ubpm  err%3lums", bpm, ((error_sum / error_count) + 500) / 1000);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%3ubpm  err  -ms", bpm);
+    }
+    ssd1306_display_text(dev, 3, text, 16, false);
+}
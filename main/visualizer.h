@@ -0,0 +1,87 @@
+/**
+ * @file visualizer.h
+ * @brief VISUALIZER draws the beat tracking on the OLED in PLAY mode (tracking page).
+ * The page shows the last two bars as a fixed grid of 16 slots (one per 8th note, 8 columns each):
+ * - pages 0-1: timeline. A tick marks the expected beat of every 8th (taller on the quarters, dotted
+ *   line on the start of the bars); the onsets of the slot are drawn around it at their distance from
+ *   the expected beat (kick: solid block on the bottom, snare: ring on the top)
+ * - page 2: phase-error strip. Two bars per slot, up for positive and down for negative values:
+ *   delta_tau_sync (left) and delta_tau_tempo (right) sent by the tracking
+ * - page 3: bpm and accuracy (mean distance of the onsets from their expected beat over the two bars)
+ * The tracking task pushes every evaluation with visualizer_push. The hid task draws only the slots
+ * that have changed, and clears the slot after the last one drawn (cursor): the framebuffer is
+ * updated one 8-column slot at a time, so every 8th note sends three spans of 16 columns and a few
+ * characters, less than the digits of the bpm.
+ */
+
+#ifndef BC_VISUALIZER_H
+#define BC_VISUALIZER_H
+
+#include "main_defs.h"
+#include "tracking.h"
+#include "../components/ssd1306/ssd1306.h"
+
+/**
+ * @brief Width of a slot (columns)
+ */
+#define VISUALIZER_SLOT_WIDTH 8
+
+/**
+ * @brief Max number of onsets drawn in a slot
+ */
+#define VISUALIZER_MAX_ONSETS 4
+
+/**
+ * @brief Max distance of an onset from its tick (columns); the distance is tau / 4 at full scale
+ */
+#define VISUALIZER_MAX_ONSET_SHIFT 3
+
+/**
+ * @{ \name Full scale of the bars of the phase-error strip (fraction of tau)
+ */
+#define VISUALIZER_SYNC_FULL_SCALE 16
+#define VISUALIZER_TEMPO_FULL_SCALE 64
+/**
+ * @}
+ */
+
+/**
+ * @brief Onsets and corrections of an evaluation (one 8th note)
+ */
+typedef struct
+{
+    uint32_t tau; /**< 8th length (us) */
+    int32_t delta_tau_sync; /**< Sync correction (us) */
+    int32_t delta_tau_tempo; /**< Tempo correction (us) */
+    int32_t onset_error[VISUALIZER_MAX_ONSETS]; /**< Distance of the onsets from the expected beat (us) */
+    uint8_t onset_type[VISUALIZER_MAX_ONSETS]; /**< Type of the onsets (0: kick, 1: snare) */
+    uint8_t onsets; /**< Number of onsets */
+} visualizer_slot;
+
+/**
+ * @brief Stores the evaluation of the tracking task (onsets of the window and corrections) in the slot
+ * of its bar position and wakes up the hid if the tracking page is shown
+ */
+void visualizer_push(const tracking_snapshot *snapshot, long long delta_tau_sync, long long delta_tau_tempo);
+
+/**
+ * @brief Forgets the slots (new sequence)
+ */
+void visualizer_reset();
+
+/**
+ * @brief Shows (or hides) the tracking page: when shown, the whole page is drawn at the next redraw
+ */
+void visualizer_enable(bool enable);
+
+/**
+ * @brief Returns true if the tracking page is shown
+ */
+bool visualizer_is_enabled();
+
+/**
+ * @brief Draws the slots changed since the last call into the framebuffer of the display (hid task)
+ */
+void visualizer_draw(SSD1306_t *dev, uint16_t bpm);
+
+#endif